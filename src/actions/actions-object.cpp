@@ -15,6 +15,7 @@
 
 #include "actions-object.h"
 #include "actions-helper.h"
+#include "document.h"
 #include "document-undo.h"
 #include "inkscape-application.h"
 
@@ -297,6 +298,21 @@ object_stroke_to_path(InkscapeApplication *app)
     selection->strokesToPaths();
 }
 
+void
+object_stroke_to_path_all(InkscapeApplication *app)
+{
+    auto document = app->get_active_document();
+    if (!document) {
+        show_output("object_stroke_to_path_all: no document!");
+        return;
+    }
+
+    // The whole document in one batch and one undo step, no selection needed (e.g. on the command line).
+    auto objects = Inkscape::ObjectSet(document);
+    objects.set(document->getRoot());
+    objects.strokesToPaths();
+}
+
 
 std::vector<std::vector<Glib::ustring>> raw_data_object =
 {
@@ -308,6 +324,7 @@ std::vector<std::vector<Glib::ustring>> raw_data_object =
     {"app.object-to-path",              N_("Object To Path"),                   "Object",     N_("Convert shapes to paths")},
     {"app.object-add-corners-lpe",      N_("Add Corners LPE"),                  "Object",     N_("Add Corners Live Path Effect to path")},
     {"app.object-stroke-to-path",       N_("Stroke to Path"),                   "Object",     N_("Convert strokes to paths")},
+    {"app.object-stroke-to-path-all",   N_("All Strokes to Path"),              "Object",     N_("Convert the strokes of all objects in the document to paths")},
 
     {"app.object-set-clip",             N_("Object Clip Set"),                  "Object",     N_("Apply clipping path to selection (using the topmost object as clipping path)")},
     {"app.object-set-inverse-clip",     N_("Object Clip Set Inverse"),          "Object",     N_("Apply inverse clipping path to selection (Power Clip LPE)")},
@@ -350,6 +367,7 @@ add_actions_object(InkscapeApplication* app)
     gapp->add_action(                "object-to-path",                  sigc::bind(sigc::ptr_fun(&object_to_path),                app));
     gapp->add_action(                "object-add-corners-lpe",          sigc::bind(sigc::ptr_fun(&object_add_corners_lpe),        app));
     gapp->add_action(                "object-stroke-to-path",           sigc::bind(sigc::ptr_fun(&object_stroke_to_path),         app));
+    gapp->add_action(                "object-stroke-to-path-all",       sigc::bind(sigc::ptr_fun(&object_stroke_to_path_all),     app));
 
     gapp->add_action(                "object-set-clip",                 sigc::bind(sigc::ptr_fun(&object_clip_set),               app));
     gapp->add_action(                "object-set-inverse-clip",         sigc::bind(sigc::ptr_fun(&object_clip_set_inverse),       app));
@@ -750,7 +750,7 @@ void add_actions_processing(SPDocument* doc)
         sp_item_list_to_curves({doc->getRoot()}, selected, to_select, false);
     });
     group->add_action("add-strokes-to-paths",         [doc]() {
-        item_to_paths(doc->getRoot());
+        items_to_paths({doc->getRoot()});
     });
     group->add_action("normalize-all-paths",       [doc]() { normalize_all_paths(doc->getReprRoot()); });
     group->add_action("insert-bounding-boxes",     [doc]() { insert_bounding_boxes(doc->getRoot()); });
@@ -14,7 +14,9 @@
 #include <2geom/line.h>
 #include <2geom/path-intersection.h>
 #include <2geom/path-sink.h>
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
 #include "desktop.h"
 #include "display/curve.h"
@@ -45,6 +47,9 @@ Inkscape::AlignmentSnapper::AlignmentSnapper(SnapManager *sm, Geom::Coord const
     : Snapper(sm, d)
 {
     _points_to_snap_to = std::make_unique<std::vector<Inkscape::SnapCandidatePoint>>();
+    for (auto &sorted : _sorted_points) {
+        sorted = std::make_unique<std::vector<std::size_t>>();
+    }
 }
 
 Inkscape::AlignmentSnapper::~AlignmentSnapper()
@@ -125,108 +130,142 @@ void Inkscape::AlignmentSnapper::_collectBBoxPoints(bool const &first_point) con
         //std::cout<<point.getPoint().x()<<","<<point.getPoint().y()<<std::endl;
 }
 
+void Inkscape::AlignmentSnapper::_sortPoints() const
+{
+    auto const &points = *_points_to_snap_to;
+    for (auto dim : {Geom::X, Geom::Y}) {
+        auto &sorted = *_sorted_points[dim];
+        sorted.resize(points.size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::stable_sort(sorted.begin(), sorted.end(), [&points, dim] (std::size_t a, std::size_t b) {
+            return points[a].getPoint()[dim] < points[b].getPoint()[dim];
+        });
+    }
+}
+
+std::pair<std::vector<std::size_t>::const_iterator, std::vector<std::size_t>::const_iterator>
+Inkscape::AlignmentSnapper::_pointsInRange(Geom::Dim2 dim, Geom::Coord min, Geom::Coord max) const
+{
+    auto const &points = *_points_to_snap_to;
+    auto const &sorted = *_sorted_points[dim];
+    auto first = std::lower_bound(sorted.begin(), sorted.end(), min, [&points, dim] (std::size_t i, Geom::Coord value) {
+        return points[i].getPoint()[dim] < value;
+    });
+    auto last = std::upper_bound(first, sorted.end(), max, [&points, dim] (Geom::Coord value, std::size_t i) {
+        return value < points[i].getPoint()[dim];
+    });
+    return {first, last};
+}
+
 void Inkscape::AlignmentSnapper::_snapBBoxPoints(IntermSnapResults &isr,
                                                  SnapCandidatePoint const &p,
                                                  std::vector<SnapCandidatePoint> *unselected_nodes,
                                                  SnapConstraint const &c,
                                                  Geom::Point const &p_proj_on_constraint) const
 {
-
-    _collectBBoxPoints(p.getSourceNum() <= 0);
-
-    if (unselected_nodes != nullptr &&
-        unselected_nodes->size() > 0 &&
-        _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_ALIGNMENT_HANDLE)) {
-        g_assert(_points_to_snap_to != nullptr);
-        _points_to_snap_to->insert(_points_to_snap_to->end(), unselected_nodes->begin(), unselected_nodes->end());
+    bool const first_point = p.getSourceNum() <= 0;
+    _collectBBoxPoints(first_point);
+
+    // The targets only change between snapping sessions, so the unselected nodes are added and
+    // the points sorted once for all the source points of a selection
+    if (first_point) {
+        if (unselected_nodes != nullptr &&
+            unselected_nodes->size() > 0 &&
+            _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_ALIGNMENT_HANDLE)) {
+            g_assert(_points_to_snap_to != nullptr);
+            _points_to_snap_to->insert(_points_to_snap_to->end(), unselected_nodes->begin(), unselected_nodes->end());
+        }
+        _sortPoints();
     }
 
-    SnappedPoint sx;
-    SnappedPoint sy;
-    SnappedPoint si;
+    if (_points_to_snap_to->empty()) {
+        return;
+    }
 
     bool consider_x = true;
     bool consider_y = true;
-    bool success_x = false;
-    bool success_y = false;
-    bool intersection = false;
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
+    Geom::Coord const tolerance = getSnapperTolerance();
+    Geom::Point const pt = p.getPoint();
+
+    if (!c.isUndefined() && c.isLinear()) {
+        if (c.getDirection().x() == 0)
+            consider_y = false; // consider vertical snapping if moving vertically
+        else
+            consider_x = false; // consider horizontal snapping if moving horizontally
+    }
 
-    for (const auto & k : *_points_to_snap_to) {
-        if (_allowSourceToSnapToTarget(p.getSourceType(), k.getTargetType(), strict_snapping)) {
-            Geom::Point target_pt = k.getPoint();
-            // (unconstrained) distance from HORIZONTAL guide 
-            Geom::Point point_on_x(p.getPoint().x(), target_pt.y());
-            Geom::Coord distX = Geom::L2(point_on_x - p.getPoint()); 
-
-            // (unconstrained) distance from VERTICAL guide 
-            Geom::Point point_on_y(target_pt.x(), p.getPoint().y());
-            Geom::Coord distY = Geom::L2(point_on_y - p.getPoint()); 
-
-            if (!c.isUndefined() && c.isLinear()) {
-                if (c.getDirection().x() == 0)
-                    consider_y = false; // consider vertical snapping if moving vertically
-                else
-                    consider_x = false; // consider horizontal snapping if moving horizontally 
-            }
-
-            bool is_target_node = k.getTargetType() & SNAPTARGET_NODE_CATEGORY;
-            if (consider_x && distX < getSnapperTolerance() && Geom::L2(target_pt - point_on_x) < sx.getDistanceToAlignTarget()) {
-                sx = SnappedPoint(point_on_x,
-                                 k.getPoint(),
-                                 source2alignment(p.getSourceType()),
-                                 p.getSourceNum(),
-                                 is_target_node ? SNAPTARGET_ALIGNMENT_HANDLE : k.getTargetType(),
-                                 distX,
-                                 getSnapperTolerance(),
-                                 getSnapperAlwaysSnap(),
-                                 false,
-                                 true,
-                                 k.getTargetBBox());
-                success_x = true;
+    // Find the target closest to the source along the guide through pt in the direction of
+    // dim, among the targets that lie within tolerance of that guide. Ties go to the target
+    // collected first.
+    auto find_aligned = [&] (Geom::Dim2 dim, SnappedPoint &s) {
+        auto const other = dim == Geom::X ? Geom::Y : Geom::X;
+        auto const range = _pointsInRange(other, pt[other] - tolerance, pt[other] + tolerance);
+        std::size_t best = _points_to_snap_to->size();
+        Geom::Coord best_dist = Geom::infinity();
+        for (auto i = range.first; i != range.second; ++i) {
+            auto const &k = (*_points_to_snap_to)[*i];
+            if (!_allowSourceToSnapToTarget(p.getSourceType(), k.getTargetType(), strict_snapping)) {
+                continue;
             }
-
-            if (consider_y && distY < getSnapperTolerance() && Geom::L2(target_pt - point_on_y) < sy.getDistanceToAlignTarget()) {
-                sy = SnappedPoint(point_on_y,
-                                 k.getPoint(),
-                                 source2alignment(p.getSourceType()),
-                                 p.getSourceNum(),
-                                 is_target_node ? SNAPTARGET_ALIGNMENT_HANDLE : k.getTargetType(),
-                                 distY,
-                                 getSnapperTolerance(),
-                                 getSnapperAlwaysSnap(),
-                                 false,
-                                 true,
-                                 k.getTargetBBox());
-                success_y = true;
+            Geom::Point const target_pt = k.getPoint();
+            if (std::abs(target_pt[other] - pt[other]) >= tolerance) {
+                continue;
             }
-
-            if (consider_x && consider_y && success_x && success_y) {
-                Geom::Point intersection_p = Geom::Point(sy.getPoint().x(), sx.getPoint().y());
-                Geom::Coord d =  Geom::L2(intersection_p - p.getPoint());
-
-                if (d < sqrt(2)*getSnapperTolerance()) {
-                    si = SnappedPoint(intersection_p,
-                                     *sx.getAlignmentTarget(),
-                                     *sy.getAlignmentTarget(),
-                                     source2alignment(p.getSourceType()),
-                                     p.getSourceNum(),
-                                     SNAPTARGET_ALIGNMENT_INTERSECTION,
-                                     d,
-                                     getSnapperTolerance(),
-                                     getSnapperAlwaysSnap(),
-                                     false,
-                                     true,
-                                     k.getTargetBBox());
-                    intersection = true;
-                }
+            Geom::Coord const dist = std::abs(target_pt[dim] - pt[dim]);
+            if (dist < best_dist || (dist == best_dist && *i < best)) {
+                best_dist = dist;
+                best = *i;
             }
         }
-    }
+        if (best == _points_to_snap_to->size()) {
+            return false;
+        }
 
-    if (intersection) {
-       isr.points.push_back(si); 
-       return;
+        auto const &k = (*_points_to_snap_to)[best];
+        Geom::Point point_on_guide = pt;
+        point_on_guide[other] = k.getPoint()[other];
+        bool is_target_node = k.getTargetType() & SNAPTARGET_NODE_CATEGORY;
+        s = SnappedPoint(point_on_guide,
+                         k.getPoint(),
+                         source2alignment(p.getSourceType()),
+                         p.getSourceNum(),
+                         is_target_node ? SNAPTARGET_ALIGNMENT_HANDLE : k.getTargetType(),
+                         Geom::L2(point_on_guide - pt),
+                         tolerance,
+                         getSnapperAlwaysSnap(),
+                         false,
+                         true,
+                         k.getTargetBBox());
+        return true;
+    };
+
+    // sx snaps to a HORIZONTAL guide, sy to a VERTICAL one
+    SnappedPoint sx;
+    SnappedPoint sy;
+    bool const success_x = consider_x && find_aligned(Geom::X, sx);
+    bool const success_y = consider_y && find_aligned(Geom::Y, sy);
+
+    if (success_x && success_y) {
+        Geom::Point intersection_p = Geom::Point(sy.getPoint().x(), sx.getPoint().y());
+        Geom::Coord d =  Geom::L2(intersection_p - pt);
+
+        if (d < sqrt(2)*tolerance) {
+            SnappedPoint si(intersection_p,
+                            *sx.getAlignmentTarget(),
+                            *sy.getAlignmentTarget(),
+                            source2alignment(p.getSourceType()),
+                            p.getSourceNum(),
+                            SNAPTARGET_ALIGNMENT_INTERSECTION,
+                            d,
+                            tolerance,
+                            getSnapperAlwaysSnap(),
+                            false,
+                            true,
+                            sx.getTargetBBox());
+            isr.points.push_back(si);
+            return;
+        }
     }
 
     if (success_x || success_y) {
@@ -236,7 +275,6 @@ void Inkscape::AlignmentSnapper::_snapBBoxPoints(IntermSnapResults &isr,
             isr.points.push_back(sy);
         }
     }
-
 }
 
 bool Inkscape::AlignmentSnapper::_allowSourceToSnapToTarget(SnapSourceType source, SnapTargetType target, bool strict_snapping) const
@@ -265,7 +303,7 @@ void Inkscape::AlignmentSnapper::freeSnap(IntermSnapResults &isr,
     
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     unsigned n = (unselected_nodes == nullptr) ? 0 : unselected_nodes->size();
@@ -296,7 +334,7 @@ void Inkscape::AlignmentSnapper::constrainedSnap(IntermSnapResults &isr,
 
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     unsigned n = (unselected_nodes == nullptr) ? 0 : unselected_nodes->size();
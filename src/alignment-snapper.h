@@ -12,7 +12,9 @@
 #define SEEN_ALIGNMENT_SNAPPER_H
 
 #include <2geom/affine.h>
+#include <array>
 #include <memory>
+#include <utility>
 
 #include "snap-enums.h"
 #include "snapper.h"
@@ -64,12 +66,21 @@ public:
 
 private:
     std::unique_ptr<std::vector<SnapCandidatePoint>> _points_to_snap_to;
+    /// Indices into _points_to_snap_to, sorted by x and by y coordinate
+    std::array<std::unique_ptr<std::vector<std::size_t>>, 2> _sorted_points;
 
     /** Collects and caches points on bounding boxes of the candidates
      * @param is the point first point in the selection?
      */
     void _collectBBoxPoints(bool const &first_point) const;
 
+    /// Sorts the collected points along both axes, once per snapping session
+    void _sortPoints() const;
+
+    /// @return The range of sorted indices whose point has a coordinate in [min, max] along dim
+    std::pair<std::vector<std::size_t>::const_iterator, std::vector<std::size_t>::const_iterator>
+    _pointsInRange(Geom::Dim2 dim, Geom::Coord min, Geom::Coord max) const;
+
     void _snapBBoxPoints(IntermSnapResults &isr,
                          SnapCandidatePoint const &p,
                          std::vector<SnapCandidatePoint> *unselected_nodes,
@@ -11,6 +11,7 @@
  */
 
 
+#include <chrono>
 #include <glib.h>
 #include <glibmm/ustring.h>
 #include <memory>
@@ -30,6 +31,11 @@ std::shared_ptr<std::string> timestamp() {
     return result;
 }
 
+std::int64_t timestamp_ns() {
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
 }
 
 }
@@ -13,6 +13,7 @@
 #ifndef SEEN_INKSCAPE_DEBUG_TIMESTAMP_H
 #define SEEN_INKSCAPE_DEBUG_TIMESTAMP_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -22,6 +23,9 @@ namespace Debug {
 
 std::shared_ptr<std::string> timestamp();
 
+/// Monotonic time in nanoseconds, for timing spans.
+std::int64_t timestamp_ns();
+
 }
 
 }
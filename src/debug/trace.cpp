@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::Trace - timing of hot paths in Chrome Trace Event format
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <glib.h>
+
+#include "debug/trace.h"
+
+namespace Inkscape {
+
+namespace Debug {
+
+std::atomic<bool> Trace::_enabled = false;
+
+namespace {
+
+// Spans kept per thread before further ones are dropped, about 32 MB.
+constexpr std::size_t MAX_SPANS_PER_THREAD = 1 << 20;
+
+struct Span {
+    char const *name;
+    char const *category;
+    std::int64_t start;
+    std::int64_t end;
+};
+
+struct Counter {
+    char const *name;
+    char const *category;
+    std::int64_t time;
+    std::vector<std::pair<char const *, double>> values;
+};
+
+struct ThreadSpans {
+    int tid;
+    std::mutex mutex; // only contended while the trace is written out
+    std::vector<Span> spans;
+    std::vector<Counter> counters;
+    std::size_t dropped = 0;
+};
+
+std::string filename;
+std::int64_t start_time = 0;
+
+std::mutex threads_mutex;
+std::vector<std::unique_ptr<ThreadSpans>> threads;
+
+std::mutex names_mutex;
+std::unordered_set<std::string> names;
+
+/// The spans of the calling thread, which stay with the trace after the thread exits.
+ThreadSpans &thread_spans()
+{
+    thread_local ThreadSpans *spans = [] {
+        auto lock = std::lock_guard(threads_mutex);
+        auto &result = threads.emplace_back(std::make_unique<ThreadSpans>());
+        result->tid = threads.size();
+        return result.get();
+    }();
+    return *spans;
+}
+
+void write_escaped(std::ostream &os, char const *value)
+{
+    for (char const *c = value; *c; ++c) {
+        switch (*c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) >= 0x20) {
+                os.put(*c);
+            }
+        }
+    }
+}
+
+void do_shutdown()
+{
+    Trace::shutdown();
+}
+
+}
+
+void Trace::init()
+{
+    if (enabled()) {
+        return;
+    }
+    char const *trace_filename = std::getenv("INKSCAPE_TRACE");
+    if (!trace_filename || !*trace_filename) {
+        return;
+    }
+    filename = trace_filename;
+    start_time = timestamp_ns();
+    thread_spans(); // the main thread gets thread id 1
+    _enabled = true;
+    std::atexit(&do_shutdown);
+}
+
+void Trace::record(char const *name, char const *category, std::int64_t start_ns, std::int64_t end_ns)
+{
+    auto &thread = thread_spans();
+    auto lock = std::lock_guard(thread.mutex);
+    if (thread.spans.size() < MAX_SPANS_PER_THREAD) {
+        thread.spans.push_back({name, category, start_ns, end_ns});
+    } else {
+        thread.dropped++;
+    }
+}
+
+void Trace::counter(char const *name, char const *category,
+                    std::initializer_list<std::pair<char const *, double>> values)
+{
+    if (!enabled()) {
+        return;
+    }
+    auto const time = timestamp_ns();
+    auto &thread = thread_spans();
+    auto lock = std::lock_guard(thread.mutex);
+    if (thread.counters.size() < MAX_SPANS_PER_THREAD) {
+        thread.counters.push_back({name, category, time, values});
+    } else {
+        thread.dropped++;
+    }
+}
+
+char const *Trace::intern(std::string const &name)
+{
+    auto lock = std::lock_guard(names_mutex);
+    return names.insert(name).first->c_str();
+}
+
+void Trace::shutdown()
+{
+    if (!enabled()) {
+        return;
+    }
+    _enabled = false;
+
+    std::ofstream os(filename);
+    if (!os) {
+        g_warning("Could not write trace to %s", filename.c_str());
+        return;
+    }
+
+    // Complete events ("ph":"X") and counter events ("ph":"C"); timestamps are in microseconds relative to init().
+    auto const pid = 1;
+    auto const write_us = [&] (std::int64_t ns) {
+        os << ns / 1000 << '.' << static_cast<char>('0' + ns % 1000 / 100)
+           << static_cast<char>('0' + ns % 100 / 10) << static_cast<char>('0' + ns % 10);
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    std::size_t dropped = 0;
+
+    auto lock = std::lock_guard(threads_mutex);
+    for (auto &thread : threads) {
+        auto thread_lock = std::lock_guard(thread->mutex);
+        dropped += thread->dropped;
+
+        if (!first) {
+            os << ",\n";
+        }
+        first = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread->tid
+           << ",\"args\":{\"name\":\"" << (thread->tid == 1 ? "main" : "worker ") ;
+        if (thread->tid != 1) {
+            os << thread->tid;
+        }
+        os << "\"}}";
+
+        for (auto const &span : thread->spans) {
+            os << ",\n{\"name\":\"";
+            write_escaped(os, span.name);
+            os << "\",\"cat\":\"";
+            write_escaped(os, span.category);
+            os << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << thread->tid << ",\"ts\":";
+            write_us(std::max<std::int64_t>(span.start - start_time, 0));
+            os << ",\"dur\":";
+            write_us(std::max<std::int64_t>(span.end - span.start, 0));
+            os << "}";
+        }
+        thread->spans.clear();
+
+        for (auto const &counter : thread->counters) {
+            os << ",\n{\"name\":\"";
+            write_escaped(os, counter.name);
+            os << "\",\"cat\":\"";
+            write_escaped(os, counter.category);
+            os << "\",\"ph\":\"C\",\"pid\":" << pid << ",\"tid\":" << thread->tid << ",\"ts\":";
+            write_us(std::max<std::int64_t>(counter.time - start_time, 0));
+            os << ",\"args\":{";
+            bool first_value = true;
+            for (auto const &[key, value] : counter.values) {
+                if (!first_value) {
+                    os << ",";
+                }
+                first_value = false;
+                os << "\"";
+                write_escaped(os, key);
+                os << "\":" << value;
+            }
+            os << "}}";
+        }
+        thread->counters.clear();
+    }
+    os << "\n]}\n";
+
+    if (dropped) {
+        g_warning("Trace buffer full: %zu spans and counters were not recorded", dropped);
+    }
+}
+
+}
+
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::Trace - timing of hot paths in Chrome Trace Event format
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DEBUG_TRACE_H
+#define SEEN_INKSCAPE_DEBUG_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+#include "debug/timestamp.h"
+
+namespace Inkscape {
+
+namespace Debug {
+
+/**
+ * Records timed spans from any thread and writes them out as Chrome Trace Event JSON, which
+ * can be opened in chrome://tracing or Perfetto.
+ *
+ * Set INKSCAPE_TRACE to the name of the output file to enable it; the file is written when
+ * Inkscape exits. While disabled, a span costs a single relaxed load of a flag.
+ */
+class Trace {
+public:
+    static void init();
+    static void shutdown();
+
+    static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    /// Record a finished span of the calling thread. Name and category must outlive the trace.
+    static void record(char const *name, char const *category, std::int64_t start_ns, std::int64_t end_ns);
+
+    /// Record the current values of a set of counters, shown as a graph over time. Names must outlive the trace.
+    static void counter(char const *name, char const *category,
+                        std::initializer_list<std::pair<char const *, double>> values);
+
+    /// Return a copy of a name that lives as long as the trace, for names built at runtime.
+    static char const *intern(std::string const &name);
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+/**
+ * Times the scope it lives in:
+ *
+ *     auto const span = Debug::TraceSpan("document update", "document");
+ */
+class TraceSpan {
+public:
+    TraceSpan(char const *name, char const *category)
+        : _name(name)
+        , _category(category)
+        , _start(Trace::enabled() ? timestamp_ns() : 0)
+    {}
+
+    ~TraceSpan()
+    {
+        if (_start) {
+            Trace::record(_name, _category, _start, timestamp_ns());
+        }
+    }
+
+    TraceSpan(TraceSpan const &) = delete;
+    TraceSpan &operator=(TraceSpan const &) = delete;
+
+private:
+    char const *_name;
+    char const *_category;
+    std::int64_t _start;
+};
+
+}
+
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -27,6 +27,7 @@ static const int OPENMP_THRESHOLD = 2048;
 
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include <cairo.h>
 #include "display/nr-3dutils.h"
 #include "display/cairo-utils.h"
@@ -394,6 +395,36 @@ void ink_cairo_surface_synthesize(cairo_surface_t *out, Synth synth)
     ink_cairo_surface_synthesize(out, area, synth);
 }
 
+/**
+ * Synthesize the rows of an ARGB32 surface.
+ * Like ink_cairo_surface_synthesize(), but the functor is called once per row as
+ * synth.row(y, out_row) and fills in the whole row, so that it can work on arrays of values
+ * rather than one pixel at a time. Rows are shared out between the filter threads.
+ * @param out    Output surface
+ * @param synth  Synthesis functor
+ */
+template <typename Synth>
+void ink_cairo_surface_synthesize_rows(cairo_surface_t *out, Synth synth)
+{
+    int w = cairo_image_surface_get_width(out);
+    int h = cairo_image_surface_get_height(out);
+    int strideout = cairo_image_surface_get_stride(out);
+    unsigned char *out_data = cairo_image_surface_get_data(out);
+
+    #if HAVE_OPENMP
+    int limit = w * h;
+    int numOfThreads = get_num_filter_threads();
+    #endif
+
+    #if HAVE_OPENMP
+    #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
+    #endif
+    for (int i = 0; i < h; ++i) {
+        synth.row(i, reinterpret_cast<guint32*>(out_data + i * strideout));
+    }
+    cairo_surface_mark_dirty(out);
+}
+
 struct SurfaceSynth {
     SurfaceSynth(cairo_surface_t *surface)
         : _px(cairo_image_surface_get_data(surface))
@@ -629,6 +660,61 @@ struct SurfaceSynth {
         return normal;
     }
 
+    /// Fetch the alpha values of a whole row, multiplied by scale.
+    void alphaRow(int y, float *alpha, float scale = 1.0f) const {
+        unsigned char const *row = _px + y*_stride;
+        if (_alpha) {
+            for (int x = 0; x < _w; ++x) {
+                alpha[x] = row[x] * scale;
+            }
+        } else {
+            guint32 const *px = reinterpret_cast<guint32 const *>(row);
+            for (int x = 0; x < _w; ++x) {
+                alpha[x] = (px[x] >> 24) * scale;
+            }
+        }
+    }
+
+    /**
+     * Compute the surface normals of a whole row, like surfaceNormalAt().
+     * Pixels away from the edges of the surface are computed together in loops without
+     * branches, which the compiler turns into vector instructions.
+     */
+    void surfaceNormalRow(int y, double scale, float *nx, float *ny, float *nz) const {
+        auto const store = [&] (int x) {
+            NR::Fvector normal = surfaceNormalAt(x, y, scale);
+            nx[x] = normal[X_3D];
+            ny[x] = normal[Y_3D];
+            nz[x] = normal[Z_3D];
+        };
+
+        if (G_UNLIKELY(y == 0 || y == _h - 1 || _w < 3)) {
+            for (int x = 0; x < _w; ++x) {
+                store(x);
+            }
+            return;
+        }
+
+        std::vector<float> above(_w), here(_w), below(_w);
+        alphaRow(y - 1, above.data());
+        alphaRow(y,     here.data());
+        alphaRow(y + 1, below.data());
+
+        float const f = -scale / 255.0 / 4.0;
+        for (int x = 1; x < _w - 1; ++x) {
+            float gx = (above[x+1] - above[x-1]) + 2.0f * (here[x+1] - here[x-1]) + (below[x+1] - below[x-1]);
+            float gy = (below[x-1] + 2.0f * below[x] + below[x+1]) - (above[x-1] + 2.0f * above[x] + above[x+1]);
+            gx *= f;
+            gy *= f;
+            float inv = 1.0f / std::sqrt(gx * gx + gy * gy + 1.0f);
+            nx[x] = gx * inv;
+            ny[x] = gy * inv;
+            nz[x] = inv;
+        }
+        store(0);
+        store(_w - 1);
+    }
+
     unsigned char *_px;
     int _w, _h, _stride;
     bool _alpha;
@@ -32,6 +32,7 @@ struct CanvasItemBuffer
     int device_scale; // For high DPI monitors.
     Cairo::RefPtr<Cairo::Context> cr;
     bool outline_pass;
+    bool preview = false; // Render quickly at reduced quality, to be replaced later.
 };
 
 } // namespace Inkscape
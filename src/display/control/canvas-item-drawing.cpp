@@ -116,7 +116,9 @@ void CanvasItemDrawing::_update(bool)
 void CanvasItemDrawing::_render(Inkscape::CanvasItemBuffer &buf) const
 {
     auto dc = Inkscape::DrawingContext(buf.cr->cobj(), buf.rect.min());
-    _drawing->render(dc, buf.rect, buf.outline_pass * DrawingItem::RENDER_OUTLINE);
+    // Previews skip filters, so must not be served from or stored in the caches of filtered items.
+    auto const preview_flags = DrawingItem::RENDER_NO_FILTERS | DrawingItem::RENDER_BYPASS_CACHE;
+    _drawing->render(dc, buf.rect, buf.outline_pass * DrawingItem::RENDER_OUTLINE | buf.preview * preview_flags);
 }
 
 /**
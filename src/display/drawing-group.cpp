@@ -78,6 +78,9 @@ unsigned DrawingGroup::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
 {
     if (!stop_at) {
         // normal rendering
+        if (_child_type == ChildType::ROOT && _drawing._renderDisplayList(dc, rc, area, flags)) {
+            return RENDER_OK;
+        }
         for (auto &i : _children) {
             i.render(dc, rc, area, flags, stop_at);
         }
@@ -24,6 +24,7 @@
 #include "display/cairo-templates.h"
 
 #include "display/control/canvas-item-drawing.h"
+#include "debug/trace.h"
 #include "ui/widget/canvas.h" // Mark area for redrawing.
 
 #include "nr-filter.h"
@@ -31,7 +32,9 @@
 
 #include "object/sp-item.h"
 
-static constexpr auto CACHE_SCORE_THRESHOLD = 50000.0; ///< Do not consider objects for caching below this score.
+static constexpr auto CACHE_SCORE_THRESHOLD = 100000.0; ///< Do not consider objects for caching that render faster than this, in nanoseconds.
+static constexpr auto ESTIMATED_COST_PER_PIXEL = 2.0; ///< Rendering time per pixel assumed until an item is measured, in nanoseconds.
+static constexpr auto RENDER_COST_SMOOTHING = 0.25f; ///< Weight of each new measurement in the average rendering time.
 
 namespace Inkscape {
 
@@ -112,6 +115,12 @@ DrawingItem::~DrawingItem()
     // Remove from the set of cached items and delete cache.
     _setCached(false, true);
 
+    // Forget any pending request to rescore.
+    {
+        auto lock = std::lock_guard(_drawing._rescore_mutex);
+        _drawing._rescore_items.erase(this);
+    }
+
     _children.clear_and_dispose([] (auto c) { delete c; });
     delete _clip;
     delete _mask;
@@ -148,6 +157,7 @@ void DrawingItem::appendChild(DrawingItem *item)
 
     defer([=] {
         _children.push_back(*item);
+        _drawing._invalidateDisplayList();
 
         // This ensures that _markForUpdate() called on the child will recurse to this item
         item->_state = STATE_ALL;
@@ -168,6 +178,7 @@ void DrawingItem::prependChild(DrawingItem *item)
 
     defer([=] {
         _children.push_front(*item);
+        _drawing._invalidateDisplayList();
         item->_state = STATE_ALL;
         item->_markForUpdate(STATE_ALL, true);
     });
@@ -180,6 +191,7 @@ void DrawingItem::clearChildren()
         if (_children.empty()) return;
         _markForRendering();
         _children.clear_and_dispose([] (auto c) { delete c; });
+        _drawing._invalidateDisplayList();
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -202,6 +214,7 @@ void DrawingItem::setOpacity(float opacity)
     defer([=] {
         if (opacity == _opacity) return;
         _opacity = opacity;
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -211,6 +224,7 @@ void DrawingItem::setAntialiasing(Antialiasing antialias)
     defer([=] {
         if (_antialias == antialias) return;
         _antialias = antialias;
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -220,6 +234,7 @@ void DrawingItem::setIsolation(bool isolation)
     defer([=] {
         if (isolation == _isolation) return;
         _isolation = isolation;
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -229,6 +244,7 @@ void DrawingItem::setBlendMode(SPBlendMode blend_mode)
     defer([=] {
         if (blend_mode == _blend_mode) return;
         _blend_mode = blend_mode;
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -238,6 +254,7 @@ void DrawingItem::setVisible(bool visible)
     defer([=] {
         if (visible == _visible) return;
         _visible = visible;
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -277,6 +294,7 @@ void DrawingItem::_setCached(bool cached, bool persistent)
         _cache.reset();
         _drawing._cached_items.erase(this);
     }
+    _invalidateDisplayList();
 }
 
 /**
@@ -350,6 +368,7 @@ void DrawingItem::setClip(DrawingItem *item)
         _markForRendering();
         delete _clip;
         _clip = item;
+        _invalidateDisplayList();
         _markForUpdate(STATE_ALL, true);
     });
 }
@@ -366,6 +385,7 @@ void DrawingItem::setMask(DrawingItem *item)
         _markForRendering();
         delete _mask;
         _mask = item;
+        _invalidateDisplayList();
         _markForUpdate(STATE_ALL, true);
     });
 }
@@ -414,6 +434,7 @@ void DrawingItem::setZOrder(unsigned zorder)
         auto it2 = _parent->_children.begin();
         std::advance(it2, std::min<unsigned>(zorder, _parent->_children.size()));
         _parent->_children.insert(it2, *this);
+        _drawing._invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -429,6 +450,7 @@ void DrawingItem::setFilterRenderer(std::unique_ptr<Filters::Filter> filter)
 {
     defer([=, filter = std::move(filter)] () mutable {
         _filter = std::move(filter);
+        _invalidateDisplayList();
         _markForRendering();
     });
 }
@@ -457,6 +479,8 @@ void DrawingItem::setFilterRenderer(std::unique_ptr<Filters::Filter> filter)
  */
 void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset)
 {
+    auto const span = Debug::TraceSpan("DrawingItem::update", "drawing");
+
     // We don't need to update what is not visible
     if (!_visible) {
         _state = STATE_ALL; // Touch the state for future change to this item
@@ -526,6 +550,9 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         ctm_change = _ctm.inverse() * child_ctx.ctm;
         affine_changed = true;
     }
+    if (_ctm.isSingular(1e-18) != child_ctx.ctm.isSingular(1e-18)) {
+        _invalidateDisplayList();
+    }
     _ctm = child_ctx.ctm;
 
     bool const totally_invalidated = reset & STATE_TOTAL_INV;
@@ -626,13 +653,13 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         bool cacheable = !_contains_unisolated_blend || isolated;
 
         // Determine whether to make this item eligible for caching, by creating a cache iterator.
+        // This requires caching it to save enough rendering time per frame.
         double score = _cacheScore();
-        if (score >= CACHE_SCORE_THRESHOLD && cacheable) {
+        auto const cache_rect = _cacheRect();
+        if (cache_rect && score * cache_rect->area() * 4 >= CACHE_SCORE_THRESHOLD && cacheable) {
             CacheRecord cr;
             cr.score = score;
-            // if _cacheRect() is empty, a negative score will be returned from _cacheScore(),
-            // so this will not execute (cache score threshold must be positive)
-            cr.cache_size = _cacheRect()->area() * 4;
+            cr.cache_size = cache_rect->area() * 4;
             cr.item = this;
             auto it = std::lower_bound(_drawing._candidate_items.begin(), _drawing._candidate_items.end(), cr, std::greater<CacheRecord>());
             _cache_iterator = _drawing._candidate_items.insert(it, cr);
@@ -702,9 +729,13 @@ struct MaskLuminanceToAlpha
  */
 unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const
 {
+    auto const span = Debug::TraceSpan("DrawingItem::render", "drawing");
+
     bool const outline = flags & RENDER_OUTLINE;
     bool const render_filters = !(flags & RENDER_NO_FILTERS);
     bool const forcecache = _filter && render_filters;
+    // The cache of a filtered item holds the filtered rendering, so leave it alone when skipping filters.
+    bool const use_cache = _cache && !(flags & RENDER_BYPASS_CACHE) && (render_filters || !_filter);
 
     // stop_at is handled in DrawingGroup, but this check is required to handle the case
     // where a filtered item with background-accessing filter has enable-background: new
@@ -754,7 +785,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     std::unique_lock<std::mutex> lock;
 
     // Render from cache if possible, unless requested not to (hatches).
-    if (_cache && !(flags & RENDER_BYPASS_CACHE)) {
+    if (use_cache) {
         lock = std::unique_lock(_cache->mutables);
 
         if (_cache->surface) {
@@ -766,6 +797,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
             _cache->surface->paintFromCache(dc, carea, forcecache);
             if (!carea) {
                 dc.setSource(0, 0, 0, 0);
+                _drawing._cache_hits.fetch_add(1, std::memory_order_relaxed);
                 return RENDER_OK;
             }
         } else {
@@ -777,6 +809,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
                 cl = carea;
             _cache->surface.emplace(*cl, device_scale);
         }
+        _drawing._cache_misses.fetch_add(1, std::memory_order_relaxed);
 
         if (!forcecache) {
             lock.unlock(); // Only hold the lock for the full duration of rendering for filters.
@@ -785,6 +818,10 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
         // if our caching was turned off after the last update, it was already deleted in setCached()
     }
 
+    // Measure the time taken to render the item, which decides whether it is worth caching.
+    bool const measure = _drawing._cache_budget > 0 && !stop_at && !(flags & RENDER_FILTER_BACKGROUND);
+    auto const start = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
     // determine whether this shape needs intermediate rendering.
     bool const greyscale = _drawing.colorMode() == ColorMode::GRAYSCALE && !(flags & RENDER_OUTLINE);
     bool const isolate_root = _contains_unisolated_blend || greyscale;
@@ -820,7 +857,11 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     if ((flags & RENDER_FILTER_BACKGROUND) || !needs_intermediate_rendering) {
         dc.setOperator(ink_css_blend_to_cairo_operator(SP_CSS_BLEND_NORMAL));
         apply_antialias(dc, antialias);
-        return _renderItem(dc, rc, *carea, flags & ~RENDER_FILTER_BACKGROUND, stop_at);
+        auto const result = _renderItem(dc, rc, *carea, flags & ~RENDER_FILTER_BACKGROUND, stop_at);
+        if (measure) {
+            _recordRenderCost(start, *carea);
+        }
+        return result;
     }
 
     DrawingSurface intermediate(*carea, device_scale);
@@ -909,7 +950,7 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     ict.paint();
 
     // 6. Paint the completed rendering onto the base context (or into cache)
-    if (_cache && !(flags & RENDER_BYPASS_CACHE)) {
+    if (use_cache) {
         if (!forcecache) {
             lock.lock(); // Only hold the lock for the full duration of rendering for filters.
         }
@@ -935,6 +976,10 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
 
     // the call above is to clear a ref on the intermediate surface held by dc
 
+    if (measure) {
+        _recordRenderCost(start, *carea);
+    }
+
     return render_result;
 }
 
@@ -1130,6 +1175,8 @@ void DrawingItem::_markForRendering()
         bkg_root->_invalidateFilterBackground(*dirty);
     }
 
+    _drawing._invalidateDisplayList(*dirty);
+
     if (auto canvasitem = drawing().getCanvasItemDrawing()) {
         canvasitem->get_canvas()->redraw_area(*dirty);
     }
@@ -1148,6 +1195,35 @@ void DrawingItem::_invalidateFilterBackground(Geom::IntRect const &area)
     }
 }
 
+/**
+ * Drops the display lists of the drawing if this item is flattened into them, or could be
+ * after a change to it. Items that are not groups only affect the display lists through their
+ * bounding boxes, which _markForRendering() takes care of.
+ */
+void DrawingItem::_invalidateDisplayList()
+{
+    if (tag() == tag_of<DrawingGroup>) {
+        _drawing._invalidateDisplayList();
+    }
+}
+
+/**
+ * Whether rendering this item amounts to rendering its children in turn, so that the display
+ * lists can look through it. This must agree with the short-circuit in render().
+ */
+bool DrawingItem::_rendersThrough() const
+{
+    return tag() == tag_of<DrawingGroup>
+        && _child_type == ChildType::NORMAL
+        && !_clip
+        && !_mask
+        && !_filter
+        && !_cache
+        && _opacity >= 0.995
+        && _blend_mode == SP_CSS_BLEND_NORMAL
+        && _isolation != SP_CSS_ISOLATION_ISOLATE;
+}
+
 /**
  * Marks the item as needing a recomputation of internal data.
  *
@@ -1190,7 +1266,8 @@ void DrawingItem::_markForUpdate(unsigned flags, bool propagate)
 }
 
 /**
- * Compute the caching score.
+ * Compute the caching score: the rendering time caching the item saves per byte of cache,
+ * in nanoseconds.
  *
  * Higher scores mean the item is more aggressively prioritized for automatic
  * caching by Inkscape::Drawing.
@@ -1199,6 +1276,25 @@ double DrawingItem::_cacheScore()
 {
     Geom::OptIntRect cache_rect = _cacheRect();
     if (!cache_rect) return -1.0;
+    // Once the item has been rendered, go by how long that took.
+    // Until then, estimate it from the complexity of the item.
+    double cost = _render_cost.load(std::memory_order_relaxed);
+    if (cost <= 0.0) {
+        cost = _renderComplexity() / cache_rect->area() * ESTIMATED_COST_PER_PIXEL;
+    }
+    _scored_cost = cost;
+    // The cache takes four bytes per pixel.
+    return cost / 4;
+}
+
+/**
+ * Estimate the work of rendering the item, in units of plain pixels.
+ * Used to score items for caching before they have been rendered.
+ */
+double DrawingItem::_renderComplexity() const
+{
+    Geom::OptIntRect cache_rect = _cacheRect();
+    if (!cache_rect) return 0.0;
     // a crude first approximation:
     // the basic score is the number of pixels in the drawbox
     double score = cache_rect->area();
@@ -1218,12 +1314,35 @@ double DrawingItem::_cacheScore()
     }
     // if masked, add mask score
     if (_mask) {
-        score += _mask->_cacheScore();
+        score += _mask->_renderComplexity();
     }
-    //g_message("caching score: %f", score);
     return score;
 }
 
+/**
+ * Fold the time taken to render an area of the item into its average rendering cost.
+ * If the cost has moved far from the one the item was last scored with, and may make a
+ * difference to its caching, ask the drawing to rescore it after rendering.
+ */
+void DrawingItem::_recordRenderCost(std::chrono::steady_clock::time_point start, Geom::IntRect const &area) const
+{
+    if (area.hasZeroArea()) return;
+
+    auto const elapsed = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count();
+    auto const sample = elapsed / area.area();
+    auto const previous = _render_cost.load(std::memory_order_relaxed);
+    auto const cost = previous > 0.0f ? previous + RENDER_COST_SMOOTHING * (sample - previous) : sample;
+    _render_cost.store(cost, std::memory_order_relaxed);
+
+    if (cost <= 2 * _scored_cost && 2 * cost >= _scored_cost) return;
+
+    auto const cache_rect = _cacheRect();
+    if (_has_cache_iterator || (cache_rect && cost * cache_rect->area() >= CACHE_SCORE_THRESHOLD)) {
+        auto lock = std::lock_guard(_drawing._rescore_mutex);
+        _drawing._rescore_items.insert(this);
+    }
+}
+
 inline void expandByScale(Geom::IntRect &rect, double scale)
 {
     double fraction = (scale - 1) / 2;
@@ -1305,6 +1424,7 @@ void DrawingItem::unlink()
             case ChildType::NORMAL: {
                 auto it = _parent->_children.iterator_to(*this);
                 _parent->_children.erase(it);
+                _drawing._invalidateDisplayList();
                 break;
             }
             case ChildType::CLIP:
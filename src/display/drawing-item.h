@@ -13,6 +13,8 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_ITEM_H
 #define INKSCAPE_DISPLAY_DRAWING_ITEM_H
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <list>
 #include <exception>
@@ -183,7 +185,11 @@ protected:
     void _markForUpdate(unsigned state, bool propagate);
     void _markForRendering();
     void _invalidateFilterBackground(Geom::IntRect const &area);
+    void _invalidateDisplayList();
+    bool _rendersThrough() const;
     double _cacheScore();
+    double _renderComplexity() const;
+    void _recordRenderCost(std::chrono::steady_clock::time_point start, Geom::IntRect const &area) const;
     Geom::OptIntRect _cacheRect() const;
     void _setCached(bool cached, bool persistent = false);
     virtual unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) { return 0; }
@@ -227,6 +233,8 @@ protected:
     std::unique_ptr<Inkscape::Filters::Filter> _filter;
     std::unique_ptr<CacheData> _cache;
     int _update_complexity = 0;
+    mutable std::atomic<float> _render_cost = 0.0f; ///< Average measured rendering time per pixel, in nanoseconds.
+    float _scored_cost = 0.0f; ///< The rendering time per pixel the cache score was last computed from.
     bool _contains_unisolated_blend : 1;
 
     CacheList::iterator _cache_iterator;
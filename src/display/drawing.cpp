@@ -11,12 +11,15 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <array>
 #include <thread>
 #include "display/drawing.h"
 #include "display/control/canvas-item-drawing.h"
+#include "debug/trace.h"
 #include "nr-filter-gaussian.h"
 #include "nr-filter-types.h"
+#include "util/parallel.h"
 
 // Grayscale colormode
 #include "cairo-templates.h"
@@ -42,6 +45,35 @@ static auto rendermode_to_renderflags(RenderMode mode)
     }
 }
 
+static constexpr int DISPLAY_CELL_SIZE = 256; ///< Side of the display list cells, in pixels.
+static constexpr std::int64_t DISPLAY_CELLS_PER_RENDER = 64; ///< Larger areas are rendered by walking the tree.
+static constexpr std::size_t DISPLAY_CELLS_MAX = 4096; ///< Number of cells kept before dropping them all.
+
+static int display_cell_index(int coord)
+{
+    return coord >= 0 ? coord / DISPLAY_CELL_SIZE : -((-coord - 1) / DISPLAY_CELL_SIZE) - 1;
+}
+
+static std::int64_t display_cell_key(int x, int y)
+{
+    return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+}
+
+static Geom::IntRect display_cell_rect(std::int64_t key)
+{
+    auto const x = static_cast<int>(key >> 32);
+    auto const y = static_cast<int>(static_cast<std::uint32_t>(key));
+    return Geom::IntRect::from_xywh(x * DISPLAY_CELL_SIZE, y * DISPLAY_CELL_SIZE, DISPLAY_CELL_SIZE, DISPLAY_CELL_SIZE);
+}
+
+/// Range of the cells meeting an area, as {x0, y0, x1, y1} inclusive.
+static std::array<int, 4> display_cell_range(Geom::IntRect const &area)
+{
+    return {display_cell_index(area.left()), display_cell_index(area.top()),
+            display_cell_index(std::max(area.right() - 1, area.left())),
+            display_cell_index(std::max(area.bottom() - 1, area.top()))};
+}
+
 static auto default_numthreads()
 {
     auto ret = std::thread::hardware_concurrency();
@@ -62,6 +94,7 @@ Drawing::~Drawing()
 
 void Drawing::setRoot(DrawingItem *root)
 {
+    _invalidateDisplayList();
     delete _root;
     _root = root;
     if (_root) {
@@ -80,6 +113,7 @@ void Drawing::setRenderMode(RenderMode mode)
         _rendermode = mode;
         _root->_markForUpdate(DrawingItem::STATE_ALL, true);
         _clearCache();
+        _invalidateDisplayList();
     });
 }
 
@@ -100,6 +134,7 @@ void Drawing::setOutlineOverlay(bool outlineoverlay)
         if (outlineoverlay == _outlineoverlay) return;
         _outlineoverlay = outlineoverlay;
         _root->_markForUpdate(DrawingItem::STATE_ALL, true);
+        _invalidateDisplayList();
     });
 }
 
@@ -269,19 +304,62 @@ void Drawing::unsnapshot()
     assert(_snapshotted);
     _snapshotted = false; // Unsnapshot before replaying log so further work is not deferred.
     _funclog();
+
+    // Rescore the items whose rendering cost was found to differ from what they were scored with.
+    std::unordered_set<DrawingItem const *> rescore;
+    {
+        auto lock = std::lock_guard(_rescore_mutex);
+        rescore.swap(_rescore_items);
+    }
+    for (auto item : rescore) {
+        // Safe, since items are only modified outside of rendering.
+        const_cast<DrawingItem *>(item)->_markForUpdate(DrawingItem::STATE_CACHE, false);
+    }
+
+    // Report how the cache did over this round of rendering.
+    if (Debug::Trace::enabled()) {
+        auto const stats = cacheStats();
+        Debug::Trace::counter("render cache", "drawing", {{"hits", double(stats.hits)},
+                                                          {"misses", double(stats.misses)},
+                                                          {"evictions", double(stats.evictions)}});
+        Debug::Trace::counter("render cache size", "drawing", {{"items", double(stats.items)},
+                                                               {"bytes", double(stats.bytes)}});
+        resetCacheStats();
+    }
+}
+
+Drawing::CacheStats Drawing::cacheStats() const
+{
+    return {
+        _cache_hits.load(std::memory_order_relaxed),
+        _cache_misses.load(std::memory_order_relaxed),
+        _cache_evictions,
+        _cached_items.size(),
+        _cache_used
+    };
+}
+
+void Drawing::resetCacheStats()
+{
+    _cache_hits = 0;
+    _cache_misses = 0;
+    _cache_evictions = 0;
 }
 
 void Drawing::_pickItemsForCaching()
 {
     // Build sorted list of items that should be cached.
+    // Candidates are ordered by the rendering time they save per byte, so take them in order,
+    // passing over those too large for what is left of the budget.
     std::vector<DrawingItem*> to_cache;
     size_t used = 0;
     for (auto &rec : _candidate_items) {
-        if (used + rec.cache_size > _cache_budget) break;
+        if (used + rec.cache_size > _cache_budget) continue;
         to_cache.emplace_back(rec.item);
         used += rec.cache_size;
     }
     std::sort(to_cache.begin(), to_cache.end());
+    _cache_used = used;
 
     // Uncache the items that are cached but should not be cached.
     // Note: setCached() modifies _cached_items, so the temporary container is necessary.
@@ -292,6 +370,7 @@ void Drawing::_pickItemsForCaching()
     for (auto item : to_uncache) {
         item->_setCached(false);
     }
+    _cache_evictions += to_uncache.size();
 
     // Cache all items that should be cached (no-op if already cached).
     for (auto item : to_cache) {
@@ -309,6 +388,148 @@ void Drawing::_clearCache()
     }
 }
 
+/// Drop the display lists entirely, because the structure of the tree has changed.
+void Drawing::_invalidateDisplayList()
+{
+    auto lock = std::lock_guard(_display_mutex);
+    _display_items_valid = false;
+    _display_items.clear();
+    for (auto &cells : _display_cells) {
+        cells.clear();
+    }
+}
+
+/// Drop the display lists of the cells meeting an area in which items have changed.
+void Drawing::_invalidateDisplayList(Geom::IntRect const &area)
+{
+    auto lock = std::lock_guard(_display_mutex);
+
+    auto const [x0, y0, x1, y1] = display_cell_range(area);
+    auto const count = std::int64_t{x1 - x0 + 1} * (y1 - y0 + 1);
+
+    for (auto &cells : _display_cells) {
+        if (cells.empty()) {
+            continue;
+        }
+        if (count <= static_cast<std::int64_t>(cells.size())) {
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    cells.erase(display_cell_key(x, y));
+                }
+            }
+        } else {
+            for (auto it = cells.begin(); it != cells.end(); ) {
+                if (display_cell_rect(it->first).intersects(area)) {
+                    it = cells.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+}
+
+/// Append the children of a group to the display list, looking through the groups among them
+/// that render nothing but their children.
+void Drawing::_flattenDisplayList(DrawingItem const &group)
+{
+    for (auto &child : group._children) {
+        if (!child._rendersThrough()) {
+            _display_items.push_back({ &child, group._antialias });
+        } else if (child._visible && !child._ctm.isSingular(1e-18)) {
+            _flattenDisplayList(child);
+        }
+    }
+}
+
+/**
+ * Render the children of the root from the display lists of the cells meeting the area.
+ * Returns false if the display lists are not used, in which case the caller walks the tree.
+ */
+bool Drawing::_renderDisplayList(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags)
+{
+    // Only the Canvas's drawing renders the same areas repeatedly.
+    if (!_canvas_item_drawing || !_root) {
+        return false;
+    }
+
+    auto const [x0, y0, x1, y1] = display_cell_range(area);
+    if (std::int64_t{x1 - x0 + 1} * (y1 - y0 + 1) > DISPLAY_CELLS_PER_RENDER) {
+        return false;
+    }
+
+    bool const outline = flags & DrawingItem::RENDER_OUTLINE;
+    std::vector<DisplayItem> items;
+
+    {
+        auto lock = std::lock_guard(_display_mutex);
+
+        if (!_display_items_valid) {
+            _display_items.clear();
+            _flattenDisplayList(*_root);
+            _display_items_valid = true;
+        }
+
+        auto &cells = _display_cells[outline];
+        if (cells.size() > DISPLAY_CELLS_MAX) {
+            cells.clear();
+        }
+
+        // Build the missing cells in a single pass over the items.
+        std::vector<std::pair<Geom::IntRect, std::vector<unsigned> *>> missing;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                auto const key = display_cell_key(x, y);
+                auto [it, inserted] = cells.try_emplace(key);
+                if (inserted) {
+                    missing.emplace_back(display_cell_rect(key), &it->second);
+                }
+            }
+        }
+        if (!missing.empty()) {
+            for (unsigned i = 0; i < _display_items.size(); i++) {
+                auto const item = _display_items[i].item;
+                auto const &box = outline ? item->bbox() : item->drawbox();
+                if (!box) {
+                    continue;
+                }
+                for (auto &[rect, list] : missing) {
+                    if (rect.intersects(*box)) {
+                        list->push_back(i);
+                    }
+                }
+            }
+        }
+
+        std::vector<unsigned> indices;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                auto const &list = cells[display_cell_key(x, y)];
+                indices.insert(indices.end(), list.begin(), list.end());
+            }
+        }
+        if (x0 != x1 || y0 != y1) {
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        }
+
+        items.reserve(indices.size());
+        for (auto i : indices) {
+            items.push_back(_display_items[i]);
+        }
+    }
+
+    // Render without holding the lock, as other threads may be rendering other tiles.
+    for (auto const &d : items) {
+        if (!outline) {
+            apply_antialias(dc, rc.antialiasing_override.value_or(d.antialias));
+        }
+        d.item->render(dc, rc, area, flags);
+    }
+
+    return true;
+}
+
 void Drawing::_loadPrefs()
 {
     auto prefs = Inkscape::Preferences::get();
@@ -333,7 +554,9 @@ void Drawing::_loadPrefs()
     }
 
     // Set the global variable governing the number of filter threads, and track it too. (This is ugly, but hopefully transitional.)
-    set_num_filter_threads(prefs->getIntLimited("/options/threading/numthreads", default_numthreads(), 1, 256));
+    int const numthreads = prefs->getIntLimited("/options/threading/numthreads", default_numthreads(), 1, 256);
+    set_num_filter_threads(numthreads);
+    Util::set_num_threads(numthreads);
 
     // Similarly, enable preference tracking only for the Canvas's drawing.
     if (_canvas_item_drawing) {
@@ -350,7 +573,11 @@ void Drawing::_loadPrefs()
         actions.emplace("/options/cursortolerance/value",        [this] (auto &entry) { setCursorTolerance(entry.getDouble(1.0)); });
         actions.emplace("/options/selection/zeroopacity",        [this] (auto &entry) { setSelectZeroOpacity(entry.getBool(false)); });
         actions.emplace("/options/renderingcache/size",          [this] (auto &entry) { setCacheBudget((1 << 20) * entry.getIntLimited(64, 0, 4096)); });
-        actions.emplace("/options/threading/numthreads",         [this] (auto &entry) { set_num_filter_threads(entry.getIntLimited(default_numthreads(), 1, 256)); });
+        actions.emplace("/options/threading/numthreads",         [] (auto &entry) {
+            int const numthreads = entry.getIntLimited(default_numthreads(), 1, 256);
+            set_num_filter_threads(numthreads);
+            Util::set_num_threads(numthreads);
+        });
 
         _pref_tracker = Inkscape::Preferences::PreferencesObserver::create("/options", [actions = std::move(actions)] (auto &entry) {
             auto it = actions.find(entry.getPath());
@@ -13,9 +13,14 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_H
 #define INKSCAPE_DISPLAY_DRAWING_H
 
+#include <array>
+#include <atomic>
 #include <optional>
+#include <mutex>
 #include <set>
 #include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <boost/operators.hpp>
 #include <2geom/rect.h>
@@ -88,6 +93,19 @@ public:
     void unsnapshot();
     bool snapshotted() const { return _snapshotted; }
 
+    /// Counters describing how well the render cache is doing, for inspection. While tracing, they are
+    /// written to the trace and reset each time the drawing is unsnapshotted.
+    struct CacheStats
+    {
+        std::size_t hits;      ///< Renders of cached items served entirely from the cache.
+        std::size_t misses;    ///< Renders of cached items that had to render some of their content.
+        std::size_t evictions; ///< Items uncached in favour of better candidates.
+        std::size_t items;     ///< Items currently cached.
+        std::size_t bytes;     ///< Size of the current caches, as counted against the budget.
+    };
+    CacheStats cacheStats() const;
+    void resetCacheStats();
+
     // Convenience
     void averageColor(Geom::IntRect const &area, double &R, double &G, double &B, double &A) const;
     void setExact();
@@ -97,6 +115,10 @@ private:
     void _pickItemsForCaching();
     void _clearCache();
     void _loadPrefs();
+    void _invalidateDisplayList();
+    void _invalidateDisplayList(Geom::IntRect const &area);
+    void _flattenDisplayList(DrawingItem const &group);
+    bool _renderDisplayList(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags);
 
     DrawingItem *_root = nullptr;
     CanvasItemDrawing *_canvas_item_drawing = nullptr;
@@ -122,6 +144,31 @@ private:
 
     std::set<DrawingItem*> _cached_items; // modified by DrawingItem::_setCached()
     CacheList _candidate_items;           // keep this list always sorted with std::greater
+    std::size_t _cache_used = 0;
+    std::atomic<std::size_t> _cache_hits = 0;
+    std::atomic<std::size_t> _cache_misses = 0;
+    std::size_t _cache_evictions = 0;
+
+    // Items whose measured rendering cost has changed enough to be rescored for caching.
+    std::mutex _rescore_mutex;
+    std::unordered_set<DrawingItem const *> _rescore_items;
+
+    /*
+     * Display lists, used by the canvas to render a tile without walking the whole tree.
+     * The items under the root are flattened into paint order, with groups that only render
+     * their children replaced by those children. Each cell of a fixed grid then lists the
+     * items that meet it, for normal and for outline rendering. Cells are rebuilt lazily once
+     * the items meeting them change, and the flattened list once the tree structure changes.
+     */
+    struct DisplayItem
+    {
+        DrawingItem const *item;
+        Antialiasing antialias; ///< Antialiasing set by the enclosing group.
+    };
+    std::mutex _display_mutex;
+    std::vector<DisplayItem> _display_items;
+    bool _display_items_valid = false;
+    std::array<std::unordered_map<std::int64_t, std::vector<unsigned>>, 2> _display_cells;
 
     /*
      * Simple cacheline separator compatible with x86 (64 bytes) and M* (128 bytes).
@@ -137,6 +184,7 @@ private:
     void defer(F &&f) { _snapshotted ? _funclog.emplace(std::forward<F>(f)) : f(); }
 
     friend class DrawingItem;
+    friend class DrawingGroup;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Convolution of sampled planes through the fast Fourier transform.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/fft-convolution.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+#include "display/cairo-utils.h"
+#include "util/parallel.h"
+
+namespace Inkscape {
+namespace Filters {
+
+namespace {
+
+// Cost of one butterfly relative to one multiply-add of direct summation.
+constexpr double FFT_BUTTERFLY_COST = 2.5;
+
+// Kernels with fewer taps are always summed directly; the transforms never win there.
+constexpr int FFT_MIN_KERNEL_TAPS = 49;
+
+// Planes larger than this many samples a side are correlated in overlapping blocks, which bounds
+// the size of the transforms and their buffers.
+constexpr int FFT_MAX_BLOCK_SIZE = 512;
+
+std::atomic<bool> fft_enabled = true;
+
+int fft_size(int n)
+{
+    int size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// The transform size along one side: the whole plane if it fits in a block, otherwise a block
+// that still leaves at least as many outputs as the kernel is long.
+int block_size(int n, int kernel)
+{
+    return std::min(fft_size(n), std::max(FFT_MAX_BLOCK_SIZE, fft_size(2 * kernel)));
+}
+
+int num_blocks(int n, int kernel)
+{
+    int const step = block_size(n, kernel) - kernel + 1;
+    return (n - kernel + step) / step;
+}
+
+void fft2d(std::vector<std::complex<double>> &data, int width, int height, bool inverse)
+{
+    int const threads = get_num_filter_threads();
+    Util::parallel_for(height, [&] (std::size_t y) {
+        fft(data.data() + y * width, width, 1, inverse);
+    }, threads);
+    Util::parallel_for(width, [&] (std::size_t x) {
+        fft(data.data() + x, height, width, inverse);
+    }, threads);
+}
+
+} // namespace
+
+void fft(std::complex<double> *data, int n, int stride, bool inverse)
+{
+    auto const at = [=] (int i) -> std::complex<double> & { return data[i * stride]; };
+
+    // Bit-reversal permutation
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(at(i), at(j));
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        auto const step = std::polar(1.0, (inverse ? 2.0 : -2.0) * M_PI / len);
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w = 1.0;
+            for (int k = 0; k < len / 2; k++) {
+                auto const u = at(i + k);
+                auto const v = at(i + k + len / 2) * w;
+                at(i + k) = u + v;
+                at(i + k + len / 2) = u - v;
+                w *= step;
+            }
+        }
+    }
+}
+
+void set_fft_convolution_enabled(bool enabled)
+{
+    fft_enabled = enabled;
+}
+
+bool fft_correlation_pays_off(int width, int height, int kernel_width, int kernel_height, int planes)
+{
+    if (!fft_enabled || kernel_width * kernel_height < FFT_MIN_KERNEL_TAPS || kernel_width > width || kernel_height > height) {
+        return false;
+    }
+
+    double const direct = double(width - kernel_width + 1) * (height - kernel_height + 1)
+                        * kernel_width * kernel_height * planes;
+
+    // One transform for the kernel, then a forward and an inverse one per pair of planes and block.
+    double const n = double(block_size(width, kernel_width)) * block_size(height, kernel_height);
+    int const blocks = num_blocks(width, kernel_width) * num_blocks(height, kernel_height);
+    int const transforms = 1 + 2 * ((planes + 1) / 2) * blocks;
+    double const transformed = FFT_BUTTERFLY_COST * transforms * n / 2 * std::log2(n);
+
+    return transformed < direct;
+}
+
+void fft_correlate(int planes, int width, int height, std::vector<double> const &kernel, int kernel_width,
+                   int kernel_height, FFTInput const &input, FFTOutput const &output)
+{
+    if (planes <= 0 || kernel_width <= 0 || kernel_height <= 0 || kernel_width > width || kernel_height > height) {
+        return;
+    }
+
+    int const out_w = width - kernel_width + 1;
+    int const out_h = height - kernel_height + 1;
+
+    // The correlation is circular, but no kernel position that is kept reaches past its block,
+    // so blocks overlapping by the size of the kernel never wrap around.
+    int const fft_w = block_size(width, kernel_width);
+    int const fft_h = block_size(height, kernel_height);
+    int const step_x = fft_w - kernel_width + 1;
+    int const step_y = fft_h - kernel_height + 1;
+
+    // Multiplying by the conjugate spectrum of the kernel correlates rather than convolves.
+    std::vector<std::complex<double>> kernel_spectrum(fft_w * fft_h);
+    for (int i = 0; i < kernel_height; i++) {
+        for (int j = 0; j < kernel_width; j++) {
+            kernel_spectrum[i * fft_w + j] = kernel[i * kernel_width + j];
+        }
+    }
+    fft2d(kernel_spectrum, fft_w, fft_h, false);
+    double const norm = 1.0 / (double(fft_w) * fft_h);
+    for (auto &k : kernel_spectrum) {
+        k = std::conj(k) * norm;
+    }
+
+    // Only one block of samples and sums is held at a time, interleaved by plane.
+    std::vector<double> samples(std::size_t(fft_w) * fft_h * planes);
+    std::vector<double> sums(std::size_t(step_x) * step_y * planes);
+    std::vector<std::complex<double>> work(fft_w * fft_h);
+
+    for (int by = 0; by < out_h; by += step_y) {
+        for (int bx = 0; bx < out_w; bx += step_x) {
+            int const in_w = std::min(fft_w, width - bx);
+            int const in_h = std::min(fft_h, height - by);
+            int const block_out_w = std::min(step_x, out_w - bx);
+            int const block_out_h = std::min(step_y, out_h - by);
+
+            for (int y = 0; y < in_h; y++) {
+                for (int x = 0; x < in_w; x++) {
+                    input(bx + x, by + y, &samples[(std::size_t(y) * fft_w + x) * planes]);
+                }
+            }
+
+            // The kernel is real, so two planes share each transform as its real and imaginary parts.
+            for (int p = 0; p < planes; p += 2) {
+                bool const pair = p + 1 < planes;
+
+                std::fill(work.begin(), work.end(), 0.0);
+                for (int y = 0; y < in_h; y++) {
+                    for (int x = 0; x < in_w; x++) {
+                        auto const sample = &samples[(std::size_t(y) * fft_w + x) * planes + p];
+                        work[y * fft_w + x] = {sample[0], pair ? sample[1] : 0.0};
+                    }
+                }
+
+                fft2d(work, fft_w, fft_h, false);
+                for (std::size_t i = 0; i < work.size(); i++) {
+                    work[i] *= kernel_spectrum[i];
+                }
+                fft2d(work, fft_w, fft_h, true);
+
+                for (int y = 0; y < block_out_h; y++) {
+                    for (int x = 0; x < block_out_w; x++) {
+                        auto const value = work[y * fft_w + x];
+                        auto const sum = &sums[(std::size_t(y) * step_x + x) * planes + p];
+                        sum[0] = value.real();
+                        if (pair) {
+                            sum[1] = value.imag();
+                        }
+                    }
+                }
+            }
+
+            for (int y = 0; y < block_out_h; y++) {
+                for (int x = 0; x < block_out_w; x++) {
+                    output(bx + x, by + y, &sums[(std::size_t(y) * step_x + x) * planes]);
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::vector<double>> fft_correlate(std::vector<std::vector<double>> const &planes, int width, int height,
+                                               std::vector<double> const &kernel, int kernel_width, int kernel_height)
+{
+    std::vector<std::vector<double>> result(planes.size());
+    if (kernel_width <= 0 || kernel_height <= 0 || kernel_width > width || kernel_height > height) {
+        return result;
+    }
+
+    int const out_w = width - kernel_width + 1;
+    int const out_h = height - kernel_height + 1;
+    for (auto &plane : result) {
+        plane.resize(out_w * out_h);
+    }
+
+    fft_correlate(planes.size(), width, height, kernel, kernel_width, kernel_height,
+        [&] (int x, int y, double *samples) {
+            for (std::size_t p = 0; p < planes.size(); p++) {
+                samples[p] = planes[p][y * width + x];
+            }
+        },
+        [&] (int x, int y, double const *sums) {
+            for (std::size_t p = 0; p < result.size(); p++) {
+                result[p][y * out_w + x] = sums[p];
+            }
+        });
+
+    return result;
+}
+
+} // namespace Filters
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
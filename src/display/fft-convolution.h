@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Convolution of sampled planes through the fast Fourier transform, for filter primitives
+ * whose kernels are too large for direct summation.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_FFT_CONVOLUTION_H
+#define INKSCAPE_DISPLAY_FFT_CONVOLUTION_H
+
+#include <complex>
+#include <functional>
+#include <vector>
+
+namespace Inkscape {
+namespace Filters {
+
+/**
+ * In-place discrete Fourier transform of @a n values spaced @a stride apart.
+ * @a n must be a power of two; the inverse transform is not normalised.
+ */
+void fft(std::complex<double> *data, int n, int stride, bool inverse);
+
+/**
+ * Allow or forbid filter primitives to use the FFT, which is allowed by default. While forbidden,
+ * fft_correlation_pays_off() always returns false.
+ */
+void set_fft_convolution_enabled(bool enabled);
+
+/**
+ * Whether correlating @a planes planes of width × height samples with a kernel of
+ * kernel_width × kernel_height is expected to be cheaper through the FFT than by summing
+ * the kernel at every sample.
+ */
+bool fft_correlation_pays_off(int width, int height, int kernel_width, int kernel_height, int planes);
+
+/// Fills samples[p] with sample (x, y) of each plane p.
+using FFTInput = std::function<void (int x, int y, double *samples)>;
+/// Receives sums[p], the correlation of each plane p at output position (x, y).
+using FFTOutput = std::function<void (int x, int y, double const *sums)>;
+
+/**
+ * Correlate each of @a planes planes of width × height samples with the kernel, keeping only
+ * the positions where the kernel lies entirely within the plane:
+ *
+ *     out[y][x] = sum over i, j of plane[y + i][x + j] * kernel[i][j]
+ *
+ * for 0 <= x <= width - kernel_width and 0 <= y <= height - kernel_height. Nothing is output
+ * when the kernel is larger than the planes.
+ *
+ * Large planes are transformed in overlapping blocks of bounded size. The samples are read, and
+ * the results handed out, one block at a time on the calling thread, so that memory use stays
+ * bounded by the block size however large the planes are.
+ */
+void fft_correlate(int planes, int width, int height, std::vector<double> const &kernel, int kernel_width,
+                   int kernel_height, FFTInput const &input, FFTOutput const &output);
+
+/**
+ * Like the above, for planes held in memory (row-major). Each returned plane has
+ * (width - kernel_width + 1) × (height - kernel_height + 1) samples; all of them are empty when
+ * the kernel is larger than the planes.
+ */
+std::vector<std::vector<double>> fft_correlate(std::vector<std::vector<double>> const &planes, int width, int height,
+                                               std::vector<double> const &kernel, int kernel_width, int kernel_height);
+
+} // namespace Filters
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_FFT_CONVOLUTION_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -14,6 +14,7 @@
 #include <vector>
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
+#include "display/fft-convolution.h"
 #include "display/nr-filter-convolve-matrix.h"
 #include "display/nr-filter-slot.h"
 #include "display/nr-filter-units.h"
@@ -51,6 +52,10 @@ struct ConvolveMatrix : public SurfaceSynth
         // the matrix is given rotated 180 degrees
         // which corresponds to reverse element order
         std::reverse(_kernel.begin(), _kernel.end());
+
+        // Large kernels are summed through the FFT by correlate_interior() for every pixel where
+        // the kernel lies entirely within the surface; only the border is summed directly below.
+        _use_fft = !_alpha && fft_correlation_pays_off(_w, _h, _orderX, _orderY, PLANES);
     }
 
     guint32 operator()(int x, int y) const
@@ -61,6 +66,13 @@ struct ConvolveMatrix : public SurfaceSynth
         int endy = std::min(_h, starty + _orderY);
         int limitx = endx - startx;
         int limity = endy - starty;
+
+        if (_use_fft && startx == x - _targetX && starty == y - _targetY &&
+            limitx == _orderX && limity == _orderY)
+        {
+            return 0; // filled in by correlate_interior()
+        }
+
         double suma = 0.0, sumr = 0.0, sumg = 0.0, sumb = 0.0;
 
         for (int i = 0; i < limity; ++i) {
@@ -77,6 +89,50 @@ struct ConvolveMatrix : public SurfaceSynth
                 }
             }
         }
+        return _assemble(x, y, suma, sumr, sumg, sumb);
+    }
+
+    /**
+     * Write the pixels of @a out where the kernel lies entirely within the input, if they are
+     * left to the FFT. The planes are correlated block by block straight into @a out, so no
+     * full-size copy of the input or of the sums is ever held.
+     */
+    void correlate_interior(cairo_surface_t *out) const
+    {
+        if (!_use_fft) {
+            return;
+        }
+
+        cairo_surface_flush(out);
+        auto const out_data = cairo_image_surface_get_data(out);
+        int const out_stride = cairo_image_surface_get_stride(out);
+
+        fft_correlate(PLANES, _w, _h, _kernel, _orderX, _orderY,
+            [this] (int x, int y, double *samples) {
+                EXTRACT_ARGB32(pixelAt(x, y), a,r,g,b)
+                samples[0] = r;
+                samples[1] = g;
+                samples[2] = b;
+                if (preserve_alpha == NO_PRESERVE_ALPHA) {
+                    samples[3] = a;
+                }
+            },
+            [&, this] (int x, int y, double const *sums) {
+                int const ox = x + _targetX;
+                int const oy = y + _targetY;
+                auto const px = reinterpret_cast<guint32 *>(out_data + oy * out_stride) + ox;
+                *px = _assemble(ox, oy, preserve_alpha == NO_PRESERVE_ALPHA ? sums[3] : 0.0,
+                                sums[0], sums[1], sums[2]);
+            });
+
+        cairo_surface_mark_dirty(out);
+    }
+
+private:
+    static constexpr int PLANES = preserve_alpha == PRESERVE_ALPHA ? 3 : 4;
+
+    guint32 _assemble(int x, int y, double suma, double sumr, double sumg, double sumb) const
+    {
         if (preserve_alpha == PRESERVE_ALPHA) {
             suma = alphaAt(x, y);
         } else {
@@ -91,8 +147,8 @@ struct ConvolveMatrix : public SurfaceSynth
         return pxout;
     }
 
-private:
     std::vector<double> _kernel;
+    bool _use_fft;
     int _targetX, _targetY, _orderX, _orderY;
     double _bias;
 };
@@ -155,13 +211,17 @@ void FilterConvolveMatrix::render_cairo(FilterSlot &slot) const
     if (preserveAlpha) {
         //convolve2D<true>(out_data, in_data, width, height, &kernel.front(), orderX, orderY,
         //    targetX, targetY, bias);
-        ink_cairo_surface_synthesize(out, ConvolveMatrix<PRESERVE_ALPHA>(input,
-            targetX, targetY, orderX, orderY, divisor, bias, kernelMatrix));
+        auto const synth = ConvolveMatrix<PRESERVE_ALPHA>(input,
+            targetX, targetY, orderX, orderY, divisor, bias, kernelMatrix);
+        ink_cairo_surface_synthesize(out, synth);
+        synth.correlate_interior(out);
     } else {
         //convolve2D<false>(out_data, in_data, width, height, &kernel.front(), orderX, orderY,
         //    targetX, targetY, bias);
-        ink_cairo_surface_synthesize(out, ConvolveMatrix<NO_PRESERVE_ALPHA>(input,
-            targetX, targetY, orderX, orderY, divisor, bias, kernelMatrix));
+        auto const synth = ConvolveMatrix<NO_PRESERVE_ALPHA>(input,
+            targetX, targetY, orderX, orderY, divisor, bias, kernelMatrix);
+        ink_cairo_surface_synthesize(out, synth);
+        synth.correlate_interior(out);
     }
 
     slot.set(_output, out);
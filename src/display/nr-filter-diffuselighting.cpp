@@ -47,17 +47,24 @@ struct DiffuseLight : public SurfaceSynth
         , _kd(kd) {}
 
 protected:
-    guint32 diffuseLighting(int x, int y, NR::Fvector const &light, NR::Fvector const &light_components)
+    void diffuseLightingRow(int y, guint32 *out, LightRow const &light) const
     {
-        NR::Fvector normal = surfaceNormalAt(x, y, _scale);
-        double k = _kd * NR::scalar_product(normal, light);
+        std::vector<float> nx(_w), ny(_w), nz(_w), k(_w);
+        surfaceNormalRow(y, _scale, nx.data(), ny.data(), nz.data());
 
-        guint32 r = CLAMP_D_TO_U8(k * light_components[LIGHT_RED]);
-        guint32 g = CLAMP_D_TO_U8(k * light_components[LIGHT_GREEN]);
-        guint32 b = CLAMP_D_TO_U8(k * light_components[LIGHT_BLUE]);
+        float const kd = _kd;
+        for (int x = 0; x < _w; ++x) {
+            k[x] = kd * (nx[x] * light.x[x] + ny[x] * light.y[x] + nz[x] * light.z[x]);
+        }
+
+        for (int x = 0; x < _w; ++x) {
+            guint32 r = CLAMP_D_TO_U8(k[x] * light.r[x]);
+            guint32 g = CLAMP_D_TO_U8(k[x] * light.g[x]);
+            guint32 b = CLAMP_D_TO_U8(k[x] * light.b[x]);
 
-        ASSEMBLE_ARGB32(pxout, 255, r, g, b)
-        return pxout;
+            ASSEMBLE_ARGB32(pxout, 255, r, g, b)
+            out[x] = pxout;
+        }
     }
 
     double _scale, _kd;
@@ -68,19 +75,19 @@ struct DiffuseDistantLight : public DiffuseLight
     DiffuseDistantLight(cairo_surface_t *bumpmap, DistantLightData const &light, guint32 color,
                         double scale, double diffuse_constant)
         : DiffuseLight(bumpmap, scale, diffuse_constant)
+        , _light_row(_w)
     {
         DistantLight dl(light, color);
-        dl.light_vector(_lightv);
-        dl.light_components(_light_components);
+        dl.light_row(_light_row);
     }
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        return diffuseLighting(x, y, _lightv, _light_components);
+        diffuseLightingRow(y, out, _light_row);
     }
 
 private:
-    NR::Fvector _lightv, _light_components;
+    LightRow _light_row;
 };
 
 struct DiffusePointLight : public DiffuseLight
@@ -91,21 +98,19 @@ struct DiffusePointLight : public DiffuseLight
         : DiffuseLight(bumpmap, scale, diffuse_constant)
         , _light(light, color, trans, device_scale)
         , _x0(x0)
-        , _y0(y0)
-    {
-        _light.light_components(_light_components);
-    }
+        , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        NR::Fvector light;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        return diffuseLighting(x, y, light, _light_components);
+        std::vector<float> z(_w);
+        alphaRow(y, z.data(), _scale / 255.0);
+        LightRow light(_w);
+        _light.light_row(light, _x0, _y0 + y, z.data());
+        diffuseLightingRow(y, out, light);
     }
 
 private:
     PointLight _light;
-    NR::Fvector _light_components;
     double _x0, _y0;
 };
 
@@ -119,12 +124,13 @@ struct DiffuseSpotLight : public DiffuseLight
         , _x0(x0)
         , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        NR::Fvector light, light_components;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y)/255.0);
-        _light.light_components(light_components, light);
-        return diffuseLighting(x, y, light, light_components);
+        std::vector<float> z(_w);
+        alphaRow(y, z.data(), _scale / 255.0);
+        LightRow light(_w);
+        _light.light_row(light, _x0, _y0 + y, z.data());
+        diffuseLightingRow(y, out, light);
     }
 
 private:
@@ -176,13 +182,13 @@ void FilterDiffuseLighting::render_cairo(FilterSlot &slot) const
 
     switch (light_type) {
     case DISTANT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffuseDistantLight(input, light.distant, color, scale, diffuseConstant));
+        ink_cairo_surface_synthesize_rows(out, DiffuseDistantLight(input, light.distant, color, scale, diffuseConstant));
         break;
     case POINT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffusePointLight(input, light.point, color, trans, scale, diffuseConstant, x0, y0, device_scale));
+        ink_cairo_surface_synthesize_rows(out, DiffusePointLight(input, light.point, color, trans, scale, diffuseConstant, x0, y0, device_scale));
         break;
     case SPOT_LIGHT:
-        ink_cairo_surface_synthesize(out, DiffuseSpotLight(input, light.spot, color, trans, scale, diffuseConstant, x0, y0, device_scale));
+        ink_cairo_surface_synthesize_rows(out, DiffuseSpotLight(input, light.spot, color, trans, scale, diffuseConstant, x0, y0, device_scale));
         break;
     default: {
         cairo_t *ct = cairo_create(out);
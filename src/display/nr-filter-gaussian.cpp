@@ -167,6 +167,14 @@ _make_kernel(FIRValue *const kernel, double const deviation)
     kernel[0] = FIRValue(1)-2*kernelsum;
 }
 
+/// The remainder of a / b, in [0, b) also for negative a.
+static int
+_positive_mod(int a, int b)
+{
+    int const r = a % b;
+    return r < 0 ? r + b : r;
+}
+
 // Return value (v) should satisfy:
 //  2^(2*v)*255<2^32
 //  255<2^(32-2*v)
@@ -566,26 +574,11 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
         return;
     }
 
-    // Handle bounding box case.
-    double dx = _deviation_x;
-    double dy = _deviation_y;
-    if( slot.get_units().get_primitive_units() == SP_FILTER_UNITS_OBJECTBOUNDINGBOX ) {
-        Geom::OptRect const bbox = slot.get_units().get_item_bbox();
-        if( bbox ) {
-            dx *= (*bbox).width();
-            dy *= (*bbox).height();
-        }
-    }
-
-    Geom::Affine trans = slot.get_units().get_matrix_user2pb();
-
-    double deviation_x_orig = dx * trans.expansionX();
-    double deviation_y_orig = dy * trans.expansionY();
-
     int device_scale = slot.get_device_scale();
 
-    deviation_x_orig *= device_scale;
-    deviation_y_orig *= device_scale;
+    auto const deviation = _device_deviation(slot.get_units(), device_scale);
+    double deviation_x_orig = deviation[Geom::X];
+    double deviation_y_orig = deviation[Geom::Y];
 
     cairo_format_t fmt = cairo_image_surface_get_format(in);
     int bytes_per_pixel = 0;
@@ -604,8 +597,14 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
     bool resampling = x_step > 1 || y_step > 1;
     int w_orig = ink_cairo_surface_get_width(in);  // Pixels
     int h_orig = ink_cairo_surface_get_height(in);
-    int w_downsampled = resampling ? static_cast<int>(ceil(static_cast<double>(w_orig)/x_step))+1 : w_orig;
-    int h_downsampled = resampling ? static_cast<int>(ceil(static_cast<double>(h_orig)/y_step))+1 : h_orig;
+    // The downsampled grid is aligned to multiples of the step in device pixels, rather than to
+    // the corner of the slot, so that it stays put when the slot moves; this lets filter regions
+    // be rendered in tiles. offset_x and offset_y are the pixels the slot starts into its cell.
+    Geom::Point const slot_origin = slot.get_slot_area().min() * device_scale;
+    int offset_x = _positive_mod(static_cast<int>(std::round(slot_origin[Geom::X])), x_step);
+    int offset_y = _positive_mod(static_cast<int>(std::round(slot_origin[Geom::Y])), y_step);
+    int w_downsampled = resampling ? (offset_x + w_orig + x_step - 1) / x_step + 1 : w_orig;
+    int h_downsampled = resampling ? (offset_y + h_orig + y_step - 1) / y_step + 1 : h_orig;
     double deviation_x = deviation_x_orig / x_step;
     double deviation_y = deviation_y_orig / y_step;
     int scr_len_x = _effect_area_scr(deviation_x);
@@ -636,8 +635,9 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
         downsampled = cairo_surface_create_similar(in, cairo_surface_get_content(in),
             w_downsampled/device_scale, h_downsampled/device_scale);
         cairo_t *ct = cairo_create(downsampled);
-        cairo_scale(ct, static_cast<double>(w_downsampled)/w_orig, static_cast<double>(h_downsampled)/h_orig);
-        cairo_set_source_surface(ct, in, 0, 0);
+        cairo_scale(ct, 1.0 / x_step, 1.0 / y_step);
+        cairo_set_source_surface(ct, in, static_cast<double>(offset_x) / device_scale,
+                                 static_cast<double>(offset_y) / device_scale);
         cairo_paint(ct);
         cairo_destroy(ct);
     } else {
@@ -673,8 +673,9 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
         cairo_surface_t *upsampled = cairo_surface_create_similar(downsampled, cairo_surface_get_content(downsampled),
                                                                   w_orig / device_scale, h_orig / device_scale);
         cairo_t *ct = cairo_create(upsampled);
-        cairo_scale(ct, static_cast<double>(w_orig) / w_downsampled, static_cast<double>(h_orig) / h_downsampled);
-        cairo_set_source_surface(ct, downsampled, 0, 0);
+        cairo_scale(ct, x_step, y_step);
+        cairo_set_source_surface(ct, downsampled, -static_cast<double>(offset_x) / x_step / device_scale,
+                                 -static_cast<double>(offset_y) / y_step / device_scale);
         cairo_paint(ct);
         cairo_destroy(ct);
 
@@ -691,6 +692,44 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
     }
 }
 
+Geom::Point FilterGaussian::_device_deviation(FilterUnits const &units, int device_scale) const
+{
+    // Handle bounding box case.
+    double dx = _deviation_x;
+    double dy = _deviation_y;
+    if( units.get_primitive_units() == SP_FILTER_UNITS_OBJECTBOUNDINGBOX ) {
+        Geom::OptRect const bbox = units.get_item_bbox();
+        if( bbox ) {
+            dx *= (*bbox).width();
+            dy *= (*bbox).height();
+        }
+    }
+
+    Geom::Affine trans = units.get_matrix_user2pb();
+
+    return Geom::Point(dx * trans.expansionX(), dy * trans.expansionY()) * device_scale;
+}
+
+void FilterGaussian::tile_area_enlarge(Geom::IntRect &area, Geom::Affine const &trans, FilterUnits const &units,
+                                       int device_scale, int blurquality) const
+{
+    auto enlarged = area;
+    area_enlarge(enlarged, trans);
+
+    // A downsampled blur reaches its kernel rounded up to whole cells of the coarser grid, plus
+    // a cell on either side for downsampling, another for interpolating back up, and one for
+    // the cell the area starts in.
+    auto const deviation = _device_deviation(units, device_scale);
+    int margin[2];
+    for (auto d : {Geom::X, Geom::Y}) {
+        int const step = 1 << _effect_subsample_step_log2(deviation[d], blurquality);
+        int const pixels = step > 1 ? (_effect_area_scr(deviation[d] / step) + 3) * step : 0;
+        margin[d] = (pixels + device_scale - 1) / device_scale;
+    }
+    area.expandBy(margin[Geom::X], margin[Geom::Y]);
+    area.unionWith(enlarged);
+}
+
 void FilterGaussian::area_enlarge(Geom::IntRect &area, Geom::Affine const &trans) const
 {
     int area_x = _effect_area_scr(_deviation_x * trans.expansionX());
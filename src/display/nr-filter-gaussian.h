@@ -40,6 +40,8 @@ public:
     void area_enlarge(Geom::IntRect &area, Geom::Affine const &m) const override;
     bool can_handle_affine(Geom::Affine const &m) const override;
     double complexity(Geom::Affine const &ctm) const override;
+    void tile_area_enlarge(Geom::IntRect &area, Geom::Affine const &m, FilterUnits const &units,
+                           int device_scale, int blurquality) const override;
 
     /**
      * Set the standard deviation value for gaussian blur. Deviation along
@@ -62,6 +64,9 @@ public:
     Glib::ustring name() const override { return Glib::ustring("Gaussian Blur"); }
 
 private:
+    /// Returns the standard deviations in device pixels.
+    Geom::Point _device_deviation(FilterUnits const &units, int device_scale) const;
+
     double _deviation_x;
     double _deviation_y;
 };
@@ -114,6 +114,25 @@ public:
      */
     virtual bool can_handle_affine(Geom::Affine const &) const { return false; }
 
+    /**
+     * Indicate whether the filter primitive can be rendered on parts of the filter region
+     * separately, given its input enlarged by tile_area_enlarge(). Primitives that read their
+     * input outside of that neighbourhood of each output pixel, or whose output depends on
+     * where the part starts, must return false.
+     */
+    virtual bool can_tile(FilterUnits const &units, int device_scale, int blurquality) const { return true; }
+
+    /**
+     * Enlarge a part of the filter region by the input the primitive reads to render it on its
+     * own. By default the same as area_enlarge(); primitives that render at a resolution other
+     * than the device's may read further.
+     */
+    virtual void tile_area_enlarge(Geom::IntRect &area, Geom::Affine const &m, FilterUnits const &units,
+                                   int device_scale, int blurquality) const
+    {
+        area_enlarge(area, m);
+    }
+
     /**
      * Sets style for access to properties used by filter primitives.
      */
@@ -50,23 +50,33 @@ struct SpecularLight : public SurfaceSynth
         , _exp(specular_exponent) {}
 
 protected:
-    guint32 specularLighting(int x, int y, NR::Fvector const &halfway, NR::Fvector const &light_components)
+    void specularLightingRow(int y, guint32 *out, LightRow const &light) const
     {
-        NR::Fvector normal = surfaceNormalAt(x, y, _scale);
-        double sp = NR::scalar_product(normal, halfway);
-        double k = sp <= 0.0 ? 0.0 : _ks * std::pow(sp, _exp);
+        std::vector<float> nx(_w), ny(_w), nz(_w), sp(_w);
+        surfaceNormalRow(y, _scale, nx.data(), ny.data(), nz.data());
+
+        // scalar product of the normal with the halfway vector between light and eye
+        for (int x = 0; x < _w; ++x) {
+            float hx = light.x[x], hy = light.y[x], hz = light.z[x] + 1.0f;
+            float inv = 1.0f / std::sqrt(hx * hx + hy * hy + hz * hz);
+            sp[x] = (nx[x] * hx + ny[x] * hy + nz[x] * hz) * inv;
+        }
+
+        for (int x = 0; x < _w; ++x) {
+            double k = sp[x] <= 0.0f ? 0.0 : _ks * std::pow(sp[x], _exp);
 
-        guint32 r = CLAMP_D_TO_U8(k * light_components[LIGHT_RED]);
-        guint32 g = CLAMP_D_TO_U8(k * light_components[LIGHT_GREEN]);
-        guint32 b = CLAMP_D_TO_U8(k * light_components[LIGHT_BLUE]);
-        guint32 a = std::max(std::max(r, g), b);
+            guint32 r = CLAMP_D_TO_U8(k * light.r[x]);
+            guint32 g = CLAMP_D_TO_U8(k * light.g[x]);
+            guint32 b = CLAMP_D_TO_U8(k * light.b[x]);
+            guint32 a = std::max(std::max(r, g), b);
 
-        r = premul_alpha(r, a);
-        g = premul_alpha(g, a);
-        b = premul_alpha(b, a);
+            r = premul_alpha(r, a);
+            g = premul_alpha(g, a);
+            b = premul_alpha(b, a);
 
-        ASSEMBLE_ARGB32(pxout, a,r,g,b)
-        return pxout;
+            ASSEMBLE_ARGB32(pxout, a,r,g,b)
+            out[x] = pxout;
+        }
     }
 
     double _scale, _ks, _exp;
@@ -77,21 +87,19 @@ struct SpecularDistantLight : public SpecularLight
     SpecularDistantLight(cairo_surface_t *bumpmap, DistantLightData const &light, guint32 color,
                          double scale, double specular_constant, double specular_exponent)
         : SpecularLight(bumpmap, scale, specular_constant, specular_exponent)
+        , _light_row(_w)
     {
         DistantLight dl(light, color);
-        NR::Fvector lv;
-        dl.light_vector(lv);
-        dl.light_components(_light_components);
-        NR::normalized_sum(_halfway, lv, NR::EYE_VECTOR);
+        dl.light_row(_light_row);
     }
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        return specularLighting(x, y, _halfway, _light_components);
+        specularLightingRow(y, out, _light_row);
     }
 
 private:
-    NR::Fvector _halfway, _light_components;
+    LightRow _light_row;
 };
 
 struct SpecularPointLight : public SpecularLight
@@ -102,22 +110,19 @@ struct SpecularPointLight : public SpecularLight
         : SpecularLight(bumpmap, scale, specular_constant, specular_exponent)
         , _light(light, color, trans, device_scale)
         , _x0(x0)
-        , _y0(y0)
-    {
-        _light.light_components(_light_components);
-    }
+        , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        NR::Fvector light, halfway;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        NR::normalized_sum(halfway, light, NR::EYE_VECTOR);
-        return specularLighting(x, y, halfway, _light_components);
+        std::vector<float> z(_w);
+        alphaRow(y, z.data(), _scale / 255.0);
+        LightRow light(_w);
+        _light.light_row(light, _x0, _y0 + y, z.data());
+        specularLightingRow(y, out, light);
     }
 
 private:
     PointLight _light;
-    NR::Fvector _light_components;
     double _x0, _y0;
 };
 
@@ -131,13 +136,13 @@ struct SpecularSpotLight : public SpecularLight
         , _x0(x0)
         , _y0(y0) {}
 
-    guint32 operator()(int x, int y)
+    void row(int y, guint32 *out) const
     {
-        NR::Fvector light, halfway, light_components;
-        _light.light_vector(light, _x0 + x, _y0 + y, _scale * alphaAt(x, y) / 255.0);
-        _light.light_components(light_components, light);
-        NR::normalized_sum(halfway, light, NR::EYE_VECTOR);
-        return specularLighting(x, y, halfway, light_components);
+        std::vector<float> z(_w);
+        alphaRow(y, z.data(), _scale / 255.0);
+        LightRow light(_w);
+        _light.light_row(light, _x0, _y0 + y, z.data());
+        specularLightingRow(y, out, light);
     }
 
 private:
@@ -190,15 +195,15 @@ void FilterSpecularLighting::render_cairo(FilterSlot &slot) const
 
     switch (light_type) {
     case DISTANT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularDistantLight(input, light.distant, color, scale, ks, se));
         break;
     case POINT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularPointLight(input, light.point, color, trans, scale, ks, se, x0, y0, device_scale));
         break;
     case SPOT_LIGHT:
-        ink_cairo_surface_synthesize(out,
+        ink_cairo_surface_synthesize_rows(out,
             SpecularSpotLight(input, light.spot, color, trans, scale, ks, se, x0, y0, device_scale));
         break;
     default: {
@@ -29,6 +29,8 @@ public:
     void render_cairo(FilterSlot &slot) const override;
     void area_enlarge(Geom::IntRect &area, Geom::Affine const &trans) const override;
     double complexity(Geom::Affine const &ctm) const override;
+    // The pattern is taken from the primitive area of the input, wherever it lies.
+    bool can_tile(FilterUnits const &, int, int) const override { return false; }
 
     Glib::ustring name() const override { return Glib::ustring("Tile"); }
 };
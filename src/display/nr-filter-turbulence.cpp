@@ -18,13 +18,23 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include <2geom/transforms.h>
+
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
 #include "display/nr-filter.h"
 #include "display/nr-filter-turbulence.h"
 #include "display/nr-filter-units.h"
 #include "display/nr-filter-utils.h"
-#include <cmath>
+#include "util/cached_map.h"
+#include "util/parallel.h"
 
 namespace Inkscape {
 namespace Filters{
@@ -64,15 +74,16 @@ public:
             for (i = 0; i < BSize; ++i) {
                 _latticeSelector[i] = i;
 
+                double gx, gy;
                 do {
-                    _gradient[i][k][0] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
-                    _gradient[i][k][1] = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
-                } while (_gradient[i][k][0] == 0 && _gradient[i][k][1] == 0);
+                    gx = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
+                    gy = static_cast<double>(_random() % (BSize * 2) - BSize) / BSize;
+                } while (gx == 0 && gy == 0);
 
                 // normalize gradient
-                double s = hypot(_gradient[i][k][0], _gradient[i][k][1]);
-                _gradient[i][k][0] /= s;
-                _gradient[i][k][1] /= s;
+                double s = hypot(gx, gy);
+                _gradient[i][0][k] = gx / s;
+                _gradient[i][1][k] = gy / s;
             }
         }
         while (--i) {
@@ -87,8 +98,8 @@ public:
             _latticeSelector[BSize + i] = _latticeSelector[i];
 
             for (int k = 0; k < 4; ++k) {
-                _gradient[BSize + i][k][0] = _gradient[i][k][0];
-                _gradient[BSize + i][k][1] = _gradient[i][k][1];
+                _gradient[BSize + i][0][k] = _gradient[i][0][k];
+                _gradient[BSize + i][1][k] = _gradient[i][1][k];
             }
         }
 
@@ -121,24 +132,24 @@ public:
     {
         int wrapx = _wrapx, wrapy = _wrapy, wrapw = _wrapw, wraph = _wraph;
 
-        double pixel[4];
+        // The lattice position is found in double precision, as it grows with every octave,
+        // but the noise itself is evaluated in single precision for all four channels at once.
+        // The channels are laid out so that the loops over them below become vector operations.
+        float pixel[4] = {0.0f, 0.0f, 0.0f, 0.0f};
         double x = p[Geom::X] * _baseFreq[Geom::X];
         double y = p[Geom::Y] * _baseFreq[Geom::Y];
-        double ratio = 1.0;
-
-        for (double & k : pixel)
-            k = 0.0;
+        float weight = 1.0f;
 
         for (int octave = 0; octave < _octaves; ++octave)
         {
             double tx = x + PerlinOffset;
             double bx = floor(tx);
-            double rx0 = tx - bx, rx1 = rx0 - 1.0;
+            float rx0 = tx - bx, rx1 = rx0 - 1.0f;
             int bx0 = bx, bx1 = bx0 + 1;
 
             double ty = y + PerlinOffset;
             double by = floor(ty);
-            double ry0 = ty - by, ry1 = ry0 - 1.0;
+            float ry0 = ty - by, ry1 = ry0 - 1.0f;
             int by0 = by, by1 = by0 + 1;
 
             if (_stitchTiles) {
@@ -154,39 +165,35 @@ public:
 
             int i = _latticeSelector[bx0];
             int j = _latticeSelector[bx1];
-            int b00 = _latticeSelector[i + by0];
-            int b01 = _latticeSelector[i + by1];
-            int b10 = _latticeSelector[j + by0];
-            int b11 = _latticeSelector[j + by1];
+            auto const &q00 = _gradient[_latticeSelector[i + by0]];
+            auto const &q01 = _gradient[_latticeSelector[i + by1]];
+            auto const &q10 = _gradient[_latticeSelector[j + by0]];
+            auto const &q11 = _gradient[_latticeSelector[j + by1]];
 
-            double sx = _scurve(rx0);
-            double sy = _scurve(ry0);
+            float sx = _scurve(rx0);
+            float sy = _scurve(ry0);
 
-            double result[4];
             // channel numbering: R=0, G=1, B=2, A=3
+            float result[4];
             for (int k = 0; k < 4; ++k) {
-                double const *qxa = _gradient[b00][k];
-                double const *qxb = _gradient[b10][k];
-                double a = _lerp(sx, rx0 * qxa[0] + ry0 * qxa[1],
-                                     rx1 * qxb[0] + ry0 * qxb[1]);
-                double const *qya = _gradient[b01][k];
-                double const *qyb = _gradient[b11][k];
-                double b = _lerp(sx, rx0 * qya[0] + ry1 * qya[1],
-                                     rx1 * qyb[0] + ry1 * qyb[1]);
-                result[k] = _lerp(sy, a, b);
+                float a = _lerp(sx, rx0 * q00[0][k] + ry0 * q00[1][k],
+                                    rx1 * q10[0][k] + ry0 * q10[1][k]);
+                float b = _lerp(sx, rx0 * q01[0][k] + ry1 * q01[1][k],
+                                    rx1 * q11[0][k] + ry1 * q11[1][k]);
+                result[k] = _lerp(sy, a, b) * weight;
             }
 
             if (_fractalnoise) {
                 for (int k = 0; k < 4; ++k)
-                    pixel[k] += result[k] / ratio;
+                    pixel[k] += result[k];
             } else {
                 for (int k = 0; k < 4; ++k)
-                    pixel[k] += fabs(result[k]) / ratio;
+                    pixel[k] += std::abs(result[k]);
             }
 
             x *= 2;
             y *= 2;
-            ratio *= 2;
+            weight *= 0.5f;
 
             if(_stitchTiles)
             {
@@ -200,20 +207,20 @@ public:
         }
 
         if (_fractalnoise) {
-            guint32 r = CLAMP_D_TO_U8((pixel[0]*255.0 + 255.0) / 2);
-            guint32 g = CLAMP_D_TO_U8((pixel[1]*255.0 + 255.0) / 2);
-            guint32 b = CLAMP_D_TO_U8((pixel[2]*255.0 + 255.0) / 2);
-            guint32 a = CLAMP_D_TO_U8((pixel[3]*255.0 + 255.0) / 2);
+            guint32 r = CLAMP_D_TO_U8((pixel[0]*255.0f + 255.0f) / 2);
+            guint32 g = CLAMP_D_TO_U8((pixel[1]*255.0f + 255.0f) / 2);
+            guint32 b = CLAMP_D_TO_U8((pixel[2]*255.0f + 255.0f) / 2);
+            guint32 a = CLAMP_D_TO_U8((pixel[3]*255.0f + 255.0f) / 2);
             r = premul_alpha(r, a);
             g = premul_alpha(g, a);
             b = premul_alpha(b, a);
             ASSEMBLE_ARGB32(pxout, a,r,g,b);
             return pxout;
         } else {
-            guint32 r = CLAMP_D_TO_U8(pixel[0]*255.0);
-            guint32 g = CLAMP_D_TO_U8(pixel[1]*255.0);
-            guint32 b = CLAMP_D_TO_U8(pixel[2]*255.0);
-            guint32 a = CLAMP_D_TO_U8(pixel[3]*255.0);
+            guint32 r = CLAMP_D_TO_U8(pixel[0]*255.0f);
+            guint32 g = CLAMP_D_TO_U8(pixel[1]*255.0f);
+            guint32 b = CLAMP_D_TO_U8(pixel[2]*255.0f);
+            guint32 a = CLAMP_D_TO_U8(pixel[3]*255.0f);
             r = premul_alpha(r, a);
             g = premul_alpha(g, a);
             b = premul_alpha(b, a);
@@ -271,12 +278,12 @@ private:
         return _seed;
     }
 
-    static inline double _scurve(double t)
+    static inline float _scurve(float t)
     {
-        return t * t * (3.0 - 2.0 * t);
+        return t * t * (3.0f - 2.0f * t);
     }
 
-    static inline double _lerp(double t, double a, double b)
+    static inline float _lerp(float t, float a, float b)
     {
         return a + t * (b - a);
     }
@@ -297,7 +304,7 @@ private:
     Geom::Rect _tile;
     Geom::Point _baseFreq;
     int _latticeSelector[2 * BSize + 2];
-    double _gradient[2 * BSize + 2][4][2];
+    float _gradient[2 * BSize + 2][2][4]; ///< x and y components for each of the four channels
     long _seed;
     int _octaves;
     bool _stitchTiles;
@@ -360,26 +367,94 @@ void FilterTurbulence::set_updated(bool /*u*/)
 {
 }
 
-struct Turbulence
-{
-    Turbulence(TurbulenceGenerator const &gen, Geom::Affine const &trans, int x0, int y0)
-        : _gen(gen)
-        , _trans(trans)
-        , _x0(x0), _y0(y0) {}
+namespace {
 
-    guint32 operator()(int x, int y)
+// Noise is generated and cached in square tiles aligned to the pixel grid of the filter, so
+// that panning over a large textured area only has to generate the newly exposed tiles.
+constexpr int NOISE_TILE_SIZE = 128;
+constexpr std::size_t NOISE_TILE_CACHE_SIZE = 256; // unused tiles, 16 MiB
+
+struct NoiseTileKey
+{
+    // Parameters of the generator
+    double seed;
+    double freq_x, freq_y;
+    int octaves;
+    bool stitch;
+    bool fractal;
+    // Tile the noise is stitched to, if stitching
+    double tile_x, tile_y, tile_width, tile_height;
+    // Transformation from the pixel grid to primitive units
+    std::array<double, 6> trans;
+    // Position in tiles
+    int x, y;
+
+    bool operator==(NoiseTileKey const &other) const
     {
-        Geom::Point point(x + _x0, y + _y0);
-        point *= _trans;
-        return _gen.turbulencePixel(point);
+        return std::tie(seed, freq_x, freq_y, octaves, stitch, fractal,
+                        tile_x, tile_y, tile_width, tile_height, trans, x, y) ==
+               std::tie(other.seed, other.freq_x, other.freq_y, other.octaves, other.stitch, other.fractal,
+                        other.tile_x, other.tile_y, other.tile_width, other.tile_height, other.trans, other.x, other.y);
     }
+};
 
-private:
-    TurbulenceGenerator const &_gen;
-    Geom::Affine _trans;
-    int _x0, _y0;
+struct NoiseTileKeyHash
+{
+    std::size_t operator()(NoiseTileKey const &key) const
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.seed);
+        boost::hash_combine(seed, key.freq_x);
+        boost::hash_combine(seed, key.freq_y);
+        boost::hash_combine(seed, key.octaves);
+        boost::hash_combine(seed, key.stitch);
+        boost::hash_combine(seed, key.fractal);
+        boost::hash_combine(seed, key.tile_x);
+        boost::hash_combine(seed, key.tile_y);
+        boost::hash_combine(seed, key.tile_width);
+        boost::hash_combine(seed, key.tile_height);
+        boost::hash_range(seed, key.trans.begin(), key.trans.end());
+        boost::hash_combine(seed, key.x);
+        boost::hash_combine(seed, key.y);
+        return seed;
+    }
 };
 
+using NoiseTile = std::vector<guint32>;
+
+std::atomic<bool> noise_tile_cache_enabled = true;
+
+auto &noise_tile_cache()
+{
+    static Util::cached_map<NoiseTileKey, NoiseTile, NoiseTileKeyHash> cache(NOISE_TILE_CACHE_SIZE);
+    return cache;
+}
+
+std::unique_ptr<NoiseTile> generate_noise_tile(TurbulenceGenerator const &gen, Geom::Affine const &trans, int tile_x, int tile_y)
+{
+    auto tile = std::make_unique<NoiseTile>(NOISE_TILE_SIZE * NOISE_TILE_SIZE);
+    int const x0 = tile_x * NOISE_TILE_SIZE;
+    int const y0 = tile_y * NOISE_TILE_SIZE;
+    for (int y = 0; y < NOISE_TILE_SIZE; ++y) {
+        for (int x = 0; x < NOISE_TILE_SIZE; ++x) {
+            (*tile)[y * NOISE_TILE_SIZE + x] = gen.turbulencePixel(Geom::Point(x0 + x, y0 + y) * trans);
+        }
+    }
+    return tile;
+}
+
+int floor_div(int a, int b)
+{
+    return a / b - (a % b < 0);
+}
+
+} // namespace
+
+void set_turbulence_cache_enabled(bool enabled)
+{
+    noise_tile_cache_enabled = enabled;
+}
+
 void FilterTurbulence::render_cairo(FilterSlot &slot) const
 {
     cairo_surface_t *input = slot.getcairo(_input);
@@ -401,19 +476,76 @@ void FilterTurbulence::render_cairo(FilterSlot &slot) const
     // color_interpolation_filter is determined by CSS value (see spec. Turbulence).
     set_cairo_surface_ci(out, color_interpolation);
 
-    if (!gen->ready()) {
-        Geom::Point ta(fTileX, fTileY);
-        Geom::Point tb(fTileX + fTileWidth, fTileY + fTileHeight);
-        gen->init(seed, Geom::Rect(ta, tb),
-                  Geom::Point(XbaseFrequency, YbaseFrequency), stitchTiles,
-                  type == TURBULENCE_FRACTALNOISE, numOctaves);
+    {
+        // Several tiles of the filter region may be rendered at once.
+        auto lock = std::lock_guard(_gen_mutex);
+        if (!gen->ready()) {
+            Geom::Point ta(fTileX, fTileY);
+            Geom::Point tb(fTileX + fTileWidth, fTileY + fTileHeight);
+            gen->init(seed, Geom::Rect(ta, tb),
+                      Geom::Point(XbaseFrequency, YbaseFrequency), stitchTiles,
+                      type == TURBULENCE_FRACTALNOISE, numOctaves);
+        }
     }
 
+    // Split the origin of the slot into whole pixels, which select the noise tiles, and the
+    // remaining fraction, which becomes part of the transformation they are generated with.
     Geom::Affine unit_trans = slot.get_units().get_matrix_primitiveunits2pb().inverse();
     Geom::Rect slot_area = slot.get_slot_area();
-    double x0 = slot_area.min()[Geom::X];
-    double y0 = slot_area.min()[Geom::Y];
-    ink_cairo_surface_synthesize(temp, Turbulence(*gen, unit_trans, x0, y0));
+    int x0 = std::floor(slot_area.min()[Geom::X]);
+    int y0 = std::floor(slot_area.min()[Geom::Y]);
+    Geom::Affine tile_trans = Geom::Translate(slot_area.min() - Geom::Point(x0, y0)) * unit_trans;
+
+    NoiseTileKey key{seed, XbaseFrequency, YbaseFrequency, numOctaves, stitchTiles, type == TURBULENCE_FRACTALNOISE,
+                     fTileX, fTileY, fTileWidth, fTileHeight};
+    for (int i = 0; i < 6; ++i) {
+        key.trans[i] = tile_trans[i];
+    }
+
+    cairo_surface_flush(temp);
+    auto const data = cairo_image_surface_get_data(temp);
+    int const stride = cairo_image_surface_get_stride(temp);
+
+    if (!noise_tile_cache_enabled) {
+        // Generate every pixel of the surface directly.
+        Util::parallel_for(height, [&] (std::size_t y) {
+            auto const row = reinterpret_cast<guint32 *>(data + y * stride);
+            for (int x = 0; x < width; ++x) {
+                row[x] = gen->turbulencePixel(Geom::Point(x0 + x, y0 + static_cast<int>(y)) * tile_trans);
+            }
+        }, get_num_filter_threads());
+    } else {
+        // Generate only the tiles that are not cached yet.
+        int const tx0 = floor_div(x0, NOISE_TILE_SIZE);
+        int const ty0 = floor_div(y0, NOISE_TILE_SIZE);
+        int const tx1 = floor_div(x0 + width - 1, NOISE_TILE_SIZE);
+        int const ty1 = floor_div(y0 + height - 1, NOISE_TILE_SIZE);
+        int const columns = tx1 - tx0 + 1;
+
+        Util::parallel_for(columns * (ty1 - ty0 + 1), [&] (std::size_t i) {
+            auto tile_key = key;
+            tile_key.x = tx0 + static_cast<int>(i) % columns;
+            tile_key.y = ty0 + static_cast<int>(i) / columns;
+
+            auto tile = noise_tile_cache().lookup(tile_key);
+            if (!tile) {
+                tile = noise_tile_cache().add(tile_key, generate_noise_tile(*gen, tile_trans, tile_key.x, tile_key.y));
+            }
+
+            // Copy the part of the tile that overlaps the surface.
+            int const left = tile_key.x * NOISE_TILE_SIZE;
+            int const top = tile_key.y * NOISE_TILE_SIZE;
+            int const x_begin = std::max(left, x0), x_end = std::min(left + NOISE_TILE_SIZE, x0 + width);
+            int const y_begin = std::max(top, y0), y_end = std::min(top + NOISE_TILE_SIZE, y0 + height);
+            for (int y = y_begin; y < y_end; ++y) {
+                std::memcpy(data + (y - y0) * stride + (x_begin - x0) * 4,
+                            tile->data() + (y - top) * NOISE_TILE_SIZE + (x_begin - left),
+                            (x_end - x_begin) * 4);
+            }
+        }, get_num_filter_threads());
+    }
+
+    cairo_surface_mark_dirty(temp);
 
     // cairo_surface_write_to_png( temp, "turbulence0.png" );
 
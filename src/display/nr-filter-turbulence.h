@@ -23,6 +23,7 @@
  */
 
 #include <memory>
+#include <mutex>
 #include <2geom/point.h>
 
 #include "display/nr-filter-primitive.h"
@@ -41,6 +42,12 @@ enum FilterTurbulenceType
 
 class TurbulenceGenerator;
 
+/**
+ * Allow or forbid turbulence to cache the noise it generates, which is allowed by default.
+ * While forbidden, the noise is generated afresh for every pixel rendered.
+ */
+void set_turbulence_cache_enabled(bool enabled);
+
 class FilterTurbulence : public FilterPrimitive
 {
 public:
@@ -62,6 +69,7 @@ public:
 
 private:
     std::unique_ptr<TurbulenceGenerator> gen;
+    mutable std::mutex _gen_mutex; ///< guards the lazy initialisation of gen
 
     void turbulenceInit(long seed);
 
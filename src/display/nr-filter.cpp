@@ -14,6 +14,7 @@
 #include <cmath>
 #include <cstring>
 #include <string>
+#include <vector>
 #include <cairo.h>
 
 #include "display/nr-filter.h"
@@ -44,6 +45,7 @@
 #include "display/drawing-item.h"
 #include "display/drawing-context.h"
 #include "display/drawing-surface.h"
+#include "debug/trace.h"
 #include <2geom/affine.h>
 #include <2geom/rect.h>
 #include "svg/svg-length.h"
@@ -55,6 +57,10 @@ namespace Filters {
 using Geom::X;
 using Geom::Y;
 
+// Filter regions smaller than this many pixels are rendered in one piece.
+constexpr int TILED_FILTER_MIN_AREA = 1024 * 1024;
+constexpr int FILTER_TILE_SIZE = 512;
+
 Filter::Filter()
 {
     _common_init();
@@ -149,9 +155,15 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
         }
     }
 
+    if (_render_tiled(item, graphic, units, rc, blurquality)) {
+        return 0;
+    }
+
+    auto const span = Debug::TraceSpan("filter", "filter");
     auto slot = FilterSlot(bgdc, graphic, units, rc, blurquality);
 
     for (auto &i : primitives) {
+        auto const primitive_span = Debug::TraceSpan(Debug::Trace::enabled() ? Debug::Trace::intern(i->name()) : "", "filter");
         i->render_cairo(slot);
     }
 
@@ -170,6 +182,88 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
     return 0;
 }
 
+bool Filter::_render_tiled(Inkscape::DrawingItem const *item, DrawingContext &graphic, FilterUnits const &units, RenderContext &rc, int blurquality) const
+{
+    auto const area = graphic.targetLogicalBounds().roundOutwards();
+    if (area.area() < TILED_FILTER_MIN_AREA || !units.get_matrix_display2pb().isTranslation() || uses_background()) {
+        return false;
+    }
+    int const device_scale = graphic.surface()->device_scale();
+    for (auto &i : primitives) {
+        if (!i->can_tile(units, device_scale, blurquality)) {
+            return false;
+        }
+    }
+
+    // Each tile is rendered together with the margin its primitives read from.
+    auto const with_halo = [&] (Geom::IntRect rect) {
+        for (auto &i : primitives) {
+            i->tile_area_enlarge(rect, item->ctm(), units, device_scale, blurquality);
+        }
+        return rect;
+    };
+
+    // Once the margin dominates, tiles would only repeat work without saving memory.
+    auto const probe = Geom::IntRect::from_xywh(0, 0, FILTER_TILE_SIZE, FILTER_TILE_SIZE);
+    if (with_halo(probe).area() > 4 * probe.area()) {
+        return false;
+    }
+
+    std::vector<Geom::IntRect> tiles;
+    for (int y = area.top(); y < area.bottom(); y += FILTER_TILE_SIZE) {
+        for (int x = area.left(); x < area.right(); x += FILTER_TILE_SIZE) {
+            tiles.emplace_back(x, y, std::min(x + FILTER_TILE_SIZE, area.right()), std::min(y + FILTER_TILE_SIZE, area.bottom()));
+        }
+    }
+
+    Geom::Point const origin = graphic.targetLogicalBounds().min();
+    cairo_surface_t *source = graphic.rawTarget();
+    cairo_surface_t *output = ink_cairo_surface_create_identical(source);
+
+    // Tiles are rendered one after the other, which bounds the memory held by intermediate slots
+    // regardless of the size of the filter region. The primitives use the filter threads within
+    // each tile.
+    for (auto const &tile : tiles) {
+        auto const halo = *(with_halo(tile) & area);
+
+        DrawingSurface surface(halo, device_scale);
+        DrawingContext dc(surface);
+        dc.setSource(source, origin[Geom::X], origin[Geom::Y]);
+        dc.setOperator(CAIRO_OPERATOR_SOURCE);
+        dc.paint();
+        dc.setOperator(CAIRO_OPERATOR_OVER);
+
+        auto const span = Debug::TraceSpan("filter tile", "filter");
+        auto slot = FilterSlot(nullptr, dc, units, rc, blurquality);
+        for (auto &p : primitives) {
+            auto const primitive_span = Debug::TraceSpan(Debug::Trace::enabled() ? Debug::Trace::intern(p->name()) : "", "filter");
+            p->render_cairo(slot);
+        }
+        cairo_surface_t *result = slot.get_result(_output_slot);
+
+        cairo_t *ct = cairo_create(output);
+        cairo_translate(ct, -origin[Geom::X], -origin[Geom::Y]);
+        cairo_rectangle(ct, tile.left(), tile.top(), tile.width(), tile.height());
+        cairo_clip(ct);
+        cairo_set_source_surface(ct, result, halo.left(), halo.top());
+        cairo_set_operator(ct, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(ct);
+        cairo_destroy(ct);
+        cairo_surface_destroy(result);
+    }
+
+    // Assume for the moment that we paint the filter in sRGB
+    set_cairo_surface_ci(output, SP_CSS_COLOR_INTERPOLATION_SRGB);
+
+    graphic.setSource(output, origin[Geom::X], origin[Geom::Y]);
+    graphic.setOperator(CAIRO_OPERATOR_SOURCE);
+    graphic.paint();
+    graphic.setOperator(CAIRO_OPERATOR_OVER);
+    cairo_surface_destroy(output);
+
+    return true;
+}
+
 void Filter::add_primitive(std::unique_ptr<FilterPrimitive> primitive)
 {
     primitives.emplace_back(std::move(primitive));
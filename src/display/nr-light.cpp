@@ -10,6 +10,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cmath>
 
 #include "display/nr-light.h"
@@ -43,6 +44,37 @@ void DistantLight::light_components(NR::Fvector &lc) {
     lc[LIGHT_BLUE] = SP_RGBA32_B_U(color);
 }
 
+void DistantLight::light_row(LightRow &row) {
+    NR::Fvector v, lc;
+    light_vector(v);
+    light_components(lc);
+    std::fill(row.x.begin(), row.x.end(), v[X_3D]);
+    std::fill(row.y.begin(), row.y.end(), v[Y_3D]);
+    std::fill(row.z.begin(), row.z.end(), v[Z_3D]);
+    std::fill(row.r.begin(), row.r.end(), lc[LIGHT_RED]);
+    std::fill(row.g.begin(), row.g.end(), lc[LIGHT_GREEN]);
+    std::fill(row.b.begin(), row.b.end(), lc[LIGHT_BLUE]);
+}
+
+/*
+ * Light vectors towards a light at (l_x, l_y, l_z) from the points (x0 + i, y, z[i]).
+ * The offsets are taken in double precision, so the floats only hold small values.
+ */
+static void point_light_vectors(LightRow &row, double l_x, double l_y, double l_z, double x0, double y, float const *z)
+{
+    int const n = row.x.size();
+    float const dx0 = l_x - x0;
+    float const dy = l_y - y;
+    for (int i = 0; i < n; ++i) {
+        float dx = dx0 - i;
+        float dz = l_z - z[i];
+        float inv = 1.0f / std::sqrt(dx * dx + dy * dy + dz * dz);
+        row.x[i] = dx * inv;
+        row.y[i] = dy * inv;
+        row.z[i] = dz * inv;
+    }
+}
+
 PointLight::PointLight(PointLightData const &light, guint32 lighting_color, const Geom::Affine &trans, int device_scale) {
     color = lighting_color;
     l_x = light.x * device_scale;
@@ -66,6 +98,13 @@ void PointLight::light_components(NR::Fvector &lc) {
     lc[LIGHT_BLUE] = SP_RGBA32_B_U(color);
 }
 
+void PointLight::light_row(LightRow &row, double x0, double y, float const *z) const {
+    point_light_vectors(row, l_x, l_y, l_z, x0, y, z);
+    std::fill(row.r.begin(), row.r.end(), SP_RGBA32_R_U(color));
+    std::fill(row.g.begin(), row.g.end(), SP_RGBA32_G_U(color));
+    std::fill(row.b.begin(), row.b.end(), SP_RGBA32_B_U(color));
+}
+
 SpotLight::SpotLight(SpotLightData const &light, guint32 lighting_color, const Geom::Affine &trans, int device_scale)
 {
     double p_x, p_y, p_z;
@@ -106,6 +145,24 @@ void SpotLight::light_components(NR::Fvector &lc, const NR::Fvector &L) {
     lc[LIGHT_BLUE] = spmod * SP_RGBA32_B_U(color);
 }
 
+void SpotLight::light_row(LightRow &row, double x0, double y, float const *z) const {
+    point_light_vectors(row, l_x, l_y, l_z, x0, y, z);
+
+    int const n = row.x.size();
+    float const sx = S[X_3D], sy = S[Y_3D], sz = S[Z_3D];
+    float const red = SP_RGBA32_R_U(color), green = SP_RGBA32_G_U(color), blue = SP_RGBA32_B_U(color);
+    for (int i = 0; i < n; ++i) {
+        double spmod = -(row.x[i] * sx + row.y[i] * sy + row.z[i] * sz);
+        if (spmod <= cos_lca)
+            spmod = 0;
+        else
+            spmod = std::pow(spmod, speExp);
+        row.r[i] = spmod * red;
+        row.g[i] = spmod * green;
+        row.b[i] = spmod * blue;
+    }
+}
+
 } /* namespace Filters */
 } /* namespace Inkscape */
 
@@ -18,6 +18,7 @@
  * light color components (at a given point).
  */
 
+#include <vector>
 #include <2geom/forward.h>
 
 #include "display/nr-3dutils.h"
@@ -37,6 +38,17 @@ enum LightComponent {
     LIGHT_BLUE
 };
 
+/**
+ * Light vectors and colour components for a row of pixels, kept in separate arrays so that
+ * the shading of a whole row can be done with vector instructions.
+ */
+struct LightRow
+{
+    explicit LightRow(int n) : x(n), y(n), z(n), r(n), g(n), b(n) {}
+    std::vector<float> x, y, z; ///< unit vector towards the light
+    std::vector<float> r, g, b; ///< colour components of the light
+};
+
 class DistantLight {
     public:
         /**
@@ -62,6 +74,13 @@ class DistantLight {
          */
         void light_components(NR::Fvector &lc);
 
+        /**
+         * Fills in the light vectors and components of a row, which are all the same
+         *
+         * \param row the row to fill in
+         */
+        void light_row(LightRow &row);
+
     private:
         guint32 color;
         double azimuth; //azimuth in rad
@@ -101,6 +120,17 @@ class PointLight {
          */
         void light_components(NR::Fvector &lc);
 
+        /**
+         * Computes the light vectors and components of the row of points
+         * (x0 + i, y, z[i]), in the same coordinates as light_vector()
+         *
+         * \param row the row to fill in
+         * \param x0 x coordinate of the first point
+         * \param y y coordinate of the row
+         * \param z z coordinates of the points
+         */
+        void light_row(LightRow &row, double x0, double y, float const *z) const;
+
     private:
         guint32 color;
         //light position coordinates in render setting
@@ -145,6 +175,17 @@ class SpotLight {
          */
         void light_components(NR::Fvector &lc, const NR::Fvector &L);
 
+        /**
+         * Computes the light vectors and components of the row of points
+         * (x0 + i, y, z[i]), in the same coordinates as light_vector()
+         *
+         * \param row the row to fill in
+         * \param x0 x coordinate of the first point
+         * \param y y coordinate of the row
+         * \param z z coordinates of the points
+         */
+        void light_row(LightRow &row, double x0, double y, float const *z) const;
+
     private:
         guint32 color;
         //light position coordinates in render setting
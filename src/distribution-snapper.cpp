@@ -14,6 +14,7 @@
 #include <2geom/line.h>
 #include <2geom/path-intersection.h>
 #include <2geom/path-sink.h>
+#include <algorithm>
 #include <memory>
 
 #include "desktop.h"
@@ -81,6 +82,7 @@ Inkscape::DistributionSnapper::DistributionSnapper(SnapManager *sm, Geom::Coord
     _bboxes_left = std::make_unique<std::vector<Geom::Rect>>();
     _bboxes_up = std::make_unique<std::vector<Geom::Rect>>();
     _bboxes_down = std::make_unique<std::vector<Geom::Rect>>();
+    _edges = std::make_unique<std::array<std::vector<std::pair<Geom::Coord, std::size_t>>, 4>>();
 }
 
 Inkscape::DistributionSnapper::~DistributionSnapper()
@@ -111,6 +113,90 @@ Geom::Coord Inkscape::DistributionSnapper::distDown(Geom::Rect const &a, Geom::R
     return -a.max().y() + b.min().y();
 }
 
+Inkscape::DistributionSnapper::DistanceFunction Inkscape::DistributionSnapper::_distanceFunction(Direction dir)
+{
+    switch (dir) {
+        case Direction::RIGHT:
+            return &DistributionSnapper::distRight;
+        case Direction::LEFT:
+            return &DistributionSnapper::distLeft;
+        case Direction::UP:
+            return &DistributionSnapper::distUp;
+        case Direction::DOWN:
+        default:
+            return &DistributionSnapper::distDown;
+    }
+}
+
+Geom::Coord Inkscape::DistributionSnapper::_leadingEdge(Direction dir, Geom::Rect const &b)
+{
+    switch (dir) {
+        case Direction::RIGHT:
+            return b.min().x();
+        case Direction::LEFT:
+            return b.max().x();
+        case Direction::UP:
+            return b.max().y();
+        case Direction::DOWN:
+        default:
+            return b.min().y();
+    }
+}
+
+void Inkscape::DistributionSnapper::_sortEdges(std::vector<Geom::Rect> const &vec, Direction dir) const
+{
+    auto &edges = (*_edges)[static_cast<int>(dir)];
+    edges.clear();
+    edges.reserve(vec.size());
+    for (std::size_t i = 0; i < vec.size(); i++) {
+        edges.emplace_back(_leadingEdge(dir, vec[i]), i);
+    }
+    std::sort(edges.begin(), edges.end());
+}
+
+std::vector<std::size_t> Inkscape::DistributionSnapper::_findEdgesNear(Direction dir,
+                                                                        Geom::Rect const &source_bbox,
+                                                                        Geom::Coord dist,
+                                                                        Geom::Coord reach,
+                                                                        std::size_t first) const
+{
+    // The distance functions are linear in the leading edge of the second box, so the edge of a
+    // box at distance dist from source_bbox is found by stepping dist away from its far side
+    auto const &edges = (*_edges)[static_cast<int>(dir)];
+    Geom::Coord edge;
+    switch (dir) {
+        case Direction::RIGHT:
+            edge = source_bbox.max().x() + dist;
+            break;
+        case Direction::LEFT:
+            edge = source_bbox.min().x() - dist;
+            break;
+        case Direction::UP:
+            edge = source_bbox.min().y() - dist;
+            break;
+        case Direction::DOWN:
+        default:
+            edge = source_bbox.max().y() + dist;
+            break;
+    }
+    // Widen the range slightly, the callers do the exact comparison
+    Geom::Coord const slack = reach + 1e-9 * (1 + std::abs(edge));
+
+    std::vector<std::size_t> positions;
+    auto lo = std::lower_bound(edges.begin(), edges.end(), edge - slack,
+                               [] (std::pair<Geom::Coord, std::size_t> const &e, Geom::Coord value) {
+                                   return e.first < value;
+                               });
+    for (; lo != edges.end() && lo->first <= edge + slack; ++lo) {
+        if (lo->second >= first) {
+            positions.push_back(lo->second);
+        }
+    }
+    // Visit the boxes in the order of the sideways vector, like a linear scan would
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
 bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
                                     Geom::Rect const &source_bbox,
                                     std::vector<Geom::Rect>::iterator it,
@@ -118,9 +204,10 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
                                     std::vector<Geom::Rect> &vec,
                                     Geom::Coord &dist,
                                     Geom::Coord tol,
-                                    std::function<Geom::Coord(Geom::Rect const &, Geom::Rect const &)> const &distance_func,
+                                    Direction dir,
                                     int level) const
 {
+    auto const distance_func = _distanceFunction(dir);
     std::vector<Geom::Rect>::iterator next_bbox = it;
     std::vector<Geom::Rect>::iterator _next_bbox = it;
 
@@ -135,7 +222,7 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
 
             // temporary result for this particular item
             std::vector<Geom::Rect> result;
-            if (_findSidewaysSnaps(*next_bbox, ++it, end, result, first_dist, tol, distance_func, ++level)) {
+            if (_findSidewaysSnaps(*next_bbox, ++it, end, result, first_dist, tol, dir, ++level)) {
                 if (result.size() > max_length) {
                     // if this item has the most number of items equidistant form each other
                     // then make this the final result
@@ -171,7 +258,14 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
     int og_level = level;
     std::vector<Geom::Rect> best_result;
 
-    while (next_bbox != end) {
+    // Only the boxes whose leading edge lies at (nearly) the same distance can continue the
+    // sequence; look them up in the sorted edges instead of testing every remaining box
+    auto const &edges = (*_edges)[static_cast<int>(dir)];
+    std::size_t const first = edges.size() - static_cast<std::size_t>(end - it);
+    Geom::Coord const reach = std::max<Geom::Coord>(og_level == 1 ? tol : 0, og_level * DISTRIBUTION_SNAPPING_EPSILON);
+
+    for (auto pos : _findEdgesNear(dir, source_bbox, dist, reach, first)) {
+        next_bbox = end - static_cast<std::ptrdiff_t>(edges.size() - pos);
         level = og_level;
         Geom::Coord this_dist;
         Geom::Coord next_dist = distance_func(source_bbox, *next_bbox);
@@ -182,7 +276,7 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
             // if this is the first level, check if the snap is within tolerance
             // we cancel here if the possible snap in not whithing tolerance, saves us some time!
             this_dist = next_dist;
-            if (_findSidewaysSnaps(*next_bbox, ++it, end, temp_result, this_dist, tol, distance_func, ++level)) {
+            if (_findSidewaysSnaps(*next_bbox, ++it, end, temp_result, this_dist, tol, dir, ++level)) {
                 if (temp_result.size() > 0) {
                     dist = this_dist;
                     best_result = temp_result;
@@ -192,7 +286,7 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
 
         } else if (compare_double(dist, next_dist, level * DISTRIBUTION_SNAPPING_EPSILON)) {
 
-            if (_findSidewaysSnaps(*next_bbox, ++it, end, temp_result, dist, tol, distance_func, ++level)) {
+            if (_findSidewaysSnaps(*next_bbox, ++it, end, temp_result, dist, tol, dir, ++level)) {
                 if (temp_result.size() > 0) {
                     best_result = temp_result;
                     break;
@@ -202,8 +296,6 @@ bool Inkscape::DistributionSnapper::_findSidewaysSnaps(
 
         if (best_result.size() > 10)
             break;
-
-        ++next_bbox;
     }
 
     vec.insert(vec.end(), best_result.begin(), best_result.end());
@@ -275,6 +367,11 @@ void Inkscape::DistributionSnapper::_collectBBoxes(Geom::OptRect const &bbox_to_
     _addBBoxForIntersectingBoxes(_bboxes_left.get(), Direction::LEFT);
     _addBBoxForIntersectingBoxes(_bboxes_up.get(), Direction::UP);
     _addBBoxForIntersectingBoxes(_bboxes_down.get(), Direction::DOWN);
+
+    _sortEdges(*_bboxes_right, Direction::RIGHT);
+    _sortEdges(*_bboxes_left, Direction::LEFT);
+    _sortEdges(*_bboxes_up, Direction::UP);
+    _sortEdges(*_bboxes_down, Direction::DOWN);
 }
 
 void Inkscape::DistributionSnapper::_addBBoxForIntersectingBoxes(std::vector<Geom::Rect> *vec, Direction dir) const {
@@ -349,7 +446,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
     std::vector<Geom::Rect> vecRight;
     std::vector<Geom::Rect> vecLeft;
     if (consider_x && _bboxes_right->size() > 0) {
-        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_right->begin(), _bboxes_right->end(), vecRight, equal_dist, getSnapperTolerance(), &DistributionSnapper::distRight)) {
+        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_right->begin(), _bboxes_right->end(), vecRight, equal_dist, getSnapperTolerance(), Direction::RIGHT)) {
             auto first_dist = distRight(*bbox_to_snap, vecRight.front());
             Geom::Coord offset = first_dist - equal_dist;
             Geom::Point target = bbox_to_snap->midpoint() + Geom::Point(offset, 0);
@@ -364,7 +461,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
                 first_dist = distLeft(bbox, _bboxes_left->front());
                 Geom::Coord left_dist;
                 vecLeft.clear();
-                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_left->begin(), _bboxes_left->end(), vecLeft, left_dist, getSnapperTolerance(), &DistributionSnapper::distLeft)) {
+                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_left->begin(), _bboxes_left->end(), vecLeft, left_dist, getSnapperTolerance(), Direction::LEFT)) {
                     if (compare_double(left_dist, equal_dist)) {
                         std::reverse(vecLeft.begin(), vecLeft.end());
                         vecRight.insert(vecRight.begin(), vecLeft.begin(), vecLeft.end());
@@ -386,7 +483,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
     // add those bboxes too
     if (consider_x && !snap_x && _bboxes_left->size() > 0) {
         vecLeft.clear();
-        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_left->begin(), _bboxes_left->end(), vecLeft, equal_dist, getSnapperTolerance(), &DistributionSnapper::distLeft)) {
+        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_left->begin(), _bboxes_left->end(), vecLeft, equal_dist, getSnapperTolerance(), Direction::LEFT)) {
             auto first_dist = distLeft(*bbox_to_snap, vecLeft.front());
             Geom::Coord offset = first_dist - equal_dist;
             Geom::Point target = bbox_to_snap->midpoint() - Geom::Point(offset, 0);
@@ -403,7 +500,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
                 first_dist = distRight(bbox, _bboxes_right->front());
                 Geom::Coord right_dist;
                 vecRight.clear();
-                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_right->begin(), _bboxes_right->end(), vecRight, right_dist, getSnapperTolerance(), &DistributionSnapper::distRight)) {
+                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_right->begin(), _bboxes_right->end(), vecRight, right_dist, getSnapperTolerance(), Direction::RIGHT)) {
                     if (compare_double(right_dist, equal_dist)) {
                         vecLeft.insert(vecLeft.end(), vecRight.begin(), vecRight.end());
                     }
@@ -444,7 +541,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
     std::vector<Geom::Rect> vecUp;
     std::vector<Geom::Rect> vecDown;
     if (consider_y && _bboxes_up->size() > 0) {
-        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_up->begin(), _bboxes_up->end(), vecUp, equal_dist, getSnapperTolerance(), &DistributionSnapper::distUp)) {
+        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_up->begin(), _bboxes_up->end(), vecUp, equal_dist, getSnapperTolerance(), Direction::UP)) {
             auto first_dist = distUp(*bbox_to_snap, vecUp.front());
             Geom::Coord offset = first_dist - equal_dist;
             Geom::Point target = bbox_to_snap->midpoint() - Geom::Point(0, offset);
@@ -462,7 +559,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
                 Geom::Coord down_dist;
                 vecDown.clear();
                 if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_down->begin(), _bboxes_down->end(), vecDown, down_dist,
-                                      getSnapperTolerance(), &DistributionSnapper::distDown)) {
+                                      getSnapperTolerance(), Direction::DOWN)) {
                     if (abs(down_dist - equal_dist) < 1e-4) {
                         vecUp.insert(vecUp.end(), vecDown.begin(), vecDown.end());
                     }
@@ -483,7 +580,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
     // add those bboxes too
     if (consider_y && !snap_y && _bboxes_down->size() > 0) {
         vecDown.clear();
-        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_down->begin(), _bboxes_down->end(), vecDown, equal_dist, getSnapperTolerance(), &DistributionSnapper::distDown)) {
+        if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_down->begin(), _bboxes_down->end(), vecDown, equal_dist, getSnapperTolerance(), Direction::DOWN)) {
             auto first_dist = distDown(*bbox_to_snap, vecDown.front());
             Geom::Coord offset = first_dist - equal_dist;
             Geom::Point target = bbox_to_snap->midpoint() + Geom::Point(0, offset);
@@ -500,7 +597,7 @@ void Inkscape::DistributionSnapper::_snapEquidistantPoints(IntermSnapResults &is
                 Geom::Coord up_dist;
                 vecUp.clear();
 
-                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_up->begin(), _bboxes_up->end(), vecUp, up_dist, getSnapperTolerance(), &DistributionSnapper::distUp)) {
+                if (_findSidewaysSnaps(*bbox_to_snap, _bboxes_up->begin(), _bboxes_up->end(), vecUp, up_dist, getSnapperTolerance(), Direction::UP)) {
                     if (compare_double(up_dist, equal_dist)) {
                         std::reverse(vecUp.begin(), vecUp.end());
                         vecDown.insert(vecDown.begin(), vecUp.begin(), vecUp.end());
@@ -587,7 +684,7 @@ void Inkscape::DistributionSnapper::freeSnap(IntermSnapResults &isr,
 
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     _snapEquidistantPoints(isr, p, bbox_to_snap, unselected_nodes);
@@ -612,7 +709,7 @@ void Inkscape::DistributionSnapper::constrainedSnap(IntermSnapResults &isr,
 
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     _snapEquidistantPoints(isr, p, bbox_to_snap, unselected_nodes, c, pp);
@@ -12,7 +12,9 @@
 #define SEEN_DISTRIBUTION_SNAPPER_H
 
 #include <2geom/affine.h>
+#include <array>
 #include <memory>
+#include <utility>
 
 #include "snap-enums.h"
 #include "snapper.h"
@@ -63,11 +65,22 @@ public:
                   std::vector<SnapCandidatePoint> *unselected_nodes) const override;
 
 private:
+    enum class Direction {
+        RIGHT,
+        LEFT,
+        UP,
+        DOWN
+    };
+
     std::unique_ptr<std::vector<Geom::Rect>> _bboxes_left;
     std::unique_ptr<std::vector<Geom::Rect>> _bboxes_right;
     std::unique_ptr<std::vector<Geom::Rect>> _bboxes_down;
     std::unique_ptr<std::vector<Geom::Rect>> _bboxes_up;
 
+    /// Per direction, the leading edges of the boxes in the sideways vector (the coordinate the
+    /// distance to them is measured at) along with their position in it, sorted by edge
+    std::unique_ptr<std::array<std::vector<std::pair<Geom::Coord, std::size_t>>, 4>> _edges;
+
     /** Collects and caches bounding boxes to the left, right, up, and down of the
      * selected object.
      * @param bounding box of the selected object 
@@ -109,7 +122,7 @@ private:
      * @param vector where the snapped bboxes will be stored
      * @param equal distance between consecutive vectors
      * @param snapped tolerance 
-     * @param a function pointer to the distance function
+     * @param direction of the sideways vector, selects the distance function
      * @param level of recursion - do not pass this while calling the function
      */
     bool _findSidewaysSnaps(Geom::Rect const &source_bbox,
@@ -118,15 +131,21 @@ private:
                              std::vector<Geom::Rect> &vec,
                              Geom::Coord &dist,
                              Geom::Coord tol,
-                             std::function<Geom::Coord(Geom::Rect const&, Geom::Rect const&)> const & distance_func,
+                             Direction dir,
                              int level = 0) const;
 
-    enum class Direction {
-        RIGHT,
-        LEFT,
-        UP,
-        DOWN
-    };              
+    /** Sorts the leading edges of the boxes in a sideways vector, once per snapping session */
+    void _sortEdges(std::vector<Geom::Rect> const &vec, Direction dir) const;
+
+    /** Finds the boxes at about the given distance from source_bbox by binary search on their
+     * leading edges.
+     * @return positions in the sideways vector, not before first, in ascending order
+     */
+    std::vector<std::size_t> _findEdgesNear(Direction dir,
+                                            Geom::Rect const &source_bbox,
+                                            Geom::Coord dist,
+                                            Geom::Coord reach,
+                                            std::size_t first) const;
 
     /** This functions adds overlapping bounding boxes to the list of bounding boxes.
      * The new bounding boxes are added such that the union bounding box is placed before its constituents.
@@ -140,6 +159,10 @@ private:
     static Geom::Coord distLeft(Geom::Rect const &a, Geom::Rect const &b);
     static Geom::Coord distUp(Geom::Rect const &a, Geom::Rect const &b);
     static Geom::Coord distDown(Geom::Rect const &a, Geom::Rect const &b);
+
+    using DistanceFunction = Geom::Coord (*)(Geom::Rect const &, Geom::Rect const &);
+    static DistanceFunction _distanceFunction(Direction dir);
+    static Geom::Coord _leadingEdge(Direction dir, Geom::Rect const &b);
 }; // end of AlignmentSnapper class
 
 } // end of namespace Inkscape
@@ -37,8 +37,11 @@
 #define noSP_DOCUMENT_DEBUG_IDLE
 #define noSP_DOCUMENT_DEBUG_UNDO
 
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <cstring>
 
 #include <boost/range/adaptor/reversed.hpp>
@@ -54,6 +57,7 @@
 #include "inkscape-window.h"
 #include "profile-manager.h"
 #include "rdf.h"
+#include "style.h"
 
 #include "live_effects/effect.h"
 
@@ -62,6 +66,8 @@
 #include "actions/actions-pages.h"
 #include "actions/actions-svg-processing.h"
 
+#include "debug/trace.h"
+
 #include "display/drawing.h"
 #include "display/control/canvas-item-drawing.h"
 #include "ui/widget/canvas.h"
@@ -78,6 +84,7 @@
 #include "object/persp3d.h"
 #include "object/sp-defs.h"
 #include "object/sp-factory.h"
+#include "object/sp-item-group.h"
 #include "object/sp-namedview.h"
 #include "object/sp-root.h"
 #include "object/sp-symbol.h"
@@ -86,6 +93,7 @@
 #include "widgets/desktop-widget.h"
 
 #include "xml/croco-node-iface.h"
+#include "xml/node-fns.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/simple-document.h"
 
@@ -194,6 +202,11 @@ SPDocument::~SPDocument() {
         root = nullptr;
     }
 
+    for (auto &[child, parent] : _deferred) {
+        Inkscape::GC::release(child);
+    }
+    _deferred.clear();
+
     if (rdoc) Inkscape::GC::release(rdoc);
 
     /* Free resources */
@@ -414,8 +427,10 @@ SPDocument *SPDocument::createDoc(Inkscape::XML::Document *rdoc,
     	throw;
     }
 
-    // Recursively build object tree
+    // Recursively build object tree, optionally leaving hidden layers and resources for later
+    document->_lazy_building = Inkscape::Preferences::get()->getBool("/options/loading/lazy_build", false);
     document->root->invoke_build(document, rroot, false);
+    document->_lazy_building = false;
 
     /* Eliminate obsolete sodipodi:docbase, for privacy reasons */
     rroot->removeAttribute("sodipodi:docbase");
@@ -1172,6 +1187,8 @@ SPObject *SPDocument::getObjectById(std::string const &id) const
 
     if (auto rv = iddef.find(id); rv != iddef.end()) {
         return rv->second;
+    } else if (auto obj = _buildDeferred(id)) {
+        return obj;
     } else if (_parent_document) {
         return _parent_document->getObjectById(id);
     } else if (_ref_document) {
@@ -1187,6 +1204,8 @@ SPObject *SPDocument::getObjectById(char const *id) const
 
     if (auto rv = iddef.find(id); rv != iddef.end()) {
         return rv->second;
+    } else if (auto obj = _buildDeferred(id)) {
+        return obj;
     } else if (_parent_document) {
         return _parent_document->getObjectById(id);
     } else if (_ref_document) {
@@ -1239,6 +1258,7 @@ static void _getObjectsByClassRecursive(Glib::ustring const &klass, SPObject *pa
 std::vector<SPObject*> SPDocument::getObjectsByClass(Glib::ustring const &klass) const
 {
     if (klass.empty()) return {};
+    buildDeferred();
     std::vector<SPObject*> objects;
     _getObjectsByClassRecursive(klass, root, objects);
     return objects;
@@ -1266,6 +1286,7 @@ static void _getObjectsByElementRecursive(Glib::ustring const &element,
 std::vector<SPObject*> SPDocument::getObjectsByElement(Glib::ustring const &element, bool custom) const
 {
     if (element.empty()) return {};
+    buildDeferred();
     std::vector<SPObject*> objects;
     _getObjectsByElementRecursive(element, root, objects, custom);
     return objects;
@@ -1292,6 +1313,7 @@ static void _getObjectsBySelectorRecursive(SPObject *parent,
 std::vector<SPObject*> SPDocument::getObjectsBySelector(Glib::ustring const &selector) const
 {
     if (selector.empty()) return {};
+    buildDeferred();
 
     static CRSelEng *sel_eng = nullptr;
     if (!sel_eng) {
@@ -1310,6 +1332,258 @@ std::vector<SPObject*> SPDocument::getObjectsBySelector(Glib::ustring const &sel
     return objects;
 }
 
+/**
+ * Called while building @a parent to decide whether to leave the object for the XML node
+ * @a child unbuilt. In lazy build mode, this is the case for the contents of hidden layers and
+ * for resources in <defs> that can only be reached by id. Such a subtree stays bare XML until
+ * it is looked up, shown or listed, which keeps large hidden reference layers from dominating
+ * open time and memory.
+ */
+bool SPDocument::deferBuild(SPObject const &parent, Inkscape::XML::Node &child)
+{
+    if (!_lazy_building || parent.cloned || child.type() != Inkscape::XML::NodeType::ELEMENT_NODE) {
+        return false;
+    }
+
+    if (auto group = cast<SPGroup>(&parent)) {
+        if (group->layerMode() != SPGroup::LAYER || group->style->display.computed != SP_CSS_DISPLAY_NONE) {
+            return false;
+        }
+    } else if (is<SPDefs>(&parent)) {
+        // Swatches are listed in the UI, and markers and symbols are found by walking <defs>.
+        static auto const deferrable = std::set<std::string>{
+            "svg:linearGradient", "svg:radialGradient", "svg:pattern", "svg:filter", "svg:clipPath", "svg:mask"
+        };
+        if (!deferrable.count(child.name()) || child.attribute("inkscape:swatch") || child.attribute("osb:paint")) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    // Building assigns an id to every element that lacks a unique one, which must not happen
+    // later, when it would change the XML behind the back of undo and differ from a full build.
+    std::vector<char const *> ids;
+    std::unordered_set<std::string_view> seen;
+    bool complete = true;
+    sp_repr_visit_descendants(&child, [&] (Inkscape::XML::Node *node) {
+        if (!Inkscape::XML::id_permitted(node)) {
+            return true;
+        }
+        auto const id = node->attribute("id");
+        if (!id || iddef.count(id) || _deferred_ids.count(id) || !seen.emplace(id).second) {
+            complete = false;
+            return false;
+        }
+        ids.push_back(id);
+        return true;
+    });
+    if (!complete) {
+        return false;
+    }
+
+    // Build it right away if something is already waiting for one of its ids.
+    for (auto id : ids) {
+        auto const q = g_quark_try_string(id);
+        if (auto it = id_changed_signals.find(q); q && it != id_changed_signals.end() && !it->second.empty()) {
+            return false;
+        }
+    }
+
+    Inkscape::GC::anchor(&child);
+    _deferred.emplace(&child, parent.getRepr());
+    _deferred_by_parent[parent.getRepr()].push_back(&child);
+    for (auto id : ids) {
+        _deferred_ids.emplace(id, &child);
+    }
+    return true;
+}
+
+/// Whether any children of @a parent have been left unbuilt by deferBuild().
+bool SPDocument::hasDeferred(SPObject const *parent) const
+{
+    return !_deferred_by_parent.empty() && _deferred_by_parent.count(parent->getRepr());
+}
+
+/// Build the objects for all children of @a parent that were left unbuilt by deferBuild().
+void SPDocument::buildDeferred(SPObject const *parent) const
+{
+    auto it = _deferred_by_parent.find(parent->getRepr());
+    if (it == _deferred_by_parent.end()) {
+        return;
+    }
+
+    auto const children = std::move(it->second);
+    _deferred_by_parent.erase(it);
+    for (auto child : children) {
+        _deferred.erase(child);
+        _forgetDeferredIds(child);
+    }
+    for (auto child : children) {
+        _attachDeferred(parent->getRepr(), child);
+    }
+}
+
+/// Build every object left unbuilt by deferBuild(), for operations that need the whole tree.
+void SPDocument::buildDeferred() const
+{
+    while (!_deferred.empty()) {
+        _buildDeferredChild(_deferred.begin()->first);
+    }
+}
+
+/// Drop an unbuilt child that is being removed from the document.
+void SPDocument::forgetDeferred(Inkscape::XML::Node *child)
+{
+    auto it = _deferred.find(child);
+    if (it == _deferred.end()) {
+        return;
+    }
+
+    auto &siblings = _deferred_by_parent[it->second];
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), child), siblings.end());
+    if (siblings.empty()) {
+        _deferred_by_parent.erase(it->second);
+    }
+    _deferred.erase(it);
+    _forgetDeferredIds(child);
+    Inkscape::GC::release(child);
+}
+
+/// Drop the unbuilt children of an object that is being released.
+void SPDocument::forgetDeferredChildren(SPObject const *parent)
+{
+    // Clones share the repr of their original, whose children must be kept.
+    if (_deferred_by_parent.empty() || parent->cloned) {
+        return;
+    }
+
+    auto it = _deferred_by_parent.find(parent->getRepr());
+    if (it == _deferred_by_parent.end()) {
+        return;
+    }
+
+    for (auto child : it->second) {
+        _deferred.erase(child);
+        _forgetDeferredIds(child);
+        Inkscape::GC::release(child);
+    }
+    _deferred_by_parent.erase(it);
+}
+
+/// Build the unbuilt subtree containing @a id, if there is one, and return the object with that id.
+SPObject *SPDocument::_buildDeferred(std::string const &id) const
+{
+    if (_deferred_ids.empty()) {
+        return nullptr;
+    }
+
+    auto it = _deferred_ids.find(id);
+    if (it == _deferred_ids.end()) {
+        return nullptr;
+    }
+
+    auto const child = it->second;
+    _deferred_ids.erase(it);
+    _buildDeferredChild(child);
+
+    auto rv = iddef.find(id);
+    return rv == iddef.end() ? nullptr : rv->second;
+}
+
+void SPDocument::_buildDeferredChild(Inkscape::XML::Node *child) const
+{
+    auto it = _deferred.find(child);
+    if (it == _deferred.end()) {
+        return;
+    }
+
+    auto const parent = it->second;
+    _deferred.erase(it);
+    auto &siblings = _deferred_by_parent[parent];
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), child), siblings.end());
+    if (siblings.empty()) {
+        _deferred_by_parent.erase(parent);
+    }
+    _forgetDeferredIds(child);
+
+    _attachDeferred(parent, child);
+}
+
+/// Build the unbuilt subtrees that may contain resources registered under @a key.
+void SPDocument::_buildDeferredResources(char const *key) const
+{
+    if (_deferred.empty() || !_deferred_resources_built.emplace(key).second) {
+        return;
+    }
+
+    static auto const elements = std::map<std::string, std::set<std::string>>{
+        { "gradient", { "svg:linearGradient", "svg:radialGradient", "svg:meshgradient" } },
+        { "pattern",  { "svg:pattern" } },
+        { "filter",   { "svg:filter" } },
+        { "clipPath", { "svg:clipPath" } },
+        { "mask",     { "svg:mask" } },
+        { "image",    { "svg:image" } },
+        { "symbol",   { "svg:symbol" } },
+        { "font",     { "svg:font" } },
+        { "hatch",    { "svg:hatch" } },
+        { "script",   { "svg:script" } },
+        { "layer",    { "svg:g" } },
+    };
+    auto const names = elements.find(key);
+    bool const layers = !std::strcmp(key, "layer");
+
+    std::vector<Inkscape::XML::Node *> matches;
+    for (auto &[child, parent] : _deferred) {
+        bool found = names == elements.end(); // Unknown key, so build everything to be safe.
+        sp_repr_visit_descendants(child, [&] (Inkscape::XML::Node *node) {
+            if (found) {
+                return false;
+            }
+            if (node->type() == Inkscape::XML::NodeType::ELEMENT_NODE && names->second.count(node->name())) {
+                auto const mode = node->attribute("inkscape:groupmode");
+                found = !layers || (mode && !std::strcmp(mode, "layer"));
+            }
+            return !found;
+        });
+        if (found) {
+            matches.push_back(child);
+        }
+    }
+
+    for (auto child : matches) {
+        _buildDeferredChild(child);
+    }
+}
+
+void SPDocument::_attachDeferred(Inkscape::XML::Node *parent, Inkscape::XML::Node *child) const
+{
+    // The parent may have been deleted, or the child moved, since the child was deferred.
+    auto it = reprdef.find(parent);
+    if (it != reprdef.end() && child->parent() == parent && !reprdef.count(child)) {
+        // Building on demand is not an edit, so nothing it might still write may reach the undo log.
+        DocumentUndo::ScopedInsensitive _no_undo(const_cast<SPDocument *>(this));
+        it->second->child_added(child, child->prev());
+    }
+    Inkscape::GC::release(child);
+}
+
+void SPDocument::_forgetDeferredIds(Inkscape::XML::Node *child) const
+{
+    if (_deferred_ids.empty()) {
+        return;
+    }
+
+    sp_repr_visit_descendants(child, [&] (Inkscape::XML::Node *node) {
+        if (auto id = node->attribute("id")) {
+            if (auto it = _deferred_ids.find(id); it != _deferred_ids.end() && it->second == child) {
+                _deferred_ids.erase(it);
+            }
+        }
+        return true;
+    });
+}
+
 // Note: Despite appearances, this implementation is allocation-free thanks to SSO.
 std::string SPDocument::generate_unique_id(char const *prefix)
 {
@@ -1345,6 +1619,16 @@ SPObject *SPDocument::getObjectByRepr(Inkscape::XML::Node *repr) const
 {
     if (!repr) return nullptr;
     auto it = reprdef.find(repr);
+    if (it == reprdef.end() && !_deferred.empty()) {
+        // The node may be inside a subtree that has not been built yet.
+        for (auto node = repr; node; node = node->parent()) {
+            if (isDeferred(node)) {
+                _buildDeferredChild(node);
+                it = reprdef.find(repr);
+                break;
+            }
+        }
+    }
     return it == reprdef.end() ? nullptr : it->second;
 }
 
@@ -1434,6 +1718,8 @@ void SPDocument::setupViewport(SPItemCtx *ctx)
 bool
 SPDocument::_updateDocument(int update_flags)
 {
+    auto const span = Inkscape::Debug::TraceSpan("document update", "document");
+
     /* Process updates */
     if (this->root->uflags || this->root->mflags) {
         if (this->root->uflags) {
@@ -1897,6 +2183,8 @@ std::vector<SPObject *> const SPDocument::getResourceList(gchar const *key)
     g_return_val_if_fail(key != nullptr, emptyset);
     g_return_val_if_fail(*key != '\0', emptyset);
 
+    _buildDeferredResources(key);
+
     return resources[key];
 }
 
@@ -1959,6 +2247,9 @@ static void vacuum_document_recursive(SPObject *obj)
  */
 unsigned int SPDocument::vacuumDocument()
 {
+    // Unused definitions may not be built yet, and hidden layers may hold the only references to others.
+    buildDeferred();
+
     unsigned int start = objects_in_document(this);
     unsigned int end;
     unsigned int newend = start;
@@ -23,6 +23,9 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <queue>
 
@@ -291,6 +294,15 @@ public:
     std::vector<SPObject *> getObjectsByElement(Glib::ustring const &element, bool custom = false) const;
     std::vector<SPObject *> getObjectsBySelector(Glib::ustring const &selector) const;
 
+    // Lazy building --------------------------
+    bool deferBuild(SPObject const &parent, Inkscape::XML::Node &child);
+    bool isDeferred(Inkscape::XML::Node *repr) const { return _deferred.count(repr); }
+    bool hasDeferred(SPObject const *parent) const;
+    void buildDeferred(SPObject const *parent) const;
+    void buildDeferred() const;
+    void forgetDeferred(Inkscape::XML::Node *child);
+    void forgetDeferredChildren(SPObject const *parent);
+
     /**
      * @brief Generate a document-wide unique id.
      *
@@ -416,6 +428,20 @@ private:
     std::map<std::string, SPObject *> iddef;
     std::map<Inkscape::XML::Node *, SPObject *> reprdef;
 
+    // Lazy building -------------------------
+    // Building an unbuilt subtree on first use does not change the document, so lookups stay const.
+    bool _lazy_building = false; ///< Whether build() may currently leave subtrees unbuilt.
+    mutable std::unordered_map<Inkscape::XML::Node *, Inkscape::XML::Node *> _deferred; ///< Unbuilt child -> parent, anchored.
+    mutable std::unordered_map<Inkscape::XML::Node *, std::vector<Inkscape::XML::Node *>> _deferred_by_parent;
+    mutable std::unordered_map<std::string, Inkscape::XML::Node *> _deferred_ids; ///< Id -> unbuilt child containing it.
+    mutable std::set<std::string> _deferred_resources_built; ///< Resource keys with no unbuilt objects left.
+
+    SPObject *_buildDeferred(std::string const &id) const;
+    void _buildDeferredChild(Inkscape::XML::Node *child) const;
+    void _buildDeferredResources(char const *key) const;
+    void _attachDeferred(Inkscape::XML::Node *parent, Inkscape::XML::Node *child) const;
+    void _forgetDeferredIds(Inkscape::XML::Node *child) const;
+
     // Find items by geometry --------------------
     mutable std::deque<SPItem*> _node_cache; // Used to speed up search.
     mutable bool _node_cache_valid;
@@ -116,6 +116,8 @@ CairoRenderContext::CairoRenderContext(CairoRenderer *parent) :
     _is_texttopath(FALSE),
     _is_omittext(FALSE),
     _is_filtertobitmap(FALSE),
+    _is_reuse_clones(false),
+    _is_parallel_pages(false),
     _is_show_page(false),
     _bitmapresolution(72),
     _stream(nullptr),
@@ -219,6 +221,39 @@ CairoRenderContext* CairoRenderContext::cloneMe() const
     return cloneMe(_width, _height);
 }
 
+/**
+ * \brief Creates a new render context drawing into an unbounded recording surface
+ *
+ * The new context shares the output options of this context. Painting its surface
+ * repeatedly into a PDF surface emits its contents only once, as a form XObject.
+ */
+CairoRenderContext*
+CairoRenderContext::cloneForRecording() const
+{
+    g_assert( _is_valid );
+
+    CairoRenderContext *new_context = _renderer->createContext();
+    cairo_surface_t *surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    new_context->_cr = cairo_create(surface);
+    new_context->_surface = surface;
+    new_context->_width = _width;
+    new_context->_height = _height;
+    new_context->_target = _target;
+    new_context->_vector_based_target = _vector_based_target;
+    new_context->_pdf_level = _pdf_level;
+    new_context->_ps_level = _ps_level;
+    new_context->_is_pdf = _is_pdf;
+    new_context->_is_ps = _is_ps;
+    new_context->_is_texttopath = _is_texttopath;
+    new_context->_is_filtertobitmap = _is_filtertobitmap;
+    new_context->_is_reuse_clones = _is_reuse_clones;
+    new_context->_bitmapresolution = _bitmapresolution;
+    new_context->_clip_mode = _clip_mode;
+    new_context->_is_valid = TRUE;
+
+    return new_context;
+}
+
 bool CairoRenderContext::setImageTarget(cairo_format_t format)
 {
     // format cannot be set on an already initialized surface
@@ -454,6 +489,26 @@ bool CairoRenderContext::getFilterToBitmap()
     return _is_filtertobitmap;
 }
 
+void CairoRenderContext::setReuseClones(bool reuseclones)
+{
+    _is_reuse_clones = reuseclones;
+}
+
+bool CairoRenderContext::getReuseClones()
+{
+    return _is_reuse_clones;
+}
+
+void CairoRenderContext::setParallelPages(bool parallelpages)
+{
+    _is_parallel_pages = parallelpages;
+}
+
+bool CairoRenderContext::getParallelPages()
+{
+    return _is_parallel_pages;
+}
+
 void CairoRenderContext::setBitmapResolution(int resolution)
 {
     _bitmapresolution = resolution;
@@ -1789,6 +1844,26 @@ bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
     return true;
 }
 
+/**
+ * Paints a surface created with cloneForRecording() at the current transform.
+ * Vector backends emit each recording surface once and reference it on every paint.
+ */
+void CairoRenderContext::paintRecording(cairo_surface_t *recording)
+{
+    g_assert( _is_valid );
+
+    if (_render_mode == RENDER_MODE_CLIP) {
+        return;
+    }
+
+    _prepareRenderGraphic();
+
+    cairo_save(_cr);
+    cairo_set_source_surface(_cr, recording, 0.0, 0.0);
+    cairo_paint(_cr);
+    cairo_restore(_cr);
+}
+
 #define GLYPH_ARRAY_SIZE 64
 
 // TODO investigate why the font is being ignored:
@@ -81,6 +81,7 @@ class CairoRenderContext {
 public:
     CairoRenderContext *cloneMe() const;
     CairoRenderContext *cloneMe(double width, double height) const;
+    CairoRenderContext *cloneForRecording() const;
     bool finish(bool finish_surface = true);
     bool finishPage();
     bool nextPage(double width, double height, char const *label);
@@ -114,6 +115,10 @@ public:
     bool getOmitText();
     void setFilterToBitmap(bool filtertobitmap);
     bool getFilterToBitmap();
+    void setReuseClones(bool reuseclones);
+    bool getReuseClones();
+    void setParallelPages(bool parallelpages);
+    bool getParallelPages();
     void setBitmapResolution(int resolution);
     int getBitmapResolution();
 
@@ -177,6 +182,7 @@ public:
     bool renderGlyphtext(PangoFont *font, Geom::Affine const &font_matrix,
                          std::vector<CairoGlyphInfo> const &glyphtext, SPStyle const *style,
                          bool second_pass = false);
+    void paintRecording(cairo_surface_t *recording);
 
     /* More general rendering methods will have to be added (like fill, stroke) */
 
@@ -199,6 +205,8 @@ protected:
     bool _is_texttopath;
     bool _is_omittext;
     bool _is_filtertobitmap;
+    bool _is_reuse_clones;
+    bool _is_parallel_pages;
     bool _is_show_page;
     // If both ps and pdf are false, then we are printing.
     bool _is_pdf;
@@ -90,6 +90,8 @@ pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int
     ctx->setTextToPath(flags.text_to_path);
     ctx->setOmitText(flags.text_to_latex);
     ctx->setFilterToBitmap(flags.rasterize_filters);
+    ctx->setReuseClones(flags.reuse_clones);
+    ctx->setParallelPages(flags.parallel_pages);
     ctx->setBitmapResolution(resolution);
 
     bool ret = ctx->setPdfTarget (filename);
@@ -167,6 +169,22 @@ CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc,
         g_warning("Parameter <blurToBitmap> might not exist");
     }
 
+    flags.reuse_clones = false;
+    try {
+        flags.reuse_clones = mod->get_param_bool("reuseClones");
+    }
+    catch(...) {
+        g_warning("Parameter <reuseClones> might not exist");
+    }
+
+    flags.parallel_pages = false;
+    try {
+        flags.parallel_pages = mod->get_param_bool("parallelPages");
+    }
+    catch(...) {
+        g_warning("Parameter <parallelPages> might not exist");
+    }
+
     int new_bitmapResolution  = 72;
     try {
         new_bitmapResolution = mod->get_param_int("resolution");
@@ -230,6 +248,12 @@ CairoRendererPdfOutput::init ()
             "</param>\n"
             "<param name=\"blurToBitmap\" gui-text=\"" N_("Rasterize filter effects") "\" type=\"bool\">true</param>\n"
             "<param name=\"resolution\" gui-text=\"" N_("Resolution for rasterization (dpi):") "\" type=\"int\" min=\"1\" max=\"10000\">96</param>\n"
+            "<param name=\"reuseClones\" gui-text=\"" N_("Reuse clones and symbols") "\" gui-description=\""
+                N_("Write the content of clones and symbols once and reference it for every copy. This reduces file size for documents with many clones.")
+                "\" type=\"bool\">false</param>\n"
+            "<param name=\"parallelPages\" gui-text=\"" N_("Render pages in parallel") "\" gui-description=\""
+                N_("Use several threads to render the pages of multi-page documents.")
+                "\" type=\"bool\">false</param>\n"
             "<spacer size=\"10\" />"
             "<param name=\"stretch\" gui-text=\"" N_("Rounding compensation:") "\" gui-description=\""
                 N_("Exporting to PDF rounds the document size to the next whole number in pt units. Compensation may stretch the drawing slightly (up to 0.35mm for width and/or height). When not compensating, object sizes will be preserved strictly, but this can sometimes cause white gaps along the page margins.")
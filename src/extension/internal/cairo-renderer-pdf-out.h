@@ -37,6 +37,8 @@ struct PDFOptions {
     bool rasterize_filters : 1; ///< Rasterize filter effects?
     bool drawing_only      : 1; ///< Set page size to drawing + margin instead of document page.
     bool stretch_to_fit    : 1; ///< Compensate for Cairo's page size rounding to integers (in pt)?
+    bool reuse_clones      : 1; ///< Emit the content of clones of the same source only once?
+    bool parallel_pages    : 1; ///< Render pages concurrently?
 };
 
 } } }  /* namespace Inkscape, Extension, Internal */
@@ -28,6 +28,11 @@
 
 #include <csignal>
 #include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <sstream>
 
 
 #include <2geom/transforms.h>
@@ -49,6 +54,7 @@
 #include "document.h"
 #include "inkscape-version.h"
 #include "rdf.h"
+#include "style.h"
 #include "style-internal.h"
 #include "display/cairo-utils.h"
 #include "display/curve.h"
@@ -66,7 +72,9 @@
 #include "object/sp-anchor.h"
 #include "object/sp-clippath.h"
 #include "object/sp-defs.h"
+#include "object/sp-filter.h"
 #include "object/sp-flowtext.h"
+#include "object/sp-hatch.h"
 #include "object/sp-hatch-path.h"
 #include "object/sp-image.h"
 #include "object/sp-item-group.h"
@@ -74,6 +82,7 @@
 #include "object/sp-linear-gradient.h"
 #include "object/sp-marker.h"
 #include "object/sp-mask.h"
+#include "object/sp-mesh-gradient.h"
 #include "object/sp-page.h"
 #include "object/sp-pattern.h"
 #include "object/sp-radial-gradient.h"
@@ -82,7 +91,10 @@
 #include "object/sp-symbol.h"
 #include "object/sp-text.h"
 #include "object/sp-use.h"
+#include "object/filters/image.h"
+#include "object/filters/turbulence.h"
 
+#include "util/parallel.h"
 #include "util/units.h"
 
 //#define TRACE(_args) g_printf _args
@@ -99,6 +111,12 @@ CairoRenderer::CairoRenderer(void)
 
 CairoRenderer::~CairoRenderer()
 {
+    for (auto &recording : _clone_recordings) {
+        if (recording.second) {
+            cairo_surface_destroy(recording.second);
+        }
+    }
+
     /* restore default signal handling for SIGPIPE */
 #if !defined(_WIN32) && !defined(__WIN32__)
     (void) signal(SIGPIPE, SIG_DFL);
@@ -394,7 +412,7 @@ static void sp_use_render(SPUse *use, CairoRenderContext *ctx, SPPage *page)
         translated = true;
     }
 
-    if (use->child) {
+    if (use->child && !renderer->renderCloneRecording(ctx, use, page)) {
         // Padding in the use object as the origin here ensures markers
         // are rendered with their correct context-fill.
         renderer->renderItem(ctx, use->child, use, page);
@@ -405,13 +423,21 @@ static void sp_use_render(SPUse *use, CairoRenderContext *ctx, SPPage *page)
     }
 }
 
+/**
+ * Glyphs are loaded lazily through the shared Pango font map, which is not thread-safe.
+ * Pages may be rendered concurrently, so text is drawn by one thread at a time.
+ */
+static std::mutex text_render_mutex;
+
 static void sp_text_render(SPText *text, CairoRenderContext *ctx)
 {
+    std::lock_guard lock(text_render_mutex);
     text->layout.showGlyphs(ctx);
 }
 
 static void sp_flowtext_render(SPFlowtext *flowtext, CairoRenderContext *ctx)
 {
+    std::lock_guard lock(text_render_mutex);
     flowtext->layout.showGlyphs(ctx);
 }
 
@@ -534,12 +560,18 @@ static void sp_root_render(SPRoot *root, CairoRenderContext *ctx)
 }
 
 /**
-    This function converts the item to a raster image and includes the image into the cairo renderer.
-    It is only used for filters and then only when rendering filters as bitmaps is requested.
-*/
-static void sp_asbitmap_render(SPItem *item, CairoRenderContext *ctx, SPPage *page)
+ * Placement of the bitmap replacing an item rendered by sp_asbitmap_render().
+ */
+struct BitmapGeometry
 {
+    Geom::Rect bbox;   ///< Area to rasterize in document coordinates.
+    double res;        ///< Resolution of the bitmap in dpi.
+    Geom::Affine t;    ///< Transform of the bitmap relative to the item.
+    bool clipped;      ///< Whether the area was cut by the page or document bounds.
+};
 
+static std::optional<BitmapGeometry> sp_asbitmap_geometry(SPItem *item, CairoRenderContext *ctx, SPPage *page)
+{
     // The code was adapted from sp_selection_create_bitmap_copy in selection-chemistry.cpp
 
     // Calculate resolution
@@ -553,20 +585,21 @@ static void sp_asbitmap_render(SPItem *item, CairoRenderContext *ctx, SPPage *pa
     TRACE(("sp_asbitmap_render: resolution: %f\n", res ));
 
     // Get the bounding box of the selection in document coordinates.
-    Geom::OptRect bbox = item->documentVisualBounds();
+    Geom::OptRect const visual_bbox = item->documentVisualBounds();
+    Geom::OptRect bbox = visual_bbox;
 
     bbox &= (page ? page->getDocumentRect() : item->document->preferredBounds());
 
     // no bbox, e.g. empty group or item not overlapping its page
     if (!bbox) {
-        return;
+        return {};
     }
 
     // The width and height of the bitmap in pixels
     unsigned width =  ceil(bbox->width() * Inkscape::Util::Quantity::convert(res, "px", "in"));
     unsigned height = ceil(bbox->height() * Inkscape::Util::Quantity::convert(res, "px", "in"));
 
-    if (width == 0 || height == 0) return;
+    if (width == 0 || height == 0) return {};
 
     // Scale to exactly fit integer bitmap inside bounding box
     double scale_x = bbox->width() / width;
@@ -592,18 +625,96 @@ static void sp_asbitmap_render(SPItem *item, CairoRenderContext *ctx, SPPage *pa
     Geom::Affine t_item =  item->i2doc_affine();
     Geom::Affine t = t_on_document * t_item.inverse();
 
-    // Do the export
-    SPDocument *document = item->document;
+    return BitmapGeometry{*bbox, res, t, *bbox != *visual_bbox};
+}
 
-    std::vector<SPItem*> items;
-    items.push_back(item);
+/**
+ * Whether a filter on @a object or below it gives a result that depends on where it is drawn,
+ * rather than only moving along with it: noise and images placed in user space, filter regions
+ * in user space, and the background as an input.
+ */
+static bool sp_filter_depends_on_position(SPObject const *object)
+{
+    auto item = cast<SPItem>(object);
+    if (auto filter = item && item->style ? item->style->getFilter() : nullptr) {
+        if (filter->filterUnits == SP_FILTER_UNITS_USERSPACEONUSE) {
+            return true;
+        }
+        for (auto &primitive : filter->children) {
+            if (is<SPFeTurbulence>(&primitive) || is<SPFeImage>(&primitive)) {
+                return true;
+            }
+            for (auto attr : {"in", "in2"}) {
+                auto const in = primitive.getAttribute(attr);
+                if (in && (!std::strcmp(in, "BackgroundImage") || !std::strcmp(in, "BackgroundAlpha"))) {
+                    return true;
+                }
+            }
+        }
+    }
 
-    std::unique_ptr<Inkscape::Pixbuf> pb(sp_generate_internal_bitmap(document, *bbox, res, items, true));
+    for (auto &child : object->children) {
+        if (sp_filter_depends_on_position(&child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Filtered clones of the same source whose bitmaps only differ by a translation share one
+ * bitmap. Returns an empty key for items that can't share their bitmap.
+ */
+static std::string sp_asbitmap_clone_key(SPItem *item, BitmapGeometry const &geom)
+{
+    auto use = cast<SPUse>(item);
+    if (!use || !use->child || geom.clipped || sp_filter_depends_on_position(use)) {
+        return {};
+    }
+
+    std::ostringstream key;
+    key.precision(17);
+    key << static_cast<void const *>(use->get_original()) << ';'
+        << static_cast<void const *>(use->getClipObject()) << ';'
+        << static_cast<void const *>(use->getMaskObject()) << ';'
+        << use->width.computed << ',' << use->height.computed << ';'
+        << geom.res << ',' << geom.bbox.width() << ',' << geom.bbox.height() << ';';
+    auto const i2doc = use->i2doc_affine();
+    for (unsigned i = 0; i < 4; i++) {
+        key << i2doc[i] << ',';
+    }
+    key << ';' << use->style->write(SP_STYLE_FLAG_ALWAYS);
+    return key.str();
+}
+
+/**
+    This function converts the item to a raster image and includes the image into the cairo renderer.
+    It is only used for filters and then only when rendering filters as bitmaps is requested.
+*/
+static void sp_asbitmap_render(SPItem *item, CairoRenderContext *ctx, SPPage *page)
+{
+    auto const geom = sp_asbitmap_geometry(item, ctx, page);
+    if (!geom) {
+        return;
+    }
+
+    // Use the bitmap rendered ahead of time if there is one
+    std::shared_ptr<Inkscape::Pixbuf> pb = ctx->getRenderer()->takePrerenderedBitmap(item, page);
+
+    if (!pb) {
+        // Do the export
+        SPDocument *document = item->document;
+
+        std::vector<SPItem*> items;
+        items.push_back(item);
+
+        pb.reset(sp_generate_internal_bitmap(document, geom->bbox, geom->res, items, true));
+    }
 
     if (pb) {
         //TEST(gdk_pixbuf_save( pb, "bitmap.png", "png", NULL, NULL ));
 
-        ctx->renderImage(pb.get(), t, item->style);
+        ctx->renderImage(pb.get(), geom->t, item->style);
     }
 }
 
@@ -742,6 +853,244 @@ void CairoRenderer::renderItem(CairoRenderContext *ctx, SPItem *item, SPItem *or
     ctx->popState();
 }
 
+/**
+ * Check whether the rendering of an item doesn't depend on its position in the document,
+ * so that it can be recorded once and painted by reference.
+ */
+static bool sp_item_is_recordable(SPItem *item, CairoRenderContext *ctx)
+{
+    // Masks are rendered as bitmaps in device space, rasterized filters in document space.
+    if (item->getMaskObject() || (ctx->getFilterToBitmap() && item->isFiltered())) {
+        return false;
+    }
+    // Links and link destinations must not be duplicated.
+    if (is<SPAnchor>(item)) {
+        return false;
+    }
+    std::vector<SPObject *> links;
+    item->getLinked(links, true);
+    for (auto link : links) {
+        if (is<SPAnchor>(link)) {
+            return false;
+        }
+    }
+    for (auto &child : item->children) {
+        if (auto child_item = cast<SPItem>(&child)) {
+            if (!sp_item_is_recordable(child_item, ctx)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Whether @a object, its descendants or their markers paint with context-fill or context-stroke.
+ * Inside a clone these resolve against the <use>, whose own paint is not part of the recording key.
+ */
+static bool sp_item_uses_context_paint(SPObject const *object)
+{
+    if (auto style = object->style) {
+        for (auto paint : {&style->fill, &style->stroke}) {
+            if (paint->paintOrigin == SP_CSS_PAINT_ORIGIN_CONTEXT_FILL ||
+                paint->paintOrigin == SP_CSS_PAINT_ORIGIN_CONTEXT_STROKE) {
+                return true;
+            }
+        }
+    }
+    if (auto shape = cast<SPShape>(object)) {
+        for (auto marker : shape->_marker) {
+            if (marker && sp_item_uses_context_paint(marker)) {
+                return true;
+            }
+        }
+    }
+    for (auto &child : object->children) {
+        if (sp_item_uses_context_paint(&child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Clones render identically if they reference the same source with the same computed style
+ * and transform. For symbols, the viewport transform depends on the size of the <use>.
+ */
+static std::string sp_use_recording_key(SPUse const *use)
+{
+    std::ostringstream key;
+    key.precision(17);
+    key << static_cast<void const *>(use->get_original()) << ';';
+    for (unsigned i = 0; i < 6; i++) {
+        key << use->child->transform[i] << ',';
+    }
+    if (auto symbol = cast<SPSymbol>(use->child)) {
+        for (unsigned i = 0; i < 6; i++) {
+            key << symbol->c2p[i] << ',';
+        }
+    }
+    key << ';' << use->child->style->write(SP_STYLE_FLAG_ALWAYS);
+    return key.str();
+}
+
+bool CairoRenderer::renderCloneRecording(CairoRenderContext *ctx, SPUse *use, SPPage *page)
+{
+    if (!ctx->getReuseClones() || ctx->getOmitText() || !use->child ||
+        ctx->getRenderMode() != CairoRenderContext::RENDER_MODE_NORMAL) {
+        return false;
+    }
+
+    auto const key = sp_use_recording_key(use);
+    cairo_surface_t *recording = nullptr;
+    {
+        std::lock_guard lock(_clone_recordings_mutex);
+        auto it = _clone_recordings.find(key);
+        if (it != _clone_recordings.end()) {
+            if (!it->second) {
+                return false;
+            }
+            recording = cairo_surface_reference(it->second);
+        }
+    }
+
+    if (!recording) {
+        // Pages may be rendered concurrently, so the lock is not held while recording; if
+        // another thread recorded the same source in the meantime, its recording is used.
+        if (sp_item_is_recordable(use->child, ctx) && !sp_item_uses_context_paint(use->child)) {
+            CairoRenderContext *recording_ctx = ctx->cloneForRecording();
+            renderItem(recording_ctx, use->child, use, page);
+            recording = cairo_surface_reference(recording_ctx->getSurface());
+            destroyContext(recording_ctx);
+        }
+
+        std::lock_guard lock(_clone_recordings_mutex);
+        auto [it, inserted] = _clone_recordings.emplace(key, recording);
+        if (!inserted && recording) {
+            cairo_surface_destroy(recording);
+        }
+        if (!it->second) {
+            return false;
+        }
+        recording = cairo_surface_reference(it->second);
+    }
+
+    ctx->paintRecording(recording);
+    cairo_surface_destroy(recording);
+    return true;
+}
+
+void CairoRenderer::_collectBitmapItems(CairoRenderContext *ctx, SPItem *item, std::vector<SPItem *> &items)
+{
+    if (item->isHidden() || has_hidder_filter(item)) {
+        return;
+    }
+
+    if (_shouldRasterize(ctx, item)) {
+        items.push_back(item);
+    } else if (auto use = cast<SPUse>(item)) {
+        if (use->child) {
+            _collectBitmapItems(ctx, use->child, items);
+        }
+    } else if (auto symbol = cast<SPSymbol>(item); symbol && !symbol->cloned) {
+        // Not rendered, see sp_symbol_render().
+    } else if (is<SPGroup>(item) && !is<SPMarker>(item)) {
+        for (auto &child : item->children) {
+            if (auto child_item = cast<SPItem>(&child)) {
+                _collectBitmapItems(ctx, child_item, items);
+            }
+        }
+    }
+}
+
+/**
+ * Rasterize all filtered items reachable from the given items before they are rendered.
+ *
+ * Setting up the offscreen drawings has to happen on the main thread, but the (expensive)
+ * rendering of the filters runs concurrently. The results are picked up by sp_asbitmap_render()
+ * during the regular tree walk. Items which are missed here, e.g. in markers or patterns,
+ * are still rasterized on demand.
+ */
+void CairoRenderer::_prerenderBitmaps(CairoRenderContext *ctx, std::vector<SPItem *> const &items, SPPage *page)
+{
+    _prerendered_bitmaps.clear();
+    if (!ctx->getFilterToBitmap()) {
+        return;
+    }
+
+    std::vector<SPItem *> filtered;
+    for (auto item : items) {
+        _collectBitmapItems(ctx, item, filtered);
+    }
+    if (filtered.empty()) {
+        return;
+    }
+
+    // One job per distinct bitmap, identical clones are mapped to the same job.
+    struct BitmapJob
+    {
+        SPItem *item;
+        BitmapGeometry geom;
+        std::shared_ptr<Inkscape::Pixbuf> result;
+    };
+    std::vector<BitmapJob> jobs;
+    std::vector<std::pair<SPItem *, size_t>> assignments;
+    std::map<std::string, size_t> clone_jobs;
+
+    for (auto item : filtered) {
+        auto const geom = sp_asbitmap_geometry(item, ctx, page);
+        if (!geom) {
+            continue;
+        }
+        auto const key = sp_asbitmap_clone_key(item, *geom);
+        if (!key.empty()) {
+            if (auto it = clone_jobs.find(key); it != clone_jobs.end()) {
+                assignments.emplace_back(item, it->second);
+                continue;
+            }
+            clone_jobs.emplace(key, jobs.size());
+        }
+        assignments.emplace_back(item, jobs.size());
+        jobs.push_back({item, *geom, nullptr});
+    }
+
+    // Each offscreen drawing holds the whole document, so only as many are alive as there are threads.
+    size_t const numthreads = Inkscape::Util::get_num_threads();
+
+    for (size_t batch = 0; batch < jobs.size(); batch += numthreads) {
+        auto const batch_end = std::min(jobs.size(), batch + numthreads);
+
+        std::vector<std::unique_ptr<InternalBitmapRenderer>> renderers;
+        for (size_t i = batch; i < batch_end; i++) {
+            auto &job = jobs[i];
+            renderers.emplace_back(std::make_unique<InternalBitmapRenderer>(
+                job.item->document, job.geom.bbox, job.geom.res, std::vector<SPItem *>{job.item}, true));
+        }
+
+        Inkscape::Util::parallel_for(batch_end - batch, [&] (size_t i) {
+            jobs[batch + i].result.reset(renderers[i]->render());
+        });
+        // Destroying the renderers hides the offscreen drawings again.
+    }
+
+    for (auto const &[item, job] : assignments) {
+        if (jobs[job].result) {
+            _prerendered_bitmaps[{item, page}] = jobs[job].result;
+        }
+    }
+}
+
+std::shared_ptr<Inkscape::Pixbuf> CairoRenderer::takePrerenderedBitmap(SPItem const *item, SPPage const *page)
+{
+    auto it = _prerendered_bitmaps.find({item, page});
+    if (it == _prerendered_bitmaps.end()) {
+        return {};
+    }
+    auto result = std::move(it->second);
+    _prerendered_bitmaps.erase(it);
+    return result;
+}
+
 void CairoRenderer::renderHatchPath(CairoRenderContext *ctx, SPHatchPath const &hatchPath, unsigned key) {
     ctx->pushState();
     ctx->setStateForStyle(hatchPath.style);
@@ -837,10 +1186,16 @@ CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretc
     auto pages = doc->getPageManager().getPages();
     if (pages.size() == 0) {
         // Output the page bounding box as already set up in the initial setupDocument.
+        _prerenderBitmaps(ctx, {doc->getRoot()}, nullptr);
         renderItem(ctx, doc->getRoot());
+        _prerendered_bitmaps.clear();
         return true;
     }
 
+    if (ctx->getParallelPages() && !ctx->getOmitText() && pages.size() > 1) {
+        return _renderPagesConcurrently(ctx, doc, pages, stretch_to_fit);
+    }
+
     for (auto &page : pages) {
         ctx->pushState();
         if (!renderPage(ctx, doc, page, stretch_to_fit)) {
@@ -861,6 +1216,23 @@ CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretc
 
 bool
 CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page, bool stretch_to_fit)
+{
+    auto const page_rect = _setupPage(ctx, doc, page, stretch_to_fit);
+    ctx->nextPage(page_rect.width(), page_rect.height(), page->label());
+
+    auto const items = page->getOverlappingItems(false, true, false);
+    _prerenderBitmaps(ctx, items, page);
+    _renderPageItems(ctx, items, page);
+    _prerendered_bitmaps.clear();
+    return true;
+}
+
+/**
+ * Apply the transformation of the page to the context.
+ *
+ * @return The page rectangle in PostScript points, rounded to integers.
+ */
+Geom::Rect CairoRenderer::_setupPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page, bool stretch_to_fit)
 {
     // Calculate exact page rectangle in PostScript points:
     auto scale = doc->getDocumentScale();
@@ -885,12 +1257,18 @@ CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page
 
     SPRoot *root = doc->getRoot();
     ctx->transform(root->transform);
-    ctx->nextPage(page_rect.width(), page_rect.height(), page->label());
 
     // Set up page transformation which pushes objects back into the 0,0 location
     ctx->transform(Geom::Translate(rect.corner(0)).inverse());
 
-    for (auto &child : page->getOverlappingItems(false, true, false)) {
+    return page_rect;
+}
+
+void CairoRenderer::_renderPageItems(CairoRenderContext *ctx, std::vector<SPItem *> const &items, SPPage *page)
+{
+    SPRoot *root = page->document->getRoot();
+
+    for (auto &child : items) {
         ctx->pushState();
 
         // This process does not return layers, so those affines are added manually.
@@ -906,9 +1284,139 @@ CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page
         renderItem(ctx, child, nullptr, page);
         ctx->popState();
     }
+}
+
+/**
+ * Check whether rendering an object only reads from the object tree, so that it can happen
+ * on a worker thread. Markers, patterns and hatches temporarily modify objects while being
+ * rendered, and rasterized filters show the document in a new drawing.
+ *
+ * Gradient vectors are built on the way, since that would otherwise happen during rendering.
+ */
+bool CairoRenderer::_canRenderConcurrently(CairoRenderContext *ctx, SPObject *object)
+{
+    if (auto item = cast<SPItem>(object)) {
+        if (item->isHidden()) {
+            return true;
+        }
+        if (_shouldRasterize(ctx, item)) {
+            return false;
+        }
+        if (auto shape = cast<SPShape>(item); shape && shape->hasMarkers()) {
+            return false;
+        }
+        if (auto clip = item->getClipObject(); clip && !_canRenderConcurrently(ctx, clip)) {
+            return false;
+        }
+        if (auto mask = item->getMaskObject(); mask && !_canRenderConcurrently(ctx, mask)) {
+            return false;
+        }
+    }
+
+    if (auto style = object->style) {
+        for (auto server : {style->getFillPaintServer(), style->getStrokePaintServer()}) {
+            if (is<SPPattern>(server) || is<SPHatch>(server) || is<SPMeshGradient>(server)) {
+                return false;
+            }
+            if (auto gradient = cast<SPGradient>(server)) {
+                gradient->ensureVector();
+            }
+        }
+    }
+
+    for (auto &child : object->children) {
+        if (!_canRenderConcurrently(ctx, &child)) {
+            return false;
+        }
+    }
     return true;
 }
 
+/**
+ * Render each page into its own recording surface and replay the recordings into the
+ * output in page order. Pages whose content can be rendered without modifying the object
+ * tree are recorded on worker threads, the others on the main thread beforehand.
+ */
+bool CairoRenderer::_renderPagesConcurrently(CairoRenderContext *ctx, SPDocument *doc,
+                                             std::vector<SPPage *> const &pages, bool stretch_to_fit)
+{
+    int const numthreads = Inkscape::Util::get_num_threads();
+
+    struct PageRecording
+    {
+        CairoRenderContext *ctx;
+        Geom::Rect rect;
+        std::vector<SPItem *> items;
+        bool concurrent;
+    };
+
+    // Limit the number of recorded pages kept in memory before they are written out.
+    size_t const window = 2 * numthreads;
+    bool ret = true;
+
+    for (size_t first = 0; ret && first < pages.size(); first += window) {
+        auto const last = std::min(pages.size(), first + window);
+        std::vector<PageRecording> recordings;
+
+        for (size_t i = first; i < last; i++) {
+            auto &rec = recordings.emplace_back();
+            rec.ctx = ctx->cloneForRecording();
+            rec.ctx->setTransform(ctx->getTransform());
+            rec.rect = _setupPage(rec.ctx, doc, pages[i], stretch_to_fit);
+            rec.ctx->_width = rec.rect.width();
+            rec.ctx->_height = rec.rect.height();
+            rec.items = pages[i]->getOverlappingItems(false, true, false);
+            rec.concurrent = std::all_of(rec.items.begin(), rec.items.end(),
+                                         [&](SPItem *item) { return _canRenderConcurrently(ctx, item); });
+        }
+
+        // Pages which modify the object tree while being rendered go first, on this thread.
+        for (size_t i = first; i < last; i++) {
+            auto &rec = recordings[i - first];
+            if (!rec.concurrent) {
+                _prerenderBitmaps(rec.ctx, rec.items, pages[i]);
+                _renderPageItems(rec.ctx, rec.items, pages[i]);
+                _prerendered_bitmaps.clear();
+            }
+        }
+
+        Inkscape::Util::parallel_for(last - first, [&] (size_t i) {
+            auto &rec = recordings[i];
+            if (rec.concurrent) {
+                _renderPageItems(rec.ctx, rec.items, pages[first + i]);
+            }
+        });
+
+        for (size_t i = first; i < last; i++) {
+            auto &rec = recordings[i - first];
+            if (ret) {
+                ctx->pushState();
+                ctx->nextPage(rec.rect.width(), rec.rect.height(), pages[i]->label());
+
+                // The recording already contains the full transformation to output units.
+                cairo_save(ctx->_cr);
+                cairo_identity_matrix(ctx->_cr);
+                ctx->paintRecording(rec.ctx->getSurface());
+                cairo_restore(ctx->_cr);
+
+                // Create a page dest for any anchor tags that link to this page.
+                ctx->destBegin(pages[i]->getId());
+                ctx->destEnd();
+
+                if (!ctx->finishPage()) {
+                    g_warning("Couldn't render page in output!");
+                    ret = false;
+                }
+                ctx->popState();
+            }
+            destroyContext(rec.ctx);
+        }
+    }
+
+    pool.join();
+    return ret;
+}
+
 // Apply an SVG clip path
 void
 CairoRenderer::applyClipPath(CairoRenderContext *ctx, SPClipPath const *cp)
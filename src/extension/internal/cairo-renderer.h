@@ -16,19 +16,28 @@
  */
 
 #include "extension/extension.h"
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 //#include "libnrtype/font-instance.h"
 #include <cairo.h>
+#include <2geom/forward.h>
 
 class SPItem;
+class SPObject;
 class SPClipPath;
 class SPMask;
 class SPHatchPath;
 class SPPage;
+class SPUse;
 
 namespace Inkscape {
+class Pixbuf;
+
 namespace Extension {
 namespace Internal {
 
@@ -60,6 +69,13 @@ public:
     bool renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretch_to_fit);
     bool renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page, bool stretch_to_fit);
 
+    /** Renders the content of a clone by painting a recording shared by all clones of the same
+    source. Returns false if the clone can not be rendered this way. */
+    bool renderCloneRecording(CairoRenderContext *ctx, SPUse *use, SPPage *page);
+
+    /** Returns and forgets the bitmap of a filtered item rasterized ahead of rendering, if any. */
+    std::shared_ptr<Inkscape::Pixbuf> takePrerenderedBitmap(SPItem const *item, SPPage const *page);
+
 private:
     /** Extract metadata from doc and set it on ctx. */
     void setMetadata(CairoRenderContext *ctx, SPDocument *doc);
@@ -71,6 +87,30 @@ private:
     static void _doRender(SPItem *item, CairoRenderContext *ctx, SPItem *origin = nullptr,
                           SPPage *page = nullptr);
 
+    /** Apply the page transformation to ctx and return the rounded page rectangle. */
+    static Geom::Rect _setupPage(CairoRenderContext *ctx, SPDocument *doc, SPPage *page, bool stretch_to_fit);
+
+    /** Render the items of a page into a context set up by _setupPage(). */
+    void _renderPageItems(CairoRenderContext *ctx, std::vector<SPItem *> const &items, SPPage *page);
+
+    /** Decide whether an object can be rendered on a worker thread. */
+    static bool _canRenderConcurrently(CairoRenderContext *ctx, SPObject *object);
+
+    /** Record pages on worker threads and replay them into ctx in order. */
+    bool _renderPagesConcurrently(CairoRenderContext *ctx, SPDocument *doc, std::vector<SPPage *> const &pages,
+                                  bool stretch_to_fit);
+
+    /** Collect the items which will be rendered as bitmaps. */
+    static void _collectBitmapItems(CairoRenderContext *ctx, SPItem *item, std::vector<SPItem *> &items);
+
+    /** Rasterize the filtered items among the given items concurrently. */
+    void _prerenderBitmaps(CairoRenderContext *ctx, std::vector<SPItem *> const &items, SPPage *page);
+
+    std::map<std::pair<SPItem const *, SPPage const *>, std::shared_ptr<Inkscape::Pixbuf>> _prerendered_bitmaps;
+
+    /** Recording surfaces of clone contents, nullptr for sources which can't be reused. */
+    std::map<std::string, cairo_surface_t *> _clone_recordings;
+    std::mutex _clone_recordings_mutex;
 };
 
 // FIXME: this should be a static method of CairoRenderer
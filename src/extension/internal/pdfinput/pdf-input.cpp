@@ -45,21 +45,27 @@
 #include <gtkmm/drawingarea.h>
 #include <gtkmm/frame.h>
 #include <gtkmm/scale.h>
+#include <thread>
 #include <utility>
 
 #include "document-undo.h"
 #include "extension/input.h"
 #include "extension/system.h"
+#include "inkgc/gc-core.h"
 #include "inkscape.h"
 #include "object/sp-root.h"
 #include "pdf-parser.h"
+#include "preferences.h"
 #include "ui/builder-utils.h"
 #include "ui/dialog-events.h"
 #include "ui/dialog-run.h"
 #include "ui/widget/frame.h"
 #include "ui/widget/spinbutton.h"
+#include "util/parallel.h"
 #include "util/parse-int-range.h"
+#include "util/scope_exit.h"
 #include "util/units.h"
+#include "xml/repr.h"
 
 using namespace Inkscape::UI;
 
@@ -647,20 +653,41 @@ PdfInput::open(::Inkscape::Extension::Input * /*mod*/, const gchar * uri) {
         if (dot) {
             *dot = 0;
         }
-        SvgBuilder *builder = new SvgBuilder(doc, docname, pdf_doc->getXRef());
+        // When streaming, pages are built in a bare XML document and moved into
+        // the SPDocument one at a time, instead of updating objects per operator.
+        auto app_prefs = Inkscape::Preferences::get();
+        Inkscape::XML::Document *stream_doc = nullptr;
+        if (app_prefs->getBool("/options/pdfimport/streamPages", false)) {
+            stream_doc = sp_repr_document_new("svg:svg");
+        }
+        SvgBuilder *builder = stream_doc ? new SvgBuilder(stream_doc, docname, pdf_doc->getXRef())
+                                         : new SvgBuilder(doc, docname, pdf_doc->getXRef());
         builder->setFontStrategies(font_strats);
 
         // Get preferences
         Inkscape::XML::Node *prefs = builder->getPreferences();
         if (dlg)
             dlg->getImportSettings(prefs);
+        prefs->setAttributeBoolean("coalescePaths", app_prefs->getBool("/options/pdfimport/coalescePaths", false));
 
-        for (auto p : pages) {
-            // And then add each of the pages
-            add_builder_page(pdf_doc, builder, doc, p);
+        // Pages with layers share them, so those can only be imported in order.
+        auto ocgs = pdf_doc->getCatalog()->getOptContentConfig();
+        if (pages.size() > 1 && !(ocgs && ocgs->hasOCGs()) &&
+            app_prefs->getBool("/options/pdfimport/parallelPages", false)) {
+            add_builder_pages_concurrently(uri, pages, builder, font_strats, docname, doc);
+        } else {
+            for (auto p : pages) {
+                // And then add each of the pages
+                add_builder_page(pdf_doc, builder, doc, p);
+                builder->flushPages(doc);
+            }
+            builder->flushPages(doc, true);
         }
 
         delete builder;
+        if (stream_doc) {
+            Inkscape::GC::release(stream_doc);
+        }
         g_free(docname);
 #ifdef HAVE_POPPLER_CAIRO
     } else if (import_method == PdfImportType::PDF_IMPORT_CAIRO) {
@@ -809,6 +836,83 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
     delete pdf_parser;
 }
 
+/**
+ * Import each page on a worker thread, with its own PDFDoc, parser and detached
+ * builder, then merge the pages into the document in order on this thread.
+ *
+ * Generated ids carry the page number, so the result doesn't depend on which
+ * page finished first.
+ */
+void
+PdfInput::add_builder_pages_concurrently(gchar const *uri, std::set<int> const &pages, SvgBuilder *builder,
+                                         FontStrategies const &font_strats, gchar *docname, SPDocument *doc)
+{
+    std::vector<std::pair<std::string, std::string>> settings;
+    for (auto const &attr : builder->getPreferences()->attributeList()) {
+        settings.emplace_back(g_quark_to_string(attr.key), std::string(attr.value));
+    }
+
+    // Make sure lazily created shared state exists before the workers start.
+    sp_repr_css_attr_unref(sp_repr_css_attr_new());
+    Inkscape::GC::Core::allow_register_threads();
+
+    struct PageImport
+    {
+        std::shared_ptr<PDFDoc> pdf_doc;
+        Inkscape::XML::Document *xml_doc = nullptr;
+        std::unique_ptr<SvgBuilder> builder;
+    };
+    auto const caller = std::this_thread::get_id();
+    auto import_page = [&, uri = std::string(uri)](int page_num) {
+        // Pool threads are registered for the duration of the job; this thread already is.
+        bool const worker = std::this_thread::get_id() != caller;
+        if (worker) {
+            Inkscape::GC::Core::register_thread();
+        }
+        auto unregister = scope_exit([worker] {
+            if (worker) {
+                Inkscape::GC::Core::unregister_thread();
+            }
+        });
+        PageImport result;
+        result.pdf_doc = _POPPLER_MAKE_SHARED_PDFDOC(uri.c_str());
+        if (result.pdf_doc->isOk()) {
+            // The document stays anchored until it's merged, the collector can't lose it.
+            result.xml_doc = sp_repr_document_new("svg:svg");
+            result.builder = std::make_unique<SvgBuilder>(result.xml_doc, docname, result.pdf_doc->getXRef());
+            result.builder->setFontStrategies(font_strats);
+            result.builder->setIdPrefix("page" + std::to_string(page_num) + "-");
+            auto prefs = result.builder->getPreferences();
+            for (auto const &[key, value] : settings) {
+                prefs->setAttribute(key, value);
+            }
+            add_builder_page(result.pdf_doc, result.builder.get(), nullptr, page_num);
+        }
+        return result;
+    };
+
+    auto const page_nums = std::vector<int>(pages.begin(), pages.end());
+    std::vector<PageImport> imports(page_nums.size());
+    Inkscape::Util::parallel_for(page_nums.size(), [&] (std::size_t i) {
+        imports[i] = import_page(page_nums[i]);
+    });
+
+    double page_left = 0.0;
+    bool first = true;
+    for (auto &result : imports) {
+        if (result.builder) {
+            page_left = result.builder->mergePages(doc, page_left, first);
+            first = false;
+        } else {
+            g_warning("PDF page couldn't be imported.");
+        }
+        result.builder.reset();
+        if (result.xml_doc) {
+            Inkscape::GC::release(result.xml_doc);
+        }
+    }
+}
+
 #include "../clear-n_.h"
 
 void PdfInput::init() {
@@ -18,6 +18,7 @@
 #ifdef HAVE_POPPLER
 #include <gtkmm.h>
 #include <gtkmm/dialog.h>
+#include <set>
 
 #include "../../implementation/implementation.h"
 #include "poppler-transition-api.h"
@@ -136,6 +137,10 @@ private:
         std::shared_ptr<PDFDoc> pdf_doc,
         SvgBuilder *builder, SPDocument *doc,
         int page_num);
+    void add_builder_pages_concurrently(
+        gchar const *uri, std::set<int> const &pages,
+        SvgBuilder *builder, FontStrategies const &font_strats,
+        gchar *docname, SPDocument *doc);
 };
 
 } // namespace Implementation
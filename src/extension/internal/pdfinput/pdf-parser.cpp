@@ -25,6 +25,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 
 #include "2geom/transforms.h"
 #include "Annot.h"
@@ -2132,7 +2133,13 @@ void PdfParser::opTextNextLine(Object /*args*/[], int /*numArgs*/)
 void PdfParser::doUpdateFont()
 {
     if (fontChanged) {
-        auto font = getFontEngine()->getFont(state->getFont(), _pdf_doc.get(), true, xref);
+        std::shared_ptr<CairoFont> font;
+        {
+            // Every font engine shares the one FreeType library, pages may be imported concurrently.
+            static std::mutex ft_lib_mutex;
+            auto lock = std::scoped_lock(ft_lib_mutex);
+            font = getFontEngine()->getFont(state->getFont(), _pdf_doc.get(), true, xref);
+        }
         builder->updateFont(state, font, !subPage);
         fontChanged = false;
     }
@@ -16,9 +16,11 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <atomic>
 #include <string> 
 #include <locale>
 #include <codecvt>
+#include <mutex>
 
 #ifdef HAVE_POPPLER
 #define USE_CMS
@@ -75,6 +77,7 @@ namespace Internal {
 SvgBuilder::SvgBuilder(SPDocument *document, gchar *docname, XRef *xref)
 {
     _is_top_level = true;
+    _top = this;
     _doc = document;
     _docname = docname;
     _xref = xref;
@@ -89,6 +92,7 @@ SvgBuilder::SvgBuilder(SPDocument *document, gchar *docname, XRef *xref)
 
 SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
     _is_top_level = false;
+    _top = parent->_top;
     _doc = parent->_doc;
     _docname = parent->_docname;
     _xref = parent->_xref;
@@ -98,6 +102,27 @@ SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
     _init();
 }
 
+/**
+ * Build into a bare XML document which has no SPDocument attached to it.
+ *
+ * No SPObjects are constructed while the PDF operators are interpreted, the
+ * finished pages are moved into the real document with flushPages().
+ */
+SvgBuilder::SvgBuilder(Inkscape::XML::Document *xml_doc, gchar *docname, XRef *xref)
+{
+    _is_top_level = true;
+    _top = this;
+    _doc = nullptr;
+    _docname = docname;
+    _xref = xref;
+    _xml_doc = xml_doc;
+    _container = _root = xml_doc->root();
+    _init();
+
+    _preferences = _xml_doc->createElement("svgbuilder:prefs");
+    _preferences->setAttribute("embedImages", "1");
+}
+
 SvgBuilder::~SvgBuilder()
 {
     if (_clip_history) {
@@ -159,8 +184,7 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
     if (!label.empty()) {
         _page->setAttribute("inkscape:label", label);
     }
-    auto _nv = _doc->getNamedView()->getRepr();
-    _nv->appendChild(_page);
+    _getNamedView()->appendChild(_page);
 
     // No OptionalContentGroups means no layers, so make a default layer for this page.
     if (_ocgs.empty()) {
@@ -342,6 +366,200 @@ void SvgBuilder::_addToContainer(Inkscape::XML::Node *node, bool release)
     }
 }
 
+/**
+ * Return the defs node of the document being built.
+ */
+Inkscape::XML::Node *SvgBuilder::_getDefs()
+{
+    if (_doc) {
+        return _doc->getDefs()->getRepr();
+    }
+    auto root = _top->_root;
+    auto defs = sp_repr_lookup_name(root, "svg:defs", 1);
+    if (!defs) {
+        defs = _xml_doc->createElement("svg:defs");
+        root->addChild(defs, nullptr);
+        Inkscape::GC::release(defs);
+    }
+    return defs;
+}
+
+/**
+ * Return the namedview node of the document being built.
+ */
+Inkscape::XML::Node *SvgBuilder::_getNamedView()
+{
+    if (_doc) {
+        return _doc->getNamedView()->getRepr();
+    }
+    auto root = _top->_root;
+    auto nv = sp_repr_lookup_name(root, "sodipodi:namedview", 1);
+    if (!nv) {
+        nv = _xml_doc->createElement("sodipodi:namedview");
+        root->addChild(nv, _getDefs());
+        Inkscape::GC::release(nv);
+    }
+    return nv;
+}
+
+/**
+ * Append the node to the document's defs. When building a detached document
+ * there is no SPObject to hand out an id, so one is generated here.
+ */
+void SvgBuilder::_addToDefs(Inkscape::XML::Node *node)
+{
+    if (!_doc && !node->attribute("id")) {
+        std::string name = node->name();
+        auto colon = name.find(':');
+        if (colon != std::string::npos) {
+            name = name.substr(colon + 1);
+        }
+        node->setAttribute("id", _top->_id_prefix + name + std::to_string(++_top->_detached_ids));
+    }
+    _getDefs()->appendChild(node);
+    _registerId(node);
+}
+
+/**
+ * Remember a defs item or layer of a detached document by its id, for _getNodeById().
+ */
+void SvgBuilder::_registerId(Inkscape::XML::Node *node)
+{
+    if (!_doc) {
+        if (auto id = node->attribute("id")) {
+            _top->_nodes_by_id[id] = node;
+        }
+    }
+}
+
+/**
+ * Remove a defs item from the document, and forget its id.
+ */
+void SvgBuilder::_removeFromDefs(Inkscape::XML::Node *node)
+{
+    if (!_doc) {
+        if (auto id = node->attribute("id")) {
+            _top->_nodes_by_id.erase(id);
+        }
+    }
+    node->parent()->removeChild(node);
+}
+
+/**
+ * Find a previously created defs item or layer by its id.
+ */
+Inkscape::XML::Node *SvgBuilder::_getNodeById(std::string const &id)
+{
+    if (_doc) {
+        if (auto obj = _doc->getObjectById(id)) {
+            return obj->getRepr();
+        }
+        return nullptr;
+    }
+    // Only defs items and layers are ever looked up, which are registered as they are created.
+    auto it = _top->_nodes_by_id.find(id);
+    return it != _top->_nodes_by_id.end() ? it->second : nullptr;
+}
+
+/**
+ * Move everything built so far from the detached XML document into the target document.
+ *
+ * Optional content groups may receive more content from later pages, so when the PDF
+ * has layers nothing is moved until the final call.
+ *
+ * \param finish Whether no more pages will be added.
+ * \return true if the content was moved.
+ */
+bool SvgBuilder::flushPages(SPDocument *target, bool finish)
+{
+    if (_doc || (!_ocgs.empty() && !finish)) {
+        return false;
+    }
+    _moveInto(target, 0.0, true);
+    return true;
+}
+
+/**
+ * Move the pages of a builder which imported them on its own into the target
+ * document, placing them at the given horizontal offset.
+ *
+ * The page's layers are translated as a whole, their content is left as it was built.
+ *
+ * \param page_left Where the first page of this builder starts in the target.
+ * \param set_size Whether the document size should be taken from these pages.
+ * \return The horizontal offset for the next page.
+ */
+double SvgBuilder::mergePages(SPDocument *target, double page_left, bool set_size)
+{
+    if (_doc) {
+        return page_left;
+    }
+    _moveInto(target, page_left, set_size);
+    return _width ? page_left + _page_left + _width + 20 : page_left + _page_left;
+}
+
+void SvgBuilder::_moveInto(SPDocument *target, double page_left, bool set_size)
+{
+    while (_container != _root) {
+        _popGroup();
+    }
+
+    auto target_root = target->getReprRoot();
+    auto target_doc = target->getReprDoc();
+    if (set_size) {
+        for (auto attr : {"width", "height"}) {
+            if (auto value = _root->attribute(attr)) {
+                target_root->setAttribute(attr, value);
+            }
+        }
+    }
+
+    // Defs go first, so content referencing them is built against existing objects.
+    auto move_children = [target_doc](Inkscape::XML::Node *from, Inkscape::XML::Node *to,
+                                      Inkscape::XML::Node const *skip1 = nullptr,
+                                      Inkscape::XML::Node const *skip2 = nullptr) {
+        std::vector<Inkscape::XML::Node *> children;
+        for (auto child = from->firstChild(); child; child = child->next()) {
+            if (child != skip1 && child != skip2) {
+                children.push_back(child);
+            }
+        }
+        for (auto child : children) {
+            // Colour profiles are referenced by name, one copy per document is enough.
+            if (!strcmp(child->name(), "svg:color-profile") && child->attribute("name") &&
+                sp_repr_lookup_child(to, "name", child->attribute("name"))) {
+                from->removeChild(child);
+                continue;
+            }
+            auto copy = child->duplicate(target_doc);
+            to->appendChild(copy);
+            Inkscape::GC::release(copy);
+            from->removeChild(child);
+        }
+    };
+    auto defs = _getDefs();
+    auto nv = _getNamedView();
+    if (page_left != 0.0) {
+        for (auto page = nv->firstChild(); page; page = page->next()) {
+            page->setAttributeSvgDouble("x", page->getAttributeDouble("x", 0.0) + page_left);
+        }
+        for (auto child = _root->firstChild(); child; child = child->next()) {
+            if (child != defs && child != nv && child->type() == Inkscape::XML::NodeType::ELEMENT_NODE) {
+                auto tr = Geom::identity();
+                if (auto attr = child->attribute("transform")) {
+                    sp_svg_transform_read(attr, &tr);
+                }
+                // A clip-path on the layer moves along with it, being in its user space.
+                child->setAttributeOrRemoveIfEmpty("transform", sp_svg_transform_write(tr * Geom::Translate(page_left, 0.0)));
+            }
+        }
+    }
+    move_children(defs, target->getDefs()->getRepr());
+    move_children(nv, target->getNamedView()->getRepr());
+    move_children(_root, target_root, defs, nv);
+    _nodes_by_id.clear(); // the nodes now belong to the target
+}
+
 void SvgBuilder::_setClipPath(Inkscape::XML::Node *node)
 {
     if (_clip_history->hasClipPath() || _clip_text) {
@@ -374,15 +592,15 @@ Inkscape::XML::Node *SvgBuilder::_popGroup()
     return _container;
 }
 
-static gchar *svgConvertRGBToText(double r, double g, double b) {
+static std::string svgConvertRGBToText(double r, double g, double b) {
     using Inkscape::Filters::clamp;
-    static gchar tmp[1023] = {0};
-    snprintf(tmp, 1023,
+    gchar tmp[8] = {0};
+    snprintf(tmp, 8,
              "#%02x%02x%02x",
              clamp(SP_COLOR_F_TO_U(r)),
              clamp(SP_COLOR_F_TO_U(g)),
              clamp(SP_COLOR_F_TO_U(b)));
-    return (gchar *)&tmp;
+    return tmp;
 }
 
 static std::string svgConvertGfxRGB(GfxRGB *color)
@@ -695,7 +913,8 @@ void SvgBuilder::addPath(GfxState *state, bool fill, bool stroke, bool even_odd)
         return;
     }
 
-    Inkscape::XML::Node *path = _addToContainer("svg:path");
+    // The path is completed before it's appended, so it can be coalesced with the previous one.
+    Inkscape::XML::Node *path = _xml_doc->createElement("svg:path");
     path->setAttribute("d", pathtext);
     g_free(pathtext);
 
@@ -706,6 +925,54 @@ void SvgBuilder::addPath(GfxState *state, bool fill, bool stroke, bool even_odd)
     _setBlendMode(path, state);
     _setTransform(path, state);
     _setClipPath(path);
+
+    if (coalescePath(path)) {
+        Inkscape::GC::release(path);
+        return;
+    }
+    _addToContainer(path);
+}
+
+/**
+ * Append the path data of the given, not yet added, path to the previously added path
+ * when both are painted identically. PDF generators often emit long runs of single
+ * line segments with the same stroke, which are a lot cheaper as one object.
+ *
+ * Only opaque, unfilled strokes are coalesced; overlapping subpaths then render the
+ * same as the separate paths did.
+ */
+bool SvgBuilder::coalescePath(Inkscape::XML::Node *path)
+{
+    if (!_preferences->getAttributeBoolean("coalescePaths", false))
+        return false;
+
+    auto prev = _container->lastChild();
+    if (!prev || !prev->name() || std::string("svg:path") != prev->name())
+        return false;
+    if (prev->attribute("mask") || path->attribute("mask"))
+        return false;
+    for (auto attr : {"style", "transform", "clip-path"}) {
+        auto a = prev->attribute(attr);
+        auto b = path->attribute(attr);
+        if ((a || b) && (!a || !b || strcmp(a, b) != 0))
+            return false;
+    }
+
+    auto css = sp_repr_css_attr(path, "style");
+    std::string fill = sp_repr_css_property(css, "fill", "");
+    std::string stroke = sp_repr_css_property(css, "stroke", "none");
+    std::string opacity = sp_repr_css_property(css, "stroke-opacity", "1");
+    bool blend = sp_repr_css_property(css, "mix-blend-mode", nullptr) != nullptr;
+    sp_repr_css_attr_unref(css);
+    if (fill != "none" || stroke == "none" || stroke.find("url(") != std::string::npos || opacity != "1" || blend)
+        return false;
+
+    auto prev_d = prev->attribute("d");
+    auto d = path->attribute("d");
+    if (!prev_d || !d)
+        return false;
+    prev->setAttribute("d", std::string(prev_d) + " " + d);
+    return true;
 }
 
 void SvgBuilder::addClippedFill(GfxShading *shading, const Geom::Affine shading_tr)
@@ -836,7 +1103,7 @@ Inkscape::XML::Node *SvgBuilder::_createClip(const std::string &d, const Geom::A
     Inkscape::GC::release(path);
 
     // Append clipPath to defs and get id
-    _doc->getDefs()->getRepr()->appendChild(clip_path);
+    _addToDefs(clip_path);
     Inkscape::GC::release(clip_path);
     return clip_path;
 }
@@ -845,9 +1112,9 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
 {
     if (name && group && std::string(name) == "OC") {
         auto layer_id = std::string("layer-") + group;
-        if (auto existing = _doc->getObjectById(layer_id)) {
-            if (existing->getRepr()->parent() == _container) {
-                _container = existing->getRepr();
+        if (auto existing = _getNodeById(layer_id)) {
+            if (existing->parent() == _container) {
+                _container = existing;
                 _node_stack.push_back(_container);
             } else {
                 g_warning("Unexpected marked content group in PDF!");
@@ -856,6 +1123,7 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
         } else {
             auto node = _pushGroup();
             node->setAttribute("id", layer_id);
+            _registerId(node);
             if (_ocgs.find(group) != _ocgs.end()) {
                 auto pair = _ocgs[group];
                 setAsLayer(pair.first.c_str(), pair.second);
@@ -903,9 +1171,15 @@ std::string SvgBuilder::_getColorProfile(cmsHPROFILE hp)
 
     std::string name = get_color_profile_name(hp);
 
-    // Find the named profile in the document (if already added)
-    if (_doc->getProfileManager().find(name.c_str()))
+    // Poppler hands out a new profile handle for each colour space, so look for the name too.
+    // Pages built in a detached document are moved out as they finish, so the profile may no
+    // longer be in its defs, but it has been added once already.
+    if (_icc_profile_names.count(name) ||
+        (_doc ? _doc->getProfileManager().find(name.c_str()) != nullptr
+              : sp_repr_lookup_child(_getDefs(), "name", name.c_str()) != nullptr)) {
+        _icc_profiles[hp] = name;
         return name;
+    }
 
     // Add the profile, we've never seen it before.
     cmsUInt32Number len = 0;
@@ -921,11 +1195,12 @@ std::string SvgBuilder::_getColorProfile(cmsHPROFILE hp)
     auto icc_data = std::string("data:application/vnd.iccprofile;base64,") + base64String;
     g_free(base64String);
     icc_node->setAttributeOrRemoveIfEmpty("xlink:href", icc_data);
-    _doc->getDefs()->getRepr()->appendChild(icc_node);
+    _addToDefs(icc_node);
     Inkscape::GC::release(icc_node);
 
     free(buf);
     _icc_profiles[hp] = name;
+    _icc_profile_names.insert(name);
     return name;
 }
 
@@ -1034,7 +1309,7 @@ gchar *SvgBuilder::_createTilingPattern(GfxTilingPattern *tiling_pattern,
     delete pattern_builder;
 
     // Append the pattern to defs
-    _doc->getDefs()->getRepr()->appendChild(pattern_node);
+    _addToDefs(pattern_node);
     gchar *id = g_strdup(pattern_node->attribute("id"));
     Inkscape::GC::release(pattern_node);
 
@@ -1101,7 +1376,7 @@ gchar *SvgBuilder::_createGradient(GfxShading *shading, const Geom::Affine pat_m
         return nullptr;
     }
 
-    _doc->getDefs()->getRepr()->appendChild(gradient);
+    _addToDefs(gradient);
     gchar *id = g_strdup(gradient->attribute("id"));
     Inkscape::GC::release(gradient);
 
@@ -1260,6 +1535,10 @@ void SvgBuilder::updateFont(GfxState *state, std::shared_ptr<CairoFont> cairo_fo
         return;
     }
 
+    // The FontFactory is shared by pages which are imported concurrently.
+    static std::mutex font_factory_mutex;
+    auto lock = std::unique_lock(font_factory_mutex);
+
     auto font_data = FontData(font);
     _font_specification = font_data.getSpecification().c_str();
     _invalidated_strategy = (bool)_cairo_font;
@@ -1276,6 +1555,7 @@ void SvgBuilder::updateFont(GfxState *state, std::shared_ptr<CairoFont> cairo_fo
         auto keep_name = font_data.family.size() ? font_data.family : font_data.name;
         sp_repr_css_set_property(_css_font, "font-family", keep_name.c_str());
     }
+    lock.unlock();
 
     // Set the font data
     sp_repr_css_set_property(_css_font, "font-style", font_data.style.c_str());
@@ -1334,10 +1614,9 @@ void SvgBuilder::_flushText(GfxState *state)
 {
     // Set up a clipPath group
     if (state->getRender() & 4 && !_clip_text_group) {
-        auto defs = _doc->getDefs()->getRepr();
         _clip_text_group = _pushContainer("svg:clipPath");
         _clip_text_group->setAttribute("clipPathUnits", "userSpaceOnUse");
-        defs->appendChild(_clip_text_group);
+        _addToDefs(_clip_text_group);
         Inkscape::GC::release(_clip_text_group);
     }
 
@@ -1668,7 +1947,7 @@ void SvgBuilder::addChar(GfxState *state, double x, double y, double dx, double
     }
     _aria_space = false;
 
-    static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
+    static thread_local std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
     if (u) {
         _aria_label += conv1.to_bytes(*u);
     }
@@ -1818,8 +2097,10 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     if (embed_image) {
         png_set_write_fn(png_ptr, &png_buffer, png_write_vector, nullptr);
     } else {
-        static int counter = 0;
-        file_name = g_strdup_printf("%s_img%d.png", _docname, counter++);
+        static std::atomic<int> counter{0};
+        // Pages imported concurrently number their images by page instead.
+        int index = _top->_id_prefix.empty() ? counter++ : _top->_image_count++;
+        file_name = g_strdup_printf("%s_%simg%d.png", _docname, _top->_id_prefix.c_str(), index);
         fp = fopen(file_name, "wb");
         if ( fp == nullptr ) {
             png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -1997,15 +2278,17 @@ Inkscape::XML::Node *SvgBuilder::_createMask(double width, double height) {
     mask_node->setAttributeSvgDouble("height", height);
     // Append mask to defs
     if (_is_top_level) {
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        _addToDefs(mask_node);
         Inkscape::GC::release(mask_node);
-        return _doc->getDefs()->getRepr()->lastChild();
+        return _getDefs()->lastChild();
     } else {    // Work around for renderer bug when mask isn't defined in pattern
-        static int mask_count = 0;
-        gchar *mask_id = g_strdup_printf("_mask%d", mask_count++);
-        mask_node->setAttribute("id", mask_id);
-        g_free(mask_id);
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        if (_doc) {
+            static int mask_count = 0;
+            gchar *mask_id = g_strdup_printf("_mask%d", mask_count++);
+            mask_node->setAttribute("id", mask_id);
+            g_free(mask_id);
+        }
+        _addToDefs(mask_node);
         Inkscape::GC::release(mask_node);
         return mask_node;
     }
@@ -2128,9 +2411,7 @@ Inkscape::XML::Node *SvgBuilder::_getGradientNode(Inkscape::XML::Node *node, boo
 {
     auto css = sp_repr_css_attr(node, "style");
     if (auto id = try_extract_uri_id(css->attribute(is_fill ? "fill" : "stroke"))) {
-        if (auto obj = _doc->getObjectById(*id)) {
-            return obj->getRepr();
-        }
+        return _getNodeById(*id);
     }
     return nullptr;
 }
@@ -2176,8 +2457,8 @@ void SvgBuilder::applyOptionalMask(Inkscape::XML::Node *mask, Inkscape::XML::Nod
                     target_st = target_st->next();
                 }
                 // Remove mask and gradient xml objects
-                mask->parent()->removeChild(mask);
-                source_gr->parent()->removeChild(source_gr);
+                _removeFromDefs(mask);
+                _removeFromDefs(source_gr);
                 return;
             }
         }
@@ -2243,8 +2524,8 @@ void SvgBuilder::popGroup(GfxState *state)
             child->setAttributeSvgDouble("opacity", orig * grp);
 
             if (auto mask_id = try_extract_uri_id(parent->attribute("mask"))) {
-                if (auto obj = _doc->getObjectById(*mask_id)) {
-                    applyOptionalMask(obj->getRepr(), child);
+                if (auto mask = _getNodeById(*mask_id)) {
+                    applyOptionalMask(mask, child);
                 }
             }
             if (auto clip = parent->attribute("clip-path")) {
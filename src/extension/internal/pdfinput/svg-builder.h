@@ -61,6 +61,9 @@ class ClipHistoryEntry;
 #include <glib.h>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Inkscape {
@@ -96,8 +99,13 @@ class SvgBuilder {
 public:
     SvgBuilder(SPDocument *document, gchar *docname, XRef *xref);
     SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root);
+    SvgBuilder(Inkscape::XML::Document *xml_doc, gchar *docname, XRef *xref);
     virtual ~SvgBuilder();
 
+    bool flushPages(SPDocument *target, bool finish = false);
+    double mergePages(SPDocument *target, double page_left, bool set_size);
+    void setIdPrefix(std::string prefix) { _id_prefix = std::move(prefix); }
+
     // Property setting
     void setDocumentSize(double width, double height);  // Document size in px
     void setMargins(const Geom::Rect &page, const Geom::Rect &margins, const Geom::Rect &bleed);
@@ -112,6 +120,7 @@ public:
     // Path adding
     bool shouldMergePath(bool is_fill, const std::string &path);
     bool mergePath(GfxState *state, bool is_fill, const std::string &path, bool even_odd = false);
+    bool coalescePath(Inkscape::XML::Node *path);
     void addPath(GfxState *state, bool fill, bool stroke, bool even_odd=false);
     void addClippedFill(GfxShading *shading, const Geom::Affine shading_tr);
     void addShadedFill(GfxShading *shading, const Geom::Affine shading_tr, GfxPath *path, const Geom::Affine tr,
@@ -223,6 +232,13 @@ private:
     void _addToContainer(Inkscape::XML::Node *node, bool release = true);
 
     Inkscape::XML::Node *_getGradientNode(Inkscape::XML::Node *node, bool is_fill);
+    Inkscape::XML::Node *_getNodeById(std::string const &id);
+    Inkscape::XML::Node *_getDefs();
+    Inkscape::XML::Node *_getNamedView();
+    void _addToDefs(Inkscape::XML::Node *node);
+    void _removeFromDefs(Inkscape::XML::Node *node);
+    void _registerId(Inkscape::XML::Node *node);
+    void _moveInto(SPDocument *target, double page_left, bool set_size);
     static bool _attrEqual(Inkscape::XML::Node *a, Inkscape::XML::Node *b, char const *attr);
 
     // Colors
@@ -248,7 +264,12 @@ private:
     bool _for_softmask = false;
 
     bool _is_top_level;  // Whether this SvgBuilder is the top-level one
-    SPDocument *_doc;
+    SvgBuilder *_top;    // The top-level SvgBuilder, this one if _is_top_level
+    SPDocument *_doc;    // Target document, nullptr when building a detached XML document
+    unsigned _detached_ids = 0; // Last id generated for detached defs
+    std::unordered_map<std::string, Inkscape::XML::Node *> _nodes_by_id; // Defs items and layers of a detached document
+    std::string _id_prefix;     // Prepended to generated ids, keeps pages built apart unique
+    int _image_count = 0;       // Images written to files when _id_prefix is set
     gchar *_docname;    // Basename of the URI from which this document is created
     XRef *_xref;    // Cross-reference table from the PDF doc we're converting from
     Inkscape::XML::Document *_xml_doc;
@@ -269,6 +290,7 @@ private:
 
     std::string _icc_profile;
     std::map<cmsHPROFILE, std::string> _icc_profiles;
+    std::set<std::string> _icc_profile_names; ///< Profiles added by this import
 
     ClipHistoryEntry *_clip_history; // clip path stack
     Inkscape::XML::Node *_clip_text = nullptr;
@@ -15,11 +15,42 @@
 
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <2geom/forward.h>
 
 class SPDocument;
 class SPItem;
-namespace Inkscape { class Pixbuf; }
+namespace Inkscape {
+class Drawing;
+class Pixbuf;
+}
+
+/**
+ * Offscreen rendering of document items in two steps. Constructing and destroying the
+ * renderer shows and hides the document and must happen on the main thread, while
+ * render() only touches the private drawing and may be called from any thread.
+ */
+class InternalBitmapRenderer
+{
+public:
+    InternalBitmapRenderer(SPDocument *document,
+                           Geom::Rect const &area,
+                           double dpi,
+                           std::vector<SPItem *> const &items = {},
+                           bool opaque = false);
+    ~InternalBitmapRenderer();
+    InternalBitmapRenderer(InternalBitmapRenderer const &) = delete;
+    InternalBitmapRenderer &operator=(InternalBitmapRenderer const &) = delete;
+
+    Inkscape::Pixbuf *render(uint32_t const *checkerboard_color = nullptr, double device_scale = 1.0) const;
+
+private:
+    SPDocument *_document;
+    std::unique_ptr<Inkscape::Drawing> _drawing;
+    unsigned _dkey = 0;
+    int _width = 0;
+    int _height = 0;
+};
 
 Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
                                               Geom::Rect const &area,
@@ -199,6 +199,8 @@ SPObject *get_stock_item(gchar const *urn, bool stock, SPDocument* stock_doc)
             g_free(base);
             return nullptr;
         }
+        doc->buildDeferred(defs);
+
         SPObject *object = nullptr;
         if (!strcmp(base, "marker") && !stock) {
             for (auto& child: defs->children)
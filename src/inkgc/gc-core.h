@@ -57,6 +57,9 @@ struct Ops {
     void (*enable)();
     void (*disable)();
     void (*free)(void *ptr);
+    void (*allow_register_threads)();
+    void (*register_thread)();
+    void (*unregister_thread)();
 };
 
 struct Core {
@@ -112,6 +115,17 @@ public:
     static inline void free(void *ptr) {
         return _ops.free(ptr);
     }
+    /// Must be called from the main thread before any register_thread().
+    static inline void allow_register_threads() {
+        _ops.allow_register_threads();
+    }
+    /// Lets the calling thread allocate managed memory and have its stack scanned.
+    static inline void register_thread() {
+        _ops.register_thread();
+    }
+    static inline void unregister_thread() {
+        _ops.unregister_thread();
+    }
 private:
     static Ops _ops;
 };
@@ -80,6 +80,17 @@ int debug_general_register_disappearing_link(void **p_ptr, void const *base) {
 #endif
 }
 
+void do_register_thread() {
+    GC_stack_base base;
+    if (GC_get_stack_base(&base) == GC_SUCCESS) {
+        GC_register_my_thread(&base);
+    }
+}
+
+void do_unregister_thread() {
+    GC_unregister_my_thread();
+}
+
 void dummy_do_init() {}
 
 void *dummy_base(void *) { return nullptr; }
@@ -109,6 +120,8 @@ void dummy_enable() {}
 
 void dummy_disable() {}
 
+void dummy_thread() {}
+
 Ops enabled_ops = {
     &do_init,
     &GC_malloc,
@@ -128,7 +141,10 @@ Ops enabled_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_free
+    &GC_free,
+    &GC_allow_register_threads,
+    &do_register_thread,
+    &do_unregister_thread
 };
 
 Ops debug_ops = {
@@ -146,7 +162,10 @@ Ops debug_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_debug_free
+    &GC_debug_free,
+    &GC_allow_register_threads,
+    &do_register_thread,
+    &do_unregister_thread
 };
 
 Ops disabled_ops = {
@@ -164,7 +183,10 @@ Ops disabled_ops = {
     &dummy_gcollect,
     &dummy_enable,
     &dummy_disable,
-    &std::free
+    &std::free,
+    &dummy_thread,
+    &dummy_thread,
+    &dummy_thread
 };
 
 class InvalidGCModeError : public std::runtime_error {
@@ -247,6 +269,10 @@ void stub_free(void *) {
     die_because_not_initialized();
 }
 
+void stub_thread() {
+    die_because_not_initialized();
+}
+
 }
 
 Ops Core::_ops = {
@@ -264,7 +290,10 @@ Ops Core::_ops = {
     &stub_gcollect,
     &stub_enable,
     &stub_disable,
-    &stub_free
+    &stub_free,
+    &stub_thread,
+    &stub_thread,
+    &stub_thread
 };
 
 void Core::init() {
@@ -72,6 +72,7 @@
 
 #include "inkgc/gc-core.h"          // Garbage Collecting init
 #include "debug/logger.h"           // INKSCAPE_DEBUG_LOG support
+#include "debug/trace.h"            // INKSCAPE_TRACE support
 
 #include "extension/init.h"
 #include "extension/db.h"
@@ -674,6 +675,9 @@ InkscapeApplication::InkscapeApplication()
     Inkscape::Debug::Logger::init();
 #endif
 
+    // Use environment variable INKSCAPE_TRACE=trace.json for render timings
+    Inkscape::Debug::Trace::init();
+
 #ifdef ENABLE_NLS
     // Native Language Support (shouldn't this always be used?).
     Inkscape::initialize_gettext();
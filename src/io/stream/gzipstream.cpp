@@ -17,6 +17,7 @@
  */
 
 #include "gzipstream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -31,7 +32,11 @@ namespace IO
 //# G Z I P    I N P U T    S T R E A M
 //#########################################################################
 
-#define OUT_SIZE 4000
+// Inflate in large blocks, so that bulk readers cost few inflate() calls
+#define OUT_SIZE (4 << 20)
+
+// Compressed input is read from the source stream in blocks of this size
+#define IN_CHUNK (1 << 20)
 
 /**
  *
@@ -40,7 +45,6 @@ GzipInputStream::GzipInputStream(InputStream &sourceStream)
                     : BasicInputStream(sourceStream),
                       loaded(false),
                       outputBuf(nullptr),
-                      srcBuf(nullptr),
                       crc(0),
                       srcCrc(0),
                       srcSiz(0),
@@ -57,10 +61,6 @@ GzipInputStream::GzipInputStream(InputStream &sourceStream)
 GzipInputStream::~GzipInputStream()
 {
     close();
-    if ( srcBuf ) {
-      delete[] srcBuf;
-      srcBuf = nullptr;
-    }
     if ( outputBuf ) {
         delete[] outputBuf;
         outputBuf = nullptr;
@@ -94,10 +94,7 @@ void GzipInputStream::close()
         printf("inflateEnd: Some kind of problem: %d\n", zerr);
     }
 
-    if ( srcBuf ) {
-      delete[] srcBuf;
-      srcBuf = nullptr;
-    }
+    srcBuf = {};
     if ( outputBuf ) {
         delete[] outputBuf;
         outputBuf = nullptr;
@@ -132,6 +129,36 @@ int GzipInputStream::get()
     return ch;
 }
 
+/**
+ * Reads up to len bytes of inflated data, copying whole blocks at a time.  0 if EOF
+ */
+int GzipInputStream::read(unsigned char *buffer, int len)
+{
+    if (closed) {
+        return 0;
+    }
+    if (!loaded && !load()) {
+        closed = true;
+        return 0;
+    }
+    loaded = true;
+
+    int got = 0;
+    while (got < len) {
+        if (outputBufPos >= outputBufLen) {
+            int zerr = fetchMore();
+            if (outputBufLen == 0 || (zerr != Z_OK && zerr != Z_STREAM_END)) {
+                break;
+            }
+        }
+        long some = std::min<long>(len - got, outputBufLen - outputBufPos);
+        memcpy(buffer + got, outputBuf + outputBufPos, some);
+        outputBufPos += some;
+        got += some;
+    }
+    return got;
+}
+
 #define FTEXT 0x01
 #define FHCRC 0x02
 #define FEXTRA 0x04
@@ -142,42 +169,31 @@ bool GzipInputStream::load()
 {
     crc = crc32(0L, Z_NULL, 0);
     
-    std::vector<Byte> inputBuf;
+    // The trailer holds the CRC and size, so the whole compressed source is needed
     while (true)
         {
-        int ch = source.get();
-        if (ch<0)
+        auto const size = srcBuf.size();
+        srcBuf.resize(size + IN_CHUNK);
+        int got = source.read(srcBuf.data() + size, IN_CHUNK);
+        srcBuf.resize(size + std::max(got, 0));
+        if (got <= 0)
             break;
-        inputBuf.push_back(static_cast<Byte>(ch & 0xff));
         }
-    long inputBufLen = inputBuf.size();
-    
-    if (inputBufLen < 19) //header + tail + 1
+
+    if (srcBuf.size() < 19) //header + tail + 1
         {
         return false;
         }
 
-    srcLen = inputBuf.size();
-    srcBuf = new (std::nothrow) Byte [srcLen];
-    if (!srcBuf) {
-        return false;
-    }
+    srcLen = srcBuf.size();
 
     outputBuf = new (std::nothrow) unsigned char [OUT_SIZE];
     if ( !outputBuf ) {
-        delete[] srcBuf;
-        srcBuf = nullptr;
+        srcBuf = {};
         return false;
     }
     outputBufLen = 0; // Not filled in yet
 
-    std::vector<unsigned char>::iterator iter;
-    Bytef *p = srcBuf;
-    for (iter=inputBuf.begin() ; iter != inputBuf.end() ; ++iter)
-	{
-        *p++ = *iter;
-	}
-
     size_t headerLen = 10;
 
     int flags = static_cast<int>(srcBuf[3]);
@@ -241,7 +257,7 @@ bool GzipInputStream::load()
     
     //outputBufLen = srcSiz + srcSiz/100 + 14;
     
-    unsigned char *data = srcBuf + headerLen;
+    unsigned char *data = srcBuf.data() + headerLen;
     unsigned long dataLen = srcLen - (headerLen + 8);
     //printf("%x %x\n", data[0], data[dataLen-1]);
     
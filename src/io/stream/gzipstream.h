@@ -49,6 +49,8 @@ public:
     void close() override;
     
     int get() override;
+
+    int read(unsigned char *buffer, int len) override;
     
 private:
 
@@ -58,7 +60,7 @@ private:
     bool loaded;
     
     unsigned char *outputBuf;
-    unsigned char *srcBuf;
+    std::vector<unsigned char> srcBuf;
 
     unsigned long crc;
     unsigned long srcCrc;
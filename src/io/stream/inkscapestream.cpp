@@ -36,6 +36,25 @@ void pipeStream(InputStream &source, OutputStream &dest)
     dest.flush();
 }
 
+//#########################################################################
+//# I N P U T    S T R E A M
+//#########################################################################
+
+/**
+ * Reads up to len bytes, one at a time.  0 if EOF
+ */
+int InputStream::read(unsigned char *buffer, int len)
+{
+    int got = 0;
+    while (got < len) {
+        int ch = get();
+        if (ch < 0)
+            break;
+        buffer[got++] = static_cast<unsigned char>(ch);
+    }
+    return got;
+}
+
 //#########################################################################
 //# B A S I C    I N P U T    S T R E A M
 //#########################################################################
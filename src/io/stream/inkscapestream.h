@@ -87,6 +87,14 @@ public:
      * This call returns -1 on end-of-file.
      */
     virtual int get() = 0;
+
+    /**
+     * Read up to len bytes into buffer, returning the number of bytes
+     * read; 0 means end-of-file.  The default implementation calls get()
+     * for each byte.  Streams that hold their data in blocks should
+     * override it, so that bulk readers avoid a virtual call per byte.
+     */
+    virtual int read(unsigned char *buffer, int len);
     
 }; // class InputStream
 
@@ -88,6 +88,16 @@ int FileInputStream::get()
     return retVal;
 }
 
+/**
+ * Reads up to len bytes with a single fread().  0 if EOF
+ */
+int FileInputStream::read(unsigned char *buffer, int len)
+{
+    if (!inf || len <= 0)
+        return 0;
+    return static_cast<int>(fread(buffer, 1, len, inf));
+}
+
 
 
 
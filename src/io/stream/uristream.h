@@ -50,6 +50,8 @@ public:
 
     int get() override;
 
+    int read(unsigned char *buffer, int len) override;
+
 private:
     FILE *inf;           //for file: uris
 
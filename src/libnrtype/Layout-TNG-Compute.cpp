@@ -10,7 +10,13 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cstring>
 #include <iomanip>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 
 #include "Layout-TNG.h"
 #include "style.h"
@@ -22,6 +28,8 @@
 #include "Layout-TNG-Scanline-Maker.h"
 #include <limits>
 #include "livarot/Shape.h"
+#include "util/statics.h"
+#include "debug/trace.h"
 
 namespace Inkscape {
 namespace Text {
@@ -34,6 +42,124 @@ namespace Text {
 
 #define TRACE(_args) IFTRACE(g_print _args)
 
+namespace {
+
+/**
+ * Itemization and shaping results of whole paragraphs, shared between all layouts.
+ *
+ * A paragraph is identified by its text together with everything pango_itemize() and
+ * pango_shape() look at: the font, font features and language of each run, the base direction,
+ * the gravity settings of the context and the state of the font map. Relaying out text whose
+ * paragraphs did not change - because only its position or wrap shape moved, or because another
+ * paragraph was edited - then reuses the glyphs, as does laying out many copies of one label.
+ */
+class ShapingCache
+{
+public:
+    class Paragraph
+    {
+    public:
+        Paragraph() = default;
+        Paragraph(Paragraph const &) = delete;
+        Paragraph &operator=(Paragraph const &) = delete;
+
+        ~Paragraph()
+        {
+            for (auto &item : items) {
+                pango_item_free(item.first);
+            }
+            for (auto &glyphs : _glyphs) {
+                pango_glyph_string_free(glyphs.second);
+            }
+        }
+
+        std::vector<std::pair<PangoItem *, std::shared_ptr<FontInstance>>> items;
+        std::vector<PangoLogAttr> char_attributes;
+
+        /// Copies the glyphs of the span starting at byte offset in item into glyph_string, if known.
+        bool copyGlyphs(unsigned item, unsigned offset, unsigned length, PangoGlyphString *glyph_string) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _glyphs.find({item, offset, length});
+            if (it == _glyphs.end()) {
+                return false;
+            }
+            auto const *cached = it->second;
+            pango_glyph_string_set_size(glyph_string, cached->num_glyphs);
+            std::memcpy(glyph_string->glyphs, cached->glyphs, cached->num_glyphs * sizeof(PangoGlyphInfo));
+            std::memcpy(glyph_string->log_clusters, cached->log_clusters, cached->num_glyphs * sizeof(gint));
+            return true;
+        }
+
+        void storeGlyphs(unsigned item, unsigned offset, unsigned length, PangoGlyphString const *glyph_string)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto &cached = _glyphs[{item, offset, length}];
+            if (!cached) {
+                cached = pango_glyph_string_copy(const_cast<PangoGlyphString *>(glyph_string));
+            }
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::map<std::tuple<unsigned, unsigned, unsigned>, PangoGlyphString *> _glyphs;
+    };
+
+    ShapingCache()
+    {
+        FontFactory::get(); // The cached items hold on to fonts, so go before the factory does.
+    }
+
+    /// Must first be called on the main thread, see Inkscape::Util::Static.
+    static ShapingCache &get()
+    {
+        static auto instance = Inkscape::Util::Static<ShapingCache>();
+        return instance.get();
+    }
+
+    std::shared_ptr<Paragraph> lookup(std::string const &key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it == _entries.end()) {
+            return {};
+        }
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return it->second->second;
+    }
+
+    void insert(std::string const &key, std::shared_ptr<Paragraph> paragraph)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.count(key)) {
+            return;
+        }
+        _lru.emplace_front(key, std::move(paragraph));
+        _entries.emplace(key, _lru.begin());
+        while (_lru.size() > CAPACITY) {
+            _entries.erase(_lru.back().first);
+            _lru.pop_back();
+        }
+    }
+
+private:
+    static constexpr std::size_t CAPACITY = 4096;
+
+    std::mutex _mutex;
+    std::list<std::pair<std::string, std::shared_ptr<Paragraph>>> _lru;
+    std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<Paragraph>>>::iterator> _entries;
+};
+
+/// Appends a length-prefixed field to a shaping cache key, so that fields cannot run into each other.
+void append_key_field(std::string &key, char const *data, std::size_t length)
+{
+    key += std::to_string(length);
+    key += ':';
+    key.append(data, length);
+}
+
+} // namespace
+
 /** \brief private to Layout. Does the real work of text flowing.
 
 This class does a standard greedy paragraph wrapping algorithm.
@@ -177,6 +303,7 @@ class Layout::Calculator
         std::vector<PangoItemInfo> pango_items;
         std::vector<PangoLogAttr> char_attributes;    ///< For every character in the paragraph.
         std::vector<UnbrokenSpan> unbroken_spans;
+        std::shared_ptr<ShapingCache::Paragraph> shaped;  ///< Cached itemization and glyphs of this paragraph.
 
         template<typename T> static void free_sequence(T &seq)
         {
@@ -192,6 +319,7 @@ class Layout::Calculator
             free_sequence(input_items);
             free_sequence(pango_items);
             free_sequence(unbroken_spans);
+            shaped.reset();
         }
     };
 
@@ -242,6 +370,7 @@ class Layout::Calculator
         int whitespace_count;
     };
 
+    void _setupPangoContext();
     void _buildPangoItemizationForPara(ParagraphInfo *para) const;
     static double _computeFontLineHeight( SPStyle const *style ); // Returns line_height_multiplier
     unsigned _buildSpansForPara(ParagraphInfo *para) const;
@@ -288,7 +417,8 @@ class Layout::Calculator
 
 public:
     Calculator(Layout *text_flow)
-        : _flow(*text_flow) {}
+        : _flow(*text_flow)
+        , _pango_context(FontFactory::get().get_font_context()) {}
 
     bool calculate();
 };
@@ -1320,8 +1450,10 @@ void Layout::Calculator::BrokenSpan::setZero()
  * paragraph and stitch it together so that pango_itemize() can be called on
  * the whole thing.
  *
+ * The result is looked up in, or added to, the shaping cache.
+ *
  * Input: para.first_input_index.
- * Output: para.direction, para.pango_items, para.char_attributes.
+ * Output: para.direction, para.pango_items, para.char_attributes, para.shaped.
  * Returns: the number of spans created by pango_itemize
  */
 void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) const
@@ -1331,6 +1463,7 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
 
     TRACE(("itemizing para, first input %d\n", para->first_input_index));
 
+    std::string key;
     PangoAttrList *attributes_list = pango_attr_list_new();
     for (unsigned input_index = para->first_input_index ; input_index < _flow._input_stream.size() ; input_index++) {
         if (_flow._input_stream[input_index]->Type() == CONTROL_CODE) {
@@ -1352,9 +1485,11 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
             PangoAttribute *attribute_font_description = pango_attr_font_desc_new(font->get_descr());
             attribute_font_description->start_index = para->text.bytes();
 
+            auto const font_features = text_source->style->getFontFeatureString();
             PangoAttribute *attribute_font_features =
-                pango_attr_font_features_new( text_source->style->getFontFeatureString().c_str());
+                pango_attr_font_features_new(font_features.c_str());
             attribute_font_features->start_index = para->text.bytes();
+            auto const run_start = para->text.bytes();
             para->text.append(&*text_source->text_begin.base(), text_source->text_length);     // build the combined text
 
             attribute_font_description->end_index = para->text.bytes();
@@ -1370,6 +1505,14 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
                 PangoAttribute *attribute_language = pango_attr_language_new( language );
                 pango_attr_list_insert(attributes_list, attribute_language);
             }
+
+            // Describe the run for the shaping cache
+            char *font_description = pango_font_description_to_string(font->get_descr());
+            append_key_field(key, font_description, std::strlen(font_description));
+            g_free(font_description);
+            append_key_field(key, font_features.data(), font_features.size());
+            append_key_field(key, object->lang.data(), object->lang.size());
+            append_key_field(key, para->text.data() + run_start, para->text.bytes() - run_start);
         }
     }
 
@@ -1379,11 +1522,39 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
     // Pango Itemize
     GList *pango_items_glist = nullptr;
     para->direction = LEFT_TO_RIGHT; // CSS default
-    if (_flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE) {
+    bool const has_base_dir = _flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE;
+    if (has_base_dir) {
         Layout::InputStreamTextSource const *text_source = static_cast<Layout::InputStreamTextSource *>(_flow._input_stream[para->first_input_index]);
+        para->direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
+    }
 
-        para->direction =                (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
-        PangoDirection pango_direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
+    key += has_base_dir ? (para->direction == LEFT_TO_RIGHT ? 'l' : 'r') : 'n';
+    key += std::to_string(pango_context_get_base_gravity(_pango_context));
+    key += ':';
+    key += std::to_string(pango_context_get_gravity_hint(_pango_context));
+    key += ':';
+    key += std::to_string(pango_font_map_get_serial(pango_context_get_font_map(_pango_context)));
+
+    if (auto shaped = ShapingCache::get().lookup(key)) {
+        pango_attr_list_unref(attributes_list);
+        TRACE(("para itemization found in the shaping cache\n"));
+        para->pango_items.reserve(shaped->items.size());
+        for (auto const &item : shaped->items) {
+            PangoItemInfo new_item;
+            new_item.item = pango_item_copy(item.first);
+            new_item.font = item.second;
+            para->pango_items.push_back(new_item);
+        }
+        para->char_attributes = shaped->char_attributes;
+        para->shaped = std::move(shaped);
+        return;
+    }
+
+    // Itemizing loads fonts from the shared font map
+    auto font_map_lock = FontFactory::get().lock_font_map();
+
+    if (has_base_dir) {
+        PangoDirection pango_direction = para->direction == LEFT_TO_RIGHT ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
         pango_items_glist = pango_itemize_with_base_dir(_pango_context, pango_direction, para->text.data(), 0, para->text.bytes(), attributes_list, nullptr);
     }
 
@@ -1406,6 +1577,7 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
         para->pango_items.push_back(new_item);
     }
     g_list_free(pango_items_glist);
+    font_map_lock.unlock();
 
     // and get the character attributes on everything
     para->char_attributes.resize(para->text.length() + 1);
@@ -1415,6 +1587,15 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
     // This breaks Inkscape's multiline text (i.e. sodipodi:role line).
     para->char_attributes[para->text.length()].is_mandatory_break = 0;
 
+    auto shaped = std::make_shared<ShapingCache::Paragraph>();
+    shaped->items.reserve(para->pango_items.size());
+    for (auto const &item : para->pango_items) {
+        shaped->items.emplace_back(pango_item_copy(item.item), item.font);
+    }
+    shaped->char_attributes = para->char_attributes;
+    ShapingCache::get().insert(key, shaped);
+    para->shaped = std::move(shaped);
+
     TRACE(("end para itemize, direction = %d\n", para->direction));
 }
 
@@ -1450,7 +1631,8 @@ bool compareGlyphWidth(const PangoGlyphInfo &a, const PangoGlyphInfo &b)
 
 
 /**
- * Split the paragraph into spans. Also call pango_shape() on them.
+ * Split the paragraph into spans. Also call pango_shape() on them, or take their glyphs from
+ * the shaping cache.
  *
  * Input: para->first_input_index, para->pango_items
  * Output: para->spans
@@ -1609,15 +1791,19 @@ unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
                     auto gnew = std::string_view(para->text.data()         + para_text_index,           new_span.text_bytes);
                     assert (gold == gnew);
 
-                    // Convert characters to glyphs
-                    pango_shape_full(para->text.data() + para_text_index,
-                                     new_span.text_bytes,
-                                     para->text.data(),
-                                     -1,
-                                     &para->pango_items[pango_item_index].item->analysis,
-                                     new_span.glyph_string);
+                    // Convert characters to glyphs, unless this span was shaped before
+                    bool const shaped = para->shaped->copyGlyphs(pango_item_index, para_text_index, new_span.text_bytes, new_span.glyph_string);
+                    if (!shaped) {
+                        auto font_map_lock = FontFactory::get().lock_font_map();
+                        pango_shape_full(para->text.data() + para_text_index,
+                                         new_span.text_bytes,
+                                         para->text.data(),
+                                         -1,
+                                         &para->pango_items[pango_item_index].item->analysis,
+                                         new_span.glyph_string);
+                    }
 
-                    if (para->pango_items[pango_item_index].item->analysis.level & 1) {
+                    if (!shaped && (para->pango_items[pango_item_index].item->analysis.level & 1)) {
                         // Right to left text (Arabic, Hebrew, etc.)
 
                         // pango_shape() will reorder glyphs in rtl sections into visual order
@@ -1716,6 +1902,10 @@ unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
                     // }
                     /* glyphs[].x_offset values are probably out of order within any log_clusters, apparently harmless */
 
+                    if (!shaped) {
+                        para->shaped->storeGlyphs(pango_item_index, para_text_index, new_span.text_bytes, new_span.glyph_string);
+                    }
+
 
                     new_span.pango_item_index = pango_item_index;
                     new_span.line_height_multiplier = _computeFontLineHeight(text_source->style);
@@ -2099,27 +2289,9 @@ void Layout::Calculator::dumpUnbrokenSpans(ParagraphInfo *para){
 }
 #endif //DEBUG_LAYOUT_TNG_COMPUTE
 
-/** The management function to start the whole thing off. */
-bool Layout::Calculator::calculate()
+/** Sets the gravity of the thread's pango context from the block progression of the text. */
+void Layout::Calculator::_setupPangoContext()
 {
-    if (_flow._input_stream.empty())
-        return false;
-    /**
-    * hm, why do we want assert (crash) the application, now do simply return false
-    * \todo check if this is the correct behaviour
-    * g_assert(_flow._input_stream.front()->Type() == TEXT_SOURCE);
-    */
-    if (_flow._input_stream.front()->Type() != TEXT_SOURCE)
-    {
-        g_warning("flow text is not of type TEXT_SOURCE. Abort.");
-        return false;
-    }
-    TRACE(("begin calculate()\n"));
-
-    _flow._clearOutputObjects();
-
-    _pango_context = FontFactory::get().get_font_context();
-
     _font_factory_size_multiplier = FontFactory::get().fontSize;
 
     _block_progression = _flow._blockProgression();
@@ -2146,6 +2318,28 @@ bool Layout::Calculator::calculate()
         pango_context_set_base_gravity(_pango_context, PANGO_GRAVITY_AUTO);
         pango_context_set_gravity_hint(_pango_context, PANGO_GRAVITY_HINT_NATURAL);
     }
+}
+
+/** The management function to start the whole thing off. */
+bool Layout::Calculator::calculate()
+{
+    if (_flow._input_stream.empty())
+        return false;
+    /**
+    * hm, why do we want assert (crash) the application, now do simply return false
+    * \todo check if this is the correct behaviour
+    * g_assert(_flow._input_stream.front()->Type() == TEXT_SOURCE);
+    */
+    if (_flow._input_stream.front()->Type() != TEXT_SOURCE)
+    {
+        g_warning("flow text is not of type TEXT_SOURCE. Abort.");
+        return false;
+    }
+    TRACE(("begin calculate()\n"));
+
+    _flow._clearOutputObjects();
+
+    _setupPangoContext();
 
     // Minimum line box height determined by block container.
     FontMetrics strut_height = _flow.strut;
@@ -2377,8 +2571,9 @@ void Layout::_calculateCursorShapeForEmpty()
 
 bool Layout::calculateFlow()
 {
+    auto const span = Debug::TraceSpan("text layout", "text");
     TRACE(("begin calculateFlow()\n"));
-    Layout::Calculator calc = Calculator(this);
+    Layout::Calculator calc(this);
     bool result = calc.calculate();
 
     if (textLengthIncrement != 0) {
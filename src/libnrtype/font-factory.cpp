@@ -207,6 +207,7 @@ FontFactory &FontFactory::get()
 FontFactory::FontFactory()
     : fontServer(pango_ft2_font_map_new())
     , fontContext(pango_font_map_create_context(fontServer))
+    , main_thread(std::this_thread::get_id())
 {
     pango_ft2_font_map_set_resolution(PANGO_FT2_FONT_MAP(fontServer), 72, 72);
 #if PANGO_VERSION_CHECK(1,48,0)
@@ -218,11 +219,39 @@ FontFactory::FontFactory()
 
 FontFactory::~FontFactory()
 {
-    loaded.clear();
+    for (auto &stripe : loaded) {
+        stripe.clear();
+    }
     g_object_unref(fontContext);
     g_object_unref(fontServer);
 }
 
+PangoContext *FontFactory::get_font_context()
+{
+    if (std::this_thread::get_id() == main_thread) {
+        return fontContext;
+    }
+
+    // Every other thread gets a context of its own, released when the thread exits.
+    struct ThreadContext
+    {
+        PangoContext *context = nullptr;
+        ~ThreadContext()
+        {
+            if (context) {
+                g_object_unref(context);
+            }
+        }
+    };
+    thread_local ThreadContext thread_context;
+
+    if (!thread_context.context) {
+        auto lock = std::lock_guard(load_mutex);
+        thread_context.context = pango_font_map_create_context(fontServer);
+    }
+    return thread_context.context;
+}
+
 void FontFactory::refreshConfig()
 {
     pango_fc_font_map_config_changed(PANGO_FC_FONT_MAP(fontServer));
@@ -599,7 +628,15 @@ std::shared_ptr<FontInstance> FontFactory::Face(PangoFontDescription *descr, boo
     pango_font_description_set_size(descr, fontSize * PANGO_SCALE);
 
     // Check if already loaded.
-    if (auto res = loaded.lookup(descr)) {
+    auto &stripe = loaded[Hash()(descr) % loaded_stripes];
+    if (auto res = stripe.lookup(descr)) {
+        return res;
+    }
+
+    auto lock = std::lock_guard(load_mutex);
+
+    // Another thread may have loaded it while we waited.
+    if (auto res = stripe.lookup(descr)) {
         return res;
     }
 
@@ -626,10 +663,10 @@ std::shared_ptr<FontInstance> FontFactory::Face(PangoFontDescription *descr, boo
     // Note: The descr of the returned pangofont may differ from what was asked. We use the original as the map key.
     try {
         auto descr_copy = pango_font_description_copy(descr);
-        return loaded.add(
+        return stripe.add(
                    descr_copy,
                    std::make_unique<FontInstance>(
-                       pango_font_map_load_font(fontServer, fontContext, descr),
+                       pango_font_map_load_font(fontServer, get_font_context(), descr),
                        descr_copy
                    )
                );
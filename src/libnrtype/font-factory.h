@@ -12,8 +12,11 @@
 
 #include <functional>
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <pango/pango.h>
 #include "style.h"
@@ -97,13 +100,25 @@ public:
     /// Add a an additional font.
     void AddFontFile(char const *utf8file);
 
-    PangoContext *get_font_context() const { return fontContext; }
+    /// Returns a context for use on the calling thread only, as Pango contexts are not thread-safe.
+    /// All contexts share the one font map, so this alone does not make it safe to use Pango from
+    /// several threads; see lock_font_map().
+    PangoContext *get_font_context();
+
+    /// Serializes use of the shared font map, which Pango does not make thread-safe. Hold it around
+    /// any Pango call that may load fonts from it, such as itemizing or shaping.
+    std::unique_lock<std::recursive_mutex> lock_font_map() { return std::unique_lock(load_mutex); }
     PangoFontDescription *parsePostscriptName(std::string const &name, bool substitute);
 private:
     // Pango data. Backend-specific structures are cast to these opaque types.
     PangoFontMap *fontServer;
     PangoContext *fontContext;
 
+    std::thread::id main_thread;
+
+    // Serializes access to the font map, which is not safe to use from several threads.
+    std::recursive_mutex load_mutex;
+
     // A hashmap of all the loaded font instances, indexed by their PangoFontDescription.
     // Note: Since pango already does that, using the PangoFont could work too.
     struct Hash
@@ -114,7 +129,14 @@ private:
     {
         bool operator()(PangoFontDescription const *a, PangoFontDescription const *b) const;
     };
-    Inkscape::Util::cached_map<PangoFontDescription*, FontInstance, Hash, Compare> loaded;
+    // The map is split into stripes by the hash of the description, each with its own lock, so
+    // that threads looking up different fonts rarely wait for each other.
+    static constexpr std::size_t loaded_stripes = 8;
+    struct LoadedStripe : Inkscape::Util::cached_map<PangoFontDescription*, FontInstance, Hash, Compare>
+    {
+        LoadedStripe() : cached_map(32 / loaded_stripes) {}
+    };
+    std::array<LoadedStripe, loaded_stripes> loaded;
 
     // The following two commented out maps were an attempt to allow Inkscape to use font faces
     // that could not be distinguished by CSS values alone. In practice, they never were that
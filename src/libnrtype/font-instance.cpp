@@ -390,6 +390,9 @@ FontGlyph const *FontInstance::LoadGlyph(int glyph_id)
         return nullptr; // bitmap font
     }
 
+    // Text layouts may be computed on several threads at once.
+    auto lock = std::lock_guard(data->mutex);
+
     if (auto it = data->glyphs.find(glyph_id); it != data->glyphs.end()) {
         return it->second.get(); // already loaded
     }
@@ -650,6 +653,7 @@ double FontInstance::Advance(int glyph_id, bool vertical)
 
 std::map<Glib::ustring, OTSubstitution> const &FontInstance::get_opentype_tables()
 {
+    auto lock = std::lock_guard(data->mutex);
     if (!data->openTypeTables) {
         auto hb_font = pango_font_get_hb_font(p_font);
         assert(hb_font);
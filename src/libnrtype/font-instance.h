@@ -11,6 +11,7 @@
 #define LIBNRTYPE_FONT_INSTANCE_H
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include <optional>
 #include <unordered_map>
@@ -165,6 +166,9 @@ private:
 
         // Lookup table mapping pango glyph ids to glyphs.
         std::unordered_map<int, std::unique_ptr<FontGlyph const>> glyphs;
+
+        // Guards the lazily loaded members above.
+        std::mutex mutex;
     };
 
     std::shared_ptr<Data> data;
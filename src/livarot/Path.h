@@ -657,6 +657,9 @@ public:
   {
     outlineCallback *cubicto;
     outlineCallback *arcto;
+    // half turn state of OutlineJoin(), kept per outline so that outlines can be made concurrently
+    bool turnInside = true;
+    Geom::Point prevPos = Geom::Point(0, 0);
   };
 
   void SubContractOutline (int off, int num_pd,
@@ -674,7 +677,7 @@ public:
   static void TangentOnCubAt (double at, Geom::Point const &iS, PathDescrCubicTo const &fin, bool before,
 			      Geom::Point &pos, Geom::Point &tgt, double &len, double &rad);
   static void OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point enNor,
-			   double width, JoinType join, double miter, int nType);
+			   double width, JoinType join, double miter, int nType, outline_callbacks & calls);
 
   static bool IsNulCurve (std::vector<PathDescr*> const &cmd, int curD, Geom::Point const &curX);
 
@@ -330,7 +330,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				if (closeIfNeeded) {
 					if ( Geom::LInfty (curX- firstP) < 0.0001 ) {
 						OutlineJoin (dest, firstP, curT, firstT, width, join,
-									 miter, nType);
+									 miter, nType, calls);
 						dest->Close ();
 					}  else {
                                             PathDescrLineTo temp(firstP);
@@ -347,7 +347,7 @@ void Path::SubContractOutline(int off, int num_pd,
 							Geom::Point pos;
 							pos = curX;
 							OutlineJoin (dest, pos, curT, stNor, width, join,
-										 miter, nType);
+										 miter, nType, calls);
 						}
 						dest->LineTo (enPos+width*enNor);
 
@@ -356,7 +356,7 @@ void Path::SubContractOutline(int off, int num_pd,
 							Geom::Point pos;
 							pos = firstP;
 							OutlineJoin (dest, enPos, enNor, firstT, width, join,
-										 miter, nType);
+										 miter, nType, calls);
 							dest->Close ();
 						}
 					}
@@ -372,7 +372,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				if (Geom::LInfty (curX - firstP) < 0.0001)
 				{
 					OutlineJoin (dest, firstP, curT, firstT, width, join,
-								 miter, nType);
+								 miter, nType, calls);
 					dest->Close ();
 				}
 				else
@@ -388,7 +388,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					{
 						OutlineJoin (dest, stPos, curT, stNor, width, join,
-									 miter, nType);
+									 miter, nType, calls);
 					}
 
 					dest->LineTo (enPos+width*enNor);
@@ -396,7 +396,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					{
 						OutlineJoin (dest, enPos, enNor, firstT, width, join,
-									 miter, nType);
+									 miter, nType, calls);
 						dest->Close ();
 					}
 				}
@@ -445,7 +445,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls);
 			}
 
 			int n_d = dest->LineTo (nextX+width*enNor);
@@ -495,7 +495,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls);
 			}
 
 			callsData.piece = curP;
@@ -551,7 +551,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls);
 			}
 
 			callsData.piece = curP;
@@ -865,7 +865,7 @@ Path::TangentOnCubAt (double at, Geom::Point const &iS, PathDescrCubicTo const &
 
 void
 Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point enNor, double width,
-                   JoinType join, double miter, int nType)
+                   JoinType join, double miter, int nType, outline_callbacks & calls)
 {
     /* 
         Arbitrarily decide if we're on the inside or outside of a half turn.
@@ -876,11 +876,10 @@ Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point
         ideally work because both should fall together, but it seems that this causes many
         extra nodes (due to rounding errors). Solution: for the 'half turn'-case toggle 
         inside/outside each time the same node is processed 2 consecutive times.
+        The state lives in calls, which is shared by both sides of one outline.
     */
-    static bool TurnInside = true;
-    static Geom::Point PrevPos(0, 0);
-    TurnInside ^= PrevPos == pos;
-    PrevPos = pos;
+    calls.turnInside ^= calls.prevPos == pos;
+    calls.prevPos = pos;
 
 	const double angSi = cross (stNor, enNor);
 	const double angCo = dot (stNor, enNor);
@@ -903,7 +902,7 @@ Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point
 //                dest->LineTo (pos);	// redundant
                 dest->LineTo (pos + width*enNor);
             }
-        } else if (angSi == 0 && TurnInside) { // Half turn (180 degrees) ... inside (see above).
+        } else if (angSi == 0 && calls.turnInside) { // Half turn (180 degrees) ... inside (see above).
             dest->LineTo (pos + width*enNor);
         } else { // This is an outside join -> chosen JoinType should be applied.
             if (join == join_round) {
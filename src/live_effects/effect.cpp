@@ -15,6 +15,7 @@
 // include effects:
 #include <cstdio>
 #include <cstring>
+#include <boost/functional/hash.hpp>
 #include <gtkmm/expander.h>
 #include <pangomm/layout.h>
 
@@ -79,11 +80,13 @@
 #include "live_effects/lpe-transform_2pts.h"
 #include "live_effects/lpe-vonkoch.h"
 #include "live_effects/lpeobject.h"
+#include "live_effects/parameter/path.h"
 #include "message-stack.h"
 #include "object/sp-defs.h"
 #include "object/sp-root.h"
 #include "object/sp-shape.h"
 #include "path-chemistry.h"
+#include "svg/svg.h"
 #include "ui/icon-loader.h"
 #include "ui/tools/node-tool.h"
 #include "ui/tools/pen-tool.h"
@@ -1148,6 +1151,7 @@ Effect::Effect(LivePathEffectObject *lpeobject)
       on_remove_all(false),
       lpeobj(lpeobject),
       concatenate_before_pwd2(false),
+      cacheable_result(false),
       sp_lpe_item(nullptr),
       current_zoom(0),
       refresh_widgets(false),
@@ -2009,6 +2013,25 @@ Effect::getParameter(const char * key)
     return nullptr;
 }
 
+/**
+ * Hash of the serialized values of all registered parameters, used to detect parameter
+ * changes when reusing cached results. Path parameters linked to another item serialize
+ * as a reference, so the path they resolve to is hashed too.
+ */
+std::size_t
+Effect::getParamsHash() const
+{
+    std::size_t seed = 0;
+    for (auto const param : param_vector) {
+        boost::hash_combine(seed, std::string(param->param_key.raw()));
+        boost::hash_combine(seed, std::string(param->param_getSVGValue().raw()));
+        if (param->paramType() == ParamType::PATH) {
+            boost::hash_combine(seed, sp_svg_write_path(static_cast<PathParam const *>(param)->get_pathvector()));
+        }
+    }
+    return seed;
+}
+
 Parameter *
 Effect::getNextOncanvasEditableParam()
 {
@@ -125,6 +125,15 @@ public:
         return provides_own_flash_paths || show_orig_path;
     }
     inline bool showOrigPath() const { return show_orig_path; }
+    /**
+     * True when doEffect() only depends on the input path, the item transform and the
+     * parameters, so SPLPEItem may reuse a previous result for identical inputs.
+     * Effects with pending internal work override it to force the next run.
+     * A reused result skips doBeforeEffect() and doAfterEffect() too, so whatever they set
+     * up, such as satellites and helper paths, must only depend on the same inputs.
+     */
+    virtual bool isCacheable() const { return cacheable_result; }
+    std::size_t getParamsHash() const;
 
     Glib::ustring          getName() const;
     Inkscape::XML::Node *  getRepr();
@@ -191,6 +200,9 @@ protected:
     // this boolean defaults to false, it concatenates the input path to one pwd2,
     // instead of normally 'splitting' the path into continuous pwd2 paths and calling doEffect_pwd2 for each.
     bool concatenate_before_pwd2;
+    // set this to true in derived effects whose result is a pure function of the input path,
+    // item transform and parameters, see isCacheable()
+    bool cacheable_result;
     double current_zoom;
     std::vector<Geom::Point> selectedNodesPoints;
     Inkscape::UI::Widget::Registry wr;
@@ -55,6 +55,8 @@ LPEBSpline::LPEBSpline(LivePathEffectObject *lpeobject)
     helper_size.param_set_range(0.0, 999.0);
     helper_size.param_set_increments(1, 1);
     helper_size.param_set_digits(2);
+
+    cacheable_result = true;
 }
 
 LPEBSpline::~LPEBSpline() = default;
@@ -113,6 +113,7 @@ LPEPatternAlongPath::LPEPatternAlongPath(LivePathEffectObject *lpeobject) :
     prop_scale.param_set_increments(0.01, 0.10);
     _knot_entity = nullptr;
     _provides_knotholder_entities = true;
+    cacheable_result = true;
 
 }
 
@@ -197,6 +197,13 @@ LPEPowerStroke::LPEPowerStroke(LivePathEffectObject *lpeobject) :
     scale_width.param_set_digits(1);   
     recusion_limit = 0;
     has_recursion = false;
+    cacheable_result = true;
+}
+
+bool LPEPowerStroke::isCacheable() const
+{
+    // Both make the next run differ from the last one for the same input.
+    return cacheable_result && !adjust_path && !has_recursion;
 }
 
 LPEPowerStroke::~LPEPowerStroke() = default;
@@ -24,6 +24,7 @@ namespace LivePathEffect {
 LPESpiro::LPESpiro(LivePathEffectObject *lpeobject) :
     Effect(lpeobject)
 {
+    cacheable_result = true;
 }
 
 LPESpiro::~LPESpiro() = default;
@@ -120,6 +120,7 @@ LPETaperStroke::LPETaperStroke(LivePathEffectObject *lpeobject) :
 {
     show_orig_path = true;
     _provides_knotholder_entities = true;
+    cacheable_result = true;
 
     attach_start.param_set_digits(3);
     attach_end.param_set_digits(3);
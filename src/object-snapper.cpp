@@ -39,9 +39,9 @@
 #include "path/path-util.h" // curve_for_item
 #include "preferences.h"
 #include "snap-enums.h"
+#include "snap-index.h"
 #include "style.h"
 #include "svg/svg.h"
-#include "text-editing.h"
 #include "page-manager.h"
 
 Inkscape::ObjectSnapper::ObjectSnapper(SnapManager *sm, Geom::Coord const d)
@@ -353,11 +353,8 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
                     if (is<SPText>(root_item) || is<SPFlowtext>(root_item)) {
                         if (_snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_TEXT_BASELINE)) {
                             // Snap to the text baseline
-                            Text::Layout const *layout = te_get_layout(static_cast<SPItem *>(root_item));
-                            if (layout != nullptr && layout->outputExists()) {
-                                auto pv = Geom::PathVector();
-                                pv.push_back(layout->baseline() * root_item->i2dt_affine() * _candidate.additional_affine * _snapmanager->getDesktop()->doc2dt());
-                                _paths_to_snap_to->push_back(SnapCandidatePath(std::move(pv), SNAPTARGET_TEXT_BASELINE, Geom::OptRect()));
+                            if (auto pv = _snapmanager->_target_index->getPath(_candidate)) {
+                                _paths_to_snap_to->push_back(SnapCandidatePath(*pv, SNAPTARGET_TEXT_BASELINE, Geom::OptRect()));
                             }
                         }
                     } else {
@@ -371,12 +368,9 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
                         }
 
                         if (!very_complex_path && root_item && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH, SNAPTARGET_PATH_INTERSECTION)) {
-                            if (auto const shape = cast<SPShape>(root_item)) {
-                                if (auto const curve = shape->curve()) {
-                                    auto pv = curve->get_pathvector();
-                                    pv *= root_item->i2dt_affine() * _candidate.additional_affine * _snapmanager->getDesktop()->doc2dt(); // (_edit_transform * _i2d_transform);
-                                    _paths_to_snap_to->push_back(SnapCandidatePath(std::move(pv), SNAPTARGET_PATH, Geom::OptRect())); // Perhaps for speed, get a reference to the Geom::pathvector, and store the transformation besides it.
-                                }
+                            // The transformed path is cached by the snap target index until the item changes
+                            if (auto pv = _snapmanager->_target_index->getPath(_candidate)) {
+                                _paths_to_snap_to->push_back(SnapCandidatePath(*pv, SNAPTARGET_PATH, Geom::OptRect()));
                             }
                         }
                     }
@@ -646,7 +640,7 @@ void Inkscape::ObjectSnapper::freeSnap(IntermSnapResults &isr,
     precious CPU cycles */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     _snapNodes(isr, p, unselected_nodes);
@@ -693,7 +687,7 @@ void Inkscape::ObjectSnapper::constrainedSnap( IntermSnapResults &isr,
     precious CPU cycles */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(pp, pp); // Using the projected point here! Not so in freeSnap()!
-        _snapmanager->_findCandidates(_snapmanager->getDocument()->getRoot(), it, local_bbox_to_snap, false, Geom::identity());
+        _snapmanager->_findCandidates(it, local_bbox_to_snap);
     }
 
     // A constrained snap, is a snap in only one degree of freedom (specified by the constraint line).
@@ -144,6 +144,11 @@ void SPGroup::update(SPCtx *ctx, unsigned int flags) {
 
     unsigned childflags = flags;
 
+    // The contents of a layer loaded hidden may not have been built yet.
+    if ((flags & SP_OBJECT_STYLE_MODIFIED_FLAG) && style->display.computed != SP_CSS_DISPLAY_NONE) {
+        document->buildDeferred(this);
+    }
+
     if (flags & SP_OBJECT_MODIFIED_FLAG) {
       childflags |= SP_OBJECT_PARENT_MODIFIED_FLAG;
     }
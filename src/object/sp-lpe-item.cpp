@@ -235,6 +235,7 @@ bool SPLPEItem::performPathEffect(SPCurve *curve, SPShape *current, bool is_clip
     if (this->hasPathEffect() && this->pathEffectsEnabled()) {
         PathEffectList path_effect_list(*this->path_effect_list);
         size_t path_effect_list_size = path_effect_list.size();
+        size_t pos = 0;
         for (auto &lperef : path_effect_list) {
             LivePathEffectObject *lpeobj = lperef->lpeobject;
             if (!lpeobj) {
@@ -246,12 +247,46 @@ bool SPLPEItem::performPathEffect(SPCurve *curve, SPShape *current, bool is_clip
             }
 
             Inkscape::LivePathEffect::Effect *lpe = lpeobj->get_lpe();
+            bool cacheable = lpe && _canCacheEffect(lpe, current, is_clip_or_mask);
+            if (_lpe_stack_cache.size() <= pos) {
+                _lpe_stack_cache.resize(pos + 1);
+            }
+            auto &cached = _lpe_stack_cache[pos++];
+            std::size_t params_hash = 0;
+            if (cacheable) {
+                params_hash = lpe->getParamsHash();
+                if (cached.lpe == lpe && cached.params_hash == params_hash && cached.transform == transform &&
+                    cached.input == curve->get_pathvector())
+                {
+                    // Same effect, parameters and input as last time: only replay the state
+                    // performOnePathEffect() leaves behind. doEffect() is skipped, and so are
+                    // doBeforeEffect() and doAfterEffect(), see Effect::isCacheable().
+                    lpe->setCurrentShape(current);
+                    lpe->sp_lpe_item = this;
+                    lpe->pathvector_before_effect = cached.input;
+                    lpe->pathvector_after_effect = cached.output;
+                    curve->set_pathvector(cached.output);
+                    current->setCurveInsync(curve);
+                    continue;
+                }
+                cached.input = curve->get_pathvector();
+            }
             if (!lpe || !performOnePathEffect(curve, current, lpe, is_clip_or_mask)) {
+                cached = StackCacheEntry();
                 return false;
             }
+            if (cacheable && !lpe->has_exception) {
+                cached.lpe = lpe;
+                cached.params_hash = params_hash;
+                cached.transform = transform;
+                cached.output = curve->get_pathvector();
+            } else {
+                cached = StackCacheEntry();
+            }
             auto hreflist = lpeobj->hrefList;
             if (hreflist.size()) { // lpe can be removed on perform (eg: clone lpe on copy)
                 if (path_effect_list_size != this->path_effect_list->size()) {
+                    _lpe_stack_cache.clear();
                     break;
                 }
             }
@@ -260,6 +295,23 @@ bool SPLPEItem::performPathEffect(SPCurve *curve, SPShape *current, bool is_clip
     return true;
 }
 
+/**
+ * Whether the result of \a lpe may be taken from, and stored in, the per-position stack cache.
+ * Only effects that declare themselves cacheable qualify, and only when running on the item's
+ * own curve in the steady state: loading, undo and clip/mask application always run the effect.
+ */
+bool SPLPEItem::_canCacheEffect(Inkscape::LivePathEffect::Effect const *lpe, SPShape const *current,
+                                bool is_clip_or_mask) const
+{
+    if (!lpe->isCacheable() || is_clip_or_mask || current != this || document->isSeeking()) {
+        return false;
+    }
+    if (!lpe->isVisible() || lpe->is_load || lpe->is_applied || lpe->refresh_widgets) {
+        return false;
+    }
+    return lpe->acceptsNumClicks() == 0 || lpe->isReady();
+}
+
 /**
  * returns true when LPE was successful.
  */
@@ -18,6 +18,8 @@
 #include <list>
 #include <string>
 #include <memory>
+#include <vector>
+#include <2geom/pathvector.h>
 #include "sp-item.h"
 
 class LivePathEffectObject;
@@ -125,6 +127,22 @@ public:
     bool forkPathEffectsIfNecessary(unsigned int nr_of_allowed_users = 1, bool recursive = true, bool force = false);
     void editNextParamOncanvas(SPDesktop *dt);
     void update_satellites(bool recursive = true);
+
+private:
+    /**
+     * Result of one cacheable effect in the stack, reused while the effect, its parameters,
+     * the item transform and the incoming path are unchanged.
+     */
+    struct StackCacheEntry {
+        Inkscape::LivePathEffect::Effect const *lpe = nullptr;
+        std::size_t params_hash = 0;
+        Geom::Affine transform;
+        Geom::PathVector input;
+        Geom::PathVector output;
+    };
+    std::vector<StackCacheEntry> _lpe_stack_cache;
+
+    bool _canCacheEffect(Inkscape::LivePathEffect::Effect const *lpe, SPShape const *current, bool is_clip_or_mask) const;
 };
 void sp_lpe_item_update_patheffect (SPLPEItem *lpeitem, bool wholetree, bool write, bool with_satellites = false); // careful, class already has method with *very* similar name!
 void sp_lpe_item_enable_path_effects(SPLPEItem *lpeitem, bool enable);
@@ -686,6 +686,11 @@ static SPObject *get_closest_child_by_repr(SPObject &obj, Inkscape::XML::Node *r
             return result;
         }
 
+        // Skip siblings that have not been built yet, without building them.
+        if (obj.document->isDeferred(ref)) {
+            continue;
+        }
+
         // Only continue if `ref` is not an SPObject, but e.g. an XML comment
         if (obj.document->getObjectByRepr(ref)) {
             break;
@@ -726,6 +731,8 @@ void SPObject::release() {
     style->shape_inside.clear();
     style->shape_subtract.clear();
 
+    document->forgetDeferredChildren(this);
+
     auto tmp = children | boost::adaptors::transformed([](SPObject& obj){return &obj;});
     std::vector<SPObject *> toRelease(tmp.begin(), tmp.end());
 
@@ -742,6 +749,8 @@ void SPObject::remove_child(Inkscape::XML::Node* child) {
     // If the xml node has got a corresponding child in the object tree
     if (ochild) {
         this->detach(ochild);
+    } else {
+        document->forgetDeferred(child);
     }
 }
 
@@ -749,6 +758,9 @@ void SPObject::order_changed(Inkscape::XML::Node *child, Inkscape::XML::Node * /
     SPObject* object = this;
 
     SPObject *ochild = object->get_child_by_repr(child);
+    if (!ochild && document->isDeferred(child)) {
+        return; // Will be built in its new position.
+    }
     g_return_if_fail(ochild != nullptr);
     SPObject *prev = get_closest_child_by_repr(*object, new_ref);
     object->reorder(ochild, prev);
@@ -786,6 +798,11 @@ void SPObject::build(SPDocument *document, Inkscape::XML::Node *repr) {
         object->clone_original = document->getObjectById(repr->attribute("id"));
 
     for (Inkscape::XML::Node *rchild = repr->firstChild() ; rchild != nullptr; rchild = rchild->next()) {
+        if (document->deferBuild(*object, *rchild)) {
+            // Built on first use, see SPDocument::deferBuild().
+            continue;
+        }
+
         const std::string typeString = NodeTraits::get_type_string(*rchild);
 
         SPObject* child = SPFactory::createObject(typeString);
@@ -838,6 +838,7 @@ private:
     void notifyElementNameChanged(Inkscape::XML::Node &node, GQuark old_name, GQuark new_name) final;
 
     friend class SPObjectImpl;
+    friend class SPDocument; // Builds deferred children through child_added().
 
 protected:
     virtual void build(SPDocument *doc, Inkscape::XML::Node *repr);
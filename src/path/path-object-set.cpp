@@ -48,10 +48,9 @@ ObjectSet::strokesToPaths(bool legacy, bool skip_undo)
 
   std::vector<SPItem *> my_items(items().begin(), items().end());
 
-  for (auto item : my_items) {
-    // Do not remove the object from the selection here 
-    // as we want to keep it selected if the whole operation fails
-    Inkscape::XML::Node *new_node = item_to_paths(item, legacy);
+  // Do not remove the objects from the selection here
+  // as we want to keep them selected if the whole operation fails
+  for (auto new_node : items_to_paths(my_items, legacy)) {
     if (new_node) {
       SPObject* new_item = document()->getObjectByRepr(new_node);
 
@@ -132,11 +131,8 @@ ObjectSet::simplifyPaths(bool skip_undo)
     }
     double size = L2(selectionBbox->dimensions());
 
-    int pathsSimplified = 0;
     std::vector<SPItem *> my_items(items().begin(), items().end());
-    for (auto item : my_items) {
-        pathsSimplified += path_simplify(item, threshold, justCoalesce, size);
-    }
+    int pathsSimplified = path_simplify(my_items, threshold, justCoalesce, size);
 
     if (pathsSimplified > 0 && !skip_undo) {
         DocumentUndo::done(document(), _("Simplify"), INKSCAPE_ICON("path-simplify"));
@@ -18,6 +18,8 @@
 
 #include "path-outline.h"
 
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "path-chemistry.h" // Should be moved to path directory
@@ -43,6 +45,8 @@
 
 #include "svg/svg.h"
 
+#include "util/parallel.h"
+
 /**
  * Given an item, find a path representing the fill and a path representing the stroke.
  * Returns true if fill path found. Item may not have a stroke in which case stroke path is empty.
@@ -338,6 +342,62 @@ Geom::PathVector* item_to_outline(SPItem const *item, bool exclude_markers)
 
 // ========================= Stroke to Path ====================== //
 
+namespace {
+
+/// Fill and stroke outlines found ahead of the conversion, see items_to_paths().
+struct FoundPaths
+{
+    bool status = false;
+    Geom::PathVector fill;
+    Geom::PathVector stroke;
+};
+
+/**
+ * Outlines by the repr of their shape. Items are deleted and created during the conversion,
+ * so their addresses may be reused; the reprs are anchored until their entry is taken.
+ */
+class FoundPathsMap
+{
+public:
+    FoundPathsMap() = default;
+    FoundPathsMap(FoundPathsMap const &) = delete;
+    FoundPathsMap &operator=(FoundPathsMap const &) = delete;
+
+    ~FoundPathsMap()
+    {
+        for (auto &[repr, paths] : _map) {
+            Inkscape::GC::release(repr);
+        }
+    }
+
+    void add(Inkscape::XML::Node *repr, FoundPaths paths)
+    {
+        if (repr && _map.emplace(repr, std::move(paths)).second) {
+            Inkscape::GC::anchor(repr);
+        }
+    }
+
+    /// Remove and return the outlines found for this repr, if any.
+    std::optional<FoundPaths> take(Inkscape::XML::Node *repr)
+    {
+        auto it = _map.find(repr);
+        if (it == _map.end()) {
+            return {};
+        }
+        auto paths = std::move(it->second);
+        _map.erase(it);
+        Inkscape::GC::release(repr);
+        return paths;
+    }
+
+private:
+    std::unordered_map<Inkscape::XML::Node *, FoundPaths> _map;
+};
+
+Inkscape::XML::Node *item_to_paths(SPItem *item, bool legacy, SPItem *context, FoundPathsMap *found);
+
+} // namespace
+
 static
 void item_to_paths_add_marker( SPItem *context,
                                SPObject *marker_object,
@@ -382,6 +442,71 @@ void item_to_paths_add_marker( SPItem *context,
  */
 Inkscape::XML::Node*
 item_to_paths(SPItem *item, bool legacy, SPItem *context)
+{
+    return item_to_paths(item, legacy, context, nullptr);
+}
+
+/**
+ * Collect the stroked shapes whose outlines can be found before any of the items are converted.
+ * Items with path effects are flattened first, text and 3D boxes are converted to paths first,
+ * so they are left to be found during the conversion.
+ */
+static void collect_stroked_shapes(SPItem *item, bool legacy, std::vector<SPItem *> &shapes)
+{
+    auto lpeitem = cast<SPLPEItem>(item);
+    if ((lpeitem && lpeitem->hasPathEffect()) || is<SPBox3D>(item)) {
+        return;
+    }
+    if (auto group = cast<SPGroup>(item)) {
+        if (!legacy) {
+            for (auto subitem : group->item_list()) {
+                collect_stroked_shapes(subitem, legacy, shapes);
+            }
+        }
+        return;
+    }
+    if (is<SPShape>(item) && item->style && !item->style->stroke.isNone()) {
+        shapes.push_back(item);
+    }
+}
+
+/**
+ * Replace all items by path objects in one batch.
+ *
+ * The outlines of the stroked shapes are found concurrently first; livarot's offsetting
+ * is by far the most expensive part of the conversion and only reads the shapes.
+ * The document is then changed item by item on this thread.
+ *
+ * Returns the item_to_paths() result for each item, in order.
+ */
+std::vector<Inkscape::XML::Node *> items_to_paths(std::vector<SPItem *> const &items, bool legacy)
+{
+    std::vector<SPItem *> shapes;
+    for (auto item : items) {
+        collect_stroked_shapes(item, legacy, shapes);
+    }
+
+    std::vector<FoundPaths> found(shapes.size());
+    Inkscape::Util::parallel_for(shapes.size(), [&] (std::size_t i) {
+        found[i].status = item_find_paths(shapes[i], found[i].fill, found[i].stroke);
+    });
+
+    FoundPathsMap found_map;
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+        found_map.add(shapes[i]->getRepr(), std::move(found[i]));
+    }
+
+    std::vector<Inkscape::XML::Node *> result;
+    result.reserve(items.size());
+    for (auto item : items) {
+        result.push_back(item_to_paths(item, legacy, nullptr, &found_map));
+    }
+    return result;
+}
+
+namespace {
+
+Inkscape::XML::Node *item_to_paths(SPItem *item, bool legacy, SPItem *context, FoundPathsMap *found)
 {
     char const *id = item->getAttribute("id");
     SPDocument *doc = item->document;
@@ -428,7 +553,7 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
         std::vector<SPItem*> const item_list = group->item_list();
         bool did = false;
         for (auto subitem : item_list) {
-            if (item_to_paths(subitem, legacy)) {
+            if (item_to_paths(subitem, legacy, nullptr, found)) {
                 did = true;
             }
         }
@@ -447,7 +572,15 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
 
     Geom::PathVector fill_path;
     Geom::PathVector stroke_path;
-    bool status = item_find_paths(item, fill_path, stroke_path);
+    bool status;
+    auto cached = found ? found->take(item->getRepr()) : std::nullopt;
+    if (cached) {
+        status = cached->status;
+        fill_path = std::move(cached->fill);
+        stroke_path = std::move(cached->stroke);
+    } else {
+        status = item_find_paths(item, fill_path, stroke_path);
+    }
 
     if (!status) {
         // Was not a well structured shape (or text).
@@ -778,6 +911,8 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
     return out;
 }
 
+} // namespace
+
 /*
   Local Variables:
   mode:c++
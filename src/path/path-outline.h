@@ -16,6 +16,8 @@
 #ifndef SEEN_PATH_OUTLINE_H
 #define SEEN_PATH_OUTLINE_H
 
+#include <vector>
+
 class SPDesktop;
 class SPItem;
 
@@ -44,6 +46,11 @@ Geom::PathVector* item_to_outline (SPItem const *item, bool exclude_markers = fa
  */
 Inkscape::XML::Node* item_to_paths(SPItem *item, bool legacy = false, SPItem *context = nullptr);
 
+/**
+ * Replace items by path objects, finding the outlines of all of them concurrently first.
+ */
+std::vector<Inkscape::XML::Node *> items_to_paths(std::vector<SPItem *> const &items, bool legacy = false);
+
 /**
  * Replace selected items by path objects (a.k.a. stroke to >path).
  * TODO: remove desktop dependency.
@@ -14,6 +14,7 @@
 #ifdef HAVE_CONFIG_H
 #endif
 
+#include <memory>
 #include <vector>
 
 #include "path-simplify.h"
@@ -27,26 +28,32 @@
 #include "object/sp-item-group.h"
 #include "object/sp-path.h"
 
+#include "util/parallel.h"
+
 using Inkscape::DocumentUndo;
 
-// Return number of paths simplified (can be greater than one if group).
-int
-path_simplify(SPItem *item, float threshold, bool justCoalesce, double size)
+namespace {
+
+/// One path to simplify, with everything read from the document up front.
+struct SimplifyJob
+{
+    SPItem *item;
+    double size;
+    std::unique_ptr<Path> path;
+};
+
+void collect_simplify_jobs(SPItem *item, double size, std::vector<SimplifyJob> &jobs)
 {
     //If this is a group, do the children instead
-    auto group = cast<SPGroup>(item);
-    if (group) {
-        int pathsSimplified = 0;
-        std::vector<SPItem*> items = group->item_list();
-        for (auto item : items) {
-            pathsSimplified += path_simplify(item, threshold, justCoalesce, size);
+    if (auto group = cast<SPGroup>(item)) {
+        for (auto child : group->item_list()) {
+            collect_simplify_jobs(child, size, jobs);
         }
-        return pathsSimplified;
+        return;
     }
 
-    auto path = cast<SPPath>(item);
-    if (!path) {
-        return 0;
+    if (!is<SPPath>(item)) {
+        return;
     }
 
     // There is actually no option in the preferences dialog for this!
@@ -64,6 +71,35 @@ path_simplify(SPItem *item, float threshold, bool justCoalesce, double size)
     // Correct virtual size by full transform (bug #166937).
     size /= item->i2doc_affine().descrim();
 
+    // Get path to simplify (note that the path *before* LPE calculation is needed)
+    auto orig = Path_for_item_before_LPE(item, false);
+    if (!orig) {
+        return;
+    }
+
+    jobs.push_back({item, size, std::move(orig)});
+}
+
+/**
+ * The geometry phase, touches nothing but the livarot path.
+ */
+void simplify_job(SimplifyJob &job, float threshold, bool justCoalesce)
+{
+    if ( justCoalesce ) {
+        job.path->Coalesce(threshold * job.size);
+    } else {
+        job.path->ConvertEvenLines(threshold * job.size);
+        job.path->Simplify(threshold * job.size);
+    }
+}
+
+/**
+ * The commit phase, writes the simplified path back to the item.
+ */
+void commit_simplify_job(SimplifyJob const &job)
+{
+    auto item = job.item;
+
     // Save the transform, to re-apply it after simplification.
     Geom::Affine const transform(item->transform);
 
@@ -74,25 +110,8 @@ path_simplify(SPItem *item, float threshold, bool justCoalesce, double size)
     */
     item->doWriteTransform(Geom::identity());
 
-    // SPLivarot: Start  -----------------
-
-    // Get path to simplify (note that the path *before* LPE calculation is needed)
-    auto orig = Path_for_item_before_LPE(item, false);
-    if (!orig) {
-        return 0;
-    }
-
-    if ( justCoalesce ) {
-        orig->Coalesce(threshold * size);
-    } else {
-        orig->ConvertEvenLines(threshold * size);
-        orig->Simplify(threshold * size);
-    }
-
     // Path
-    auto str = orig->svg_dump_path();
-
-    // SPLivarot: End  -------------------
+    auto str = job.path->svg_dump_path();
 
     char const *patheffect = item->getRepr()->attribute("inkscape:path-effect");
     if (patheffect) {
@@ -106,8 +125,41 @@ path_simplify(SPItem *item, float threshold, bool justCoalesce, double size)
 
     // remove irrelevant old nodetypes attibute
     item->removeAttribute("sodipodi:nodetypes");
+}
+
+} // namespace
+
+// Return number of paths simplified (can be greater than one if group).
+int
+path_simplify(SPItem *item, float threshold, bool justCoalesce, double size)
+{
+    return path_simplify(std::vector<SPItem *>{item}, threshold, justCoalesce, size);
+}
 
-    return 1;
+/**
+ * Simplify all paths in the given items.
+ *
+ * The paths are read first, then simplified concurrently, then all written back
+ * to the document in one go; livarot's simplification is the expensive part.
+ *
+ * Return number of paths simplified.
+ */
+int
+path_simplify(std::vector<SPItem *> const &items, float threshold, bool justCoalesce, double size)
+{
+    std::vector<SimplifyJob> jobs;
+    for (auto item : items) {
+        collect_simplify_jobs(item, size, jobs);
+    }
+
+    Inkscape::Util::parallel_for(jobs.size(), [&] (std::size_t i) {
+        simplify_job(jobs[i], threshold, justCoalesce);
+    });
+
+    for (auto const &job : jobs) {
+        commit_simplify_job(job);
+    }
+    return jobs.size();
 }
 
 /*
@@ -10,9 +10,12 @@
 #ifndef PATH_SIMPLIFY_H
 #define PATH_SIMPLIFY_H
 
+#include <vector>
+
 class SPItem;
 
 int path_simplify(SPItem *item, float threshold, bool justCoalesce, double size);
+int path_simplify(std::vector<SPItem *> const &items, float threshold, bool justCoalesce, double size);
 
 #endif // PATH_SIMPLIFY_H
 
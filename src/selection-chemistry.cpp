@@ -644,6 +644,11 @@ void sp_edit_clear_all(Inkscape::Selection *selection)
  */
 static void get_all_items_recursive(std::vector<SPItem*> &list, SPObject *from, SPDesktop *desktop, bool onlyvisible, bool onlysensitive, bool ingroups, std::vector<SPItem*> const &exclude)
 {
+    if (!onlyvisible) {
+        // Hidden layers may not have their children built yet.
+        from->document->buildDeferred(from);
+    }
+
     for (auto &child : from->children) {
         auto item = cast<SPItem>(&child);
         if (item &&
@@ -0,0 +1,620 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Persistent spatial index of the items that can be snapped to.
+ */
+/*
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "snap-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <glibmm/timer.h>
+
+#include "desktop.h"
+#include "document.h"
+#include "snap-preferences.h"
+#include "style.h"
+#include "text-editing.h"
+
+#include "display/curve.h"
+#include "libnrtype/Layout-TNG.h"
+#include "live_effects/effect-enum.h"
+#include "object/sp-filter.h"
+#include "object/sp-flowtext.h"
+#include "object/sp-item-group.h"
+#include "object/sp-lpe-item.h"
+#include "object/sp-root.h"
+#include "object/sp-shape.h"
+#include "object/sp-text.h"
+#include "object/sp-use.h"
+
+namespace Inkscape {
+
+namespace {
+
+/// Fix LPE boolops self-snapping: operands are hidden behind a filter or carry the boolean LPE.
+bool is_stopper(SPItem const *item)
+{
+    if (!item->style) {
+        return false;
+    }
+    SPFilter *filt = item->style->getFilter();
+    if (filt && filt->getId() && std::strcmp(filt->getId(), "selectable_hidder_filter") == 0) {
+        return true;
+    }
+    auto lpeitem = cast<SPLPEItem>(item);
+    return lpeitem && lpeitem->hasPathEffectOfType(Inkscape::LivePathEffect::EffectType::BOOL_OP);
+}
+
+int bbox_slot(SPItem::BBoxType type)
+{
+    return type == SPItem::VISUAL_BBOX ? 0 : 1;
+}
+
+// Items spanning more cells than this are kept in a separate list that every query visits.
+constexpr int MAX_CELLS_PER_ITEM = 256;
+
+// More alignment candidates than this make Inkscape crawl already
+constexpr std::size_t MAX_ALIGN_CANDIDATES = 200;
+
+} // namespace
+
+SnapTargetIndex::SnapTargetIndex(SPDocument *document)
+    : _document(document)
+{
+}
+
+SnapTargetIndex::~SnapTargetIndex()
+{
+    _clear();
+}
+
+void SnapTargetIndex::_clear()
+{
+    for (auto &node : _nodes) {
+        node.modified_connection.disconnect();
+        node.release_connection.disconnect();
+    }
+    _nodes.clear();
+    _leaves.clear();
+    _index_of_item.clear();
+    _dirty.clear();
+    _pending.clear();
+    _cells.clear();
+    _oversized.clear();
+    _stamps.clear();
+    _cell_size = 0;
+}
+
+int SnapTargetIndex::_addNode(SPObject *object, int parent_index, ClipKind clip_kind)
+{
+    int const index = _nodes.size();
+    auto &node = _nodes.emplace_back();
+    node.object = object;
+    node.item = cast<SPItem>(object);
+    node.parent = parent_index;
+    node.clip_kind = clip_kind;
+
+    node.modified_connection = object->connectModified([this, index] (SPObject *, unsigned flags) {
+        // Groups and containers only matter when they change themselves, not when one of their
+        // children does: the children have connections of their own.
+        auto &node = _nodes[index];
+        if (_needs_rebuild || node.dirty || (!node.leaf && !(flags & ~SP_OBJECT_CHILD_MODIFIED_FLAG))) {
+            return;
+        }
+        node.dirty = true;
+        _dirty.push_back(index);
+    });
+    node.release_connection = object->connectRelease([this, index] (SPObject *) {
+        // Never hand the cached geometry to whatever gets allocated at the same address
+        _nodes[index].stale = true;
+        _needs_rebuild = true;
+    });
+    return index;
+}
+
+void SnapTargetIndex::_walk(SPObject *parent, int parent_index, ClipKind clip_kind, bool stop,
+                            SPDesktop const *desktop)
+{
+    for (auto &o : parent->children) {
+        auto item = cast<SPItem>(&o);
+        if (!item) {
+            continue;
+        }
+        int const index = _addNode(item, parent_index, clip_kind);
+        bool const item_stop = stop || is_stopper(item);
+        // Snapping to items in a locked layer is allowed
+        // Don't snap to hidden objects, unless they're a clipped path or a mask
+        bool const hidden = clip_kind == NOT_CLIPPED && desktop->itemIsHidden(item);
+        _nodes[index].stop = item_stop;
+        _nodes[index].hidden = hidden;
+
+        if (!hidden) {
+            if (clip_kind == NOT_CLIPPED) { // cannot clip or mask more than once
+                // The current item is not a clipping path or a mask, but might still be the
+                // subject of clipping or masking itself; if so, then we should also consider
+                // that path or mask for snapping to
+                if (auto clip = item->getClipObject()) {
+                    _nodes[index].clip = clip;
+                    int const container = _addNode(clip, index, IN_CLIP);
+                    for (auto &child : clip->children) {
+                        _nodes[container].children.push_back(&child);
+                    }
+                    _walk(clip, container, IN_CLIP, item_stop, desktop);
+                    _nodes[container].subtree_end = _nodes.size();
+                }
+                if (auto mask = item->getMaskObject()) {
+                    _nodes[index].mask = mask;
+                    int const container = _addNode(mask, index, IN_MASK);
+                    for (auto &child : mask->children) {
+                        _nodes[container].children.push_back(&child);
+                    }
+                    _walk(mask, container, IN_MASK, item_stop, desktop);
+                    _nodes[container].subtree_end = _nodes.size();
+                }
+            }
+
+            if (is<SPGroup>(item)) {
+                for (auto &child : item->children) {
+                    _nodes[index].children.push_back(&child);
+                }
+                _walk(item, index, clip_kind, item_stop, desktop);
+            } else {
+                _nodes[index].leaf = true;
+                _leaves.push_back(index);
+                _index_of_item[item] = index;
+            }
+        }
+        _nodes[index].subtree_end = _nodes.size();
+    }
+}
+
+void SnapTargetIndex::_rebuild(SPDesktop const *desktop)
+{
+    // Keep the geometry of leaves that are still valid, so that a structural change in one
+    // place does not recompute the bounding boxes of the whole document.
+    std::unordered_map<SPItem const *, Node> previous;
+    if (_desktop == desktop && _doc2dt == desktop->doc2dt()) {
+        for (int index : _leaves) {
+            auto &node = _nodes[index];
+            if (!node.stale) {
+                node.modified_connection.disconnect();
+                node.release_connection.disconnect();
+                previous.emplace(node.item, std::move(node));
+            }
+        }
+    }
+    _clear();
+
+    _desktop = desktop;
+    _doc2dt = desktop->doc2dt();
+    _needs_rebuild = false;
+
+    if (auto root = _document->getRoot()) {
+        // The root has a node of its own so that adding or removing top level items is noticed
+        int const index = _addNode(root, -1, NOT_CLIPPED);
+        for (auto &child : root->children) {
+            _nodes[index].children.push_back(&child);
+        }
+        _walk(root, index, NOT_CLIPPED, false, desktop);
+        _nodes[index].subtree_end = _nodes.size();
+    }
+
+    for (int index : _leaves) {
+        auto &node = _nodes[index];
+        auto it = previous.find(node.item);
+        if (it != previous.end() && it->second.clip_kind == node.clip_kind) {
+            auto &old = it->second;
+            node.stale = false;
+            node.bbox[0] = old.bbox[0];
+            node.bbox[1] = old.bbox[1];
+            node.has_bbox[0] = old.has_bbox[0];
+            node.has_bbox[1] = old.has_bbox[1];
+            node.center = old.center;
+            node.path = std::move(old.path);
+        }
+        _pending.push_back(index);
+    }
+    _stamps.assign(_nodes.size(), 0);
+}
+
+bool SnapTargetIndex::_structureChanged(Node const &node, SPDesktop const *desktop) const
+{
+    if (!node.hidden && (!node.item || is<SPGroup>(node.item))) {
+        auto recorded = node.children.begin();
+        for (auto &child : node.object->children) {
+            if (recorded == node.children.end() || *recorded != &child) {
+                return true;
+            }
+            ++recorded;
+        }
+        if (recorded != node.children.end()) {
+            return true;
+        }
+    }
+    if (!node.item || node.parent < 0) {
+        return false;
+    }
+    if (node.stop != (_nodes[node.parent].stop || is_stopper(node.item))) {
+        return true;
+    }
+    if (node.clip_kind != NOT_CLIPPED) {
+        return false;
+    }
+    if (node.hidden != desktop->itemIsHidden(node.item)) {
+        return true;
+    }
+    return !node.hidden && (node.clip != node.item->getClipObject() || node.mask != node.item->getMaskObject());
+}
+
+void SnapTargetIndex::_markStale(int index)
+{
+    // Covers the children of a transformed group as well as the clip path and mask of an item
+    int const end = _nodes[index].subtree_end;
+    for (int i = index; i < end; ++i) {
+        auto &node = _nodes[i];
+        if (!node.leaf || node.stale) {
+            continue;
+        }
+        node.stale = true;
+        node.has_bbox[0] = node.has_bbox[1] = false;
+        node.center.reset();
+        node.path.reset();
+        if (node.in_grid) {
+            _gridRemove(node, i);
+            _pending.push_back(i);
+        }
+    }
+}
+
+void SnapTargetIndex::_processDirty(SPDesktop const *desktop)
+{
+    auto dirty = std::move(_dirty);
+    _dirty.clear();
+    for (int index : dirty) {
+        auto &node = _nodes[index];
+        node.dirty = false;
+        if (_needs_rebuild) {
+            continue;
+        }
+        if (_structureChanged(node, desktop)) {
+            _needs_rebuild = true;
+        } else {
+            _markStale(index);
+        }
+    }
+}
+
+SPItem *SnapTargetIndex::_owner(Node const &node) const
+{
+    // The clipped or masked item is the parent of the clip path or mask container
+    int index = node.parent;
+    while (index >= 0 && _nodes[index].item) {
+        index = _nodes[index].parent;
+    }
+    if (index < 0 || _nodes[index].parent < 0) {
+        return nullptr;
+    }
+    return _nodes[_nodes[index].parent].item;
+}
+
+void SnapTargetIndex::_refresh(Node &node, SPDesktop const *desktop)
+{
+    int const slot = bbox_slot(_bbox_type);
+    if (!node.has_bbox[slot]) {
+        if (node.clip_kind != NOT_CLIPPED) {
+            // We cannot use sp_item_i2d_affine directly because we need to insert an additional
+            // transformation in document coordinates
+            auto owner = _owner(node);
+            Geom::Affine const additional = owner ? owner->i2doc_affine() : Geom::identity();
+            node.bbox[slot] = node.item->bounds(_bbox_type, node.item->i2doc_affine() * additional * desktop->doc2dt());
+        } else {
+            node.bbox[slot] = node.item->desktopBounds(_bbox_type);
+        }
+        node.has_bbox[slot] = true;
+    }
+    if (node.stale) {
+        // A rotation center moved away from the bounding box must still be found by a range query
+        if (node.item->isCenterSet()) {
+            node.center = node.item->getCenter();
+        }
+        node.stale = false;
+    }
+    node.grid_rect = node.bbox[slot];
+    if (node.grid_rect && node.center) {
+        node.grid_rect->expandTo(*node.center);
+    }
+}
+
+std::int64_t SnapTargetIndex::_cellKey(int x, int y)
+{
+    return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+}
+
+void SnapTargetIndex::_gridInsert(Node &node, int index)
+{
+    node.in_grid = true;
+    node.oversized = false;
+    if (!node.grid_rect) {
+        node.cell_x0 = node.cell_y0 = 0;
+        node.cell_x1 = node.cell_y1 = -1;
+        return;
+    }
+    auto const &r = *node.grid_rect;
+    double const x0 = std::floor(r.left() / _cell_size);
+    double const y0 = std::floor(r.top() / _cell_size);
+    double const x1 = std::floor(r.right() / _cell_size);
+    double const y1 = std::floor(r.bottom() / _cell_size);
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_ITEM) {
+        node.oversized = true;
+        _oversized.push_back(index);
+        return;
+    }
+    node.cell_x0 = x0;
+    node.cell_y0 = y0;
+    node.cell_x1 = x1;
+    node.cell_y1 = y1;
+    for (int x = node.cell_x0; x <= node.cell_x1; ++x) {
+        for (int y = node.cell_y0; y <= node.cell_y1; ++y) {
+            _cells[_cellKey(x, y)].push_back(index);
+        }
+    }
+}
+
+void SnapTargetIndex::_gridRemove(Node &node, int index)
+{
+    auto remove_from = [index] (std::vector<int> &list) {
+        auto it = std::find(list.begin(), list.end(), index);
+        if (it != list.end()) {
+            *it = list.back();
+            list.pop_back();
+        }
+    };
+    node.in_grid = false;
+    if (node.oversized) {
+        remove_from(_oversized);
+        return;
+    }
+    for (int x = node.cell_x0; x <= node.cell_x1; ++x) {
+        for (int y = node.cell_y0; y <= node.cell_y1; ++y) {
+            auto it = _cells.find(_cellKey(x, y));
+            if (it != _cells.end()) {
+                remove_from(it->second);
+                if (it->second.empty()) {
+                    _cells.erase(it);
+                }
+            }
+        }
+    }
+}
+
+void SnapTargetIndex::_regrid()
+{
+    for (int index : _leaves) {
+        auto &node = _nodes[index];
+        if (node.in_grid) {
+            node.in_grid = false;
+            _pending.push_back(index);
+        }
+    }
+    _cells.clear();
+    _oversized.clear();
+    _cell_size = 0;
+}
+
+std::vector<int> SnapTargetIndex::_rangeQuery(Geom::Rect const &area)
+{
+    std::vector<int> result;
+    if (++_query_stamp == 0) {
+        std::fill(_stamps.begin(), _stamps.end(), 0);
+        _query_stamp = 1;
+    }
+    auto visit = [&] (std::vector<int> const &list) {
+        for (int index : list) {
+            if (_stamps[index] != _query_stamp) {
+                _stamps[index] = _query_stamp;
+                result.push_back(index);
+            }
+        }
+    };
+
+    if (_cell_size > 0) {
+        double const x0 = std::floor(area.left() / _cell_size);
+        double const y0 = std::floor(area.top() / _cell_size);
+        double const x1 = std::floor(area.right() / _cell_size);
+        double const y1 = std::floor(area.bottom() / _cell_size);
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > _cells.size()) {
+            // Large area, e.g. when zoomed out: visiting the occupied cells is cheaper
+            for (auto const &[key, list] : _cells) {
+                double const x = static_cast<std::int32_t>(key >> 32);
+                double const y = static_cast<std::int32_t>(key & 0xffffffff);
+                if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+                    visit(list);
+                }
+            }
+        } else {
+            for (int x = x0; x <= x1; ++x) {
+                for (int y = y0; y <= y1; ++y) {
+                    auto it = _cells.find(_cellKey(x, y));
+                    if (it != _cells.end()) {
+                        visit(it->second);
+                    }
+                }
+            }
+        }
+    }
+    visit(_oversized);
+
+    // Report candidates in document order, like the tree walk did
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool SnapTargetIndex::_isIgnored(int index, std::unordered_set<SPObject const *> const &ignored) const
+{
+    // The parent chain runs through the enclosing groups and, for clip paths and masks,
+    // through the item they are applied to
+    for (; index >= 0; index = _nodes[index].parent) {
+        if (ignored.count(_nodes[index].object)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SnapTargetIndex::findCandidates(SPDesktop const *desktop,
+                                     SnapPreferences const &snapprefs,
+                                     std::vector<SPObject const *> const *objects_to_ignore,
+                                     Geom::Rect const &bbox_to_snap_incl,
+                                     SPItem::BBoxType bbox_type,
+                                     std::vector<SnapCandidateItem> &obj_candidates,
+                                     std::vector<SnapCandidateItem> &align_candidates)
+{
+    if (_needs_rebuild || desktop != _desktop || desktop->doc2dt() != _doc2dt) {
+        _rebuild(desktop);
+    }
+    _processDirty(desktop);
+    if (_needs_rebuild) {
+        _rebuild(desktop);
+    }
+    if (bbox_type != _bbox_type) {
+        _bbox_type = bbox_type;
+        _regrid();
+    }
+
+    std::unordered_set<SPObject const *> ignored;
+    bool ignoring_stoppers = false;
+    if (objects_to_ignore) {
+        for (auto obj : *objects_to_ignore) {
+            if (!obj) {
+                continue;
+            }
+            ignored.insert(obj);
+            if (auto item = cast<SPItem>(obj); item && is_stopper(item)) {
+                ignoring_stoppers = true;
+            }
+        }
+    }
+
+    // Bring pending items up to date; the ones being dragged wait until they are dropped
+    auto pending = std::move(_pending);
+    _pending.clear();
+    std::vector<int> refreshed;
+    for (int index : pending) {
+        auto &node = _nodes[index];
+        if (node.in_grid) {
+            continue;
+        }
+        if (_isIgnored(index, ignored)) {
+            _pending.push_back(index);
+            continue;
+        }
+        _refresh(node, desktop);
+        refreshed.push_back(index);
+    }
+    if (_cell_size == 0 && !refreshed.empty()) {
+        Geom::OptRect extent;
+        for (int index : refreshed) {
+            extent.unionWith(_nodes[index].grid_rect);
+        }
+        _cell_size = extent ? std::max(extent->maxExtent() / std::sqrt(double(refreshed.size())), 1e-3) : 1.0;
+    }
+    for (int index : refreshed) {
+        _gridInsert(_nodes[index], index);
+    }
+
+    bool const snap_to_clip = snapprefs.isTargetSnappable(SNAPTARGET_PATH_CLIP);
+    bool const snap_to_mask = snapprefs.isTargetSnappable(SNAPTARGET_PATH_MASK);
+    bool const snap_to_center = snapprefs.isTargetSnappable(SNAPTARGET_ROTATION_CENTER);
+    int const slot = bbox_slot(_bbox_type);
+    auto const display_area = desktop->get_display_area().bounds();
+
+    for (int index : _rangeQuery(display_area)) {
+        auto const &node = _nodes[index];
+        if ((node.clip_kind == IN_CLIP && !snap_to_clip) || (node.clip_kind == IN_MASK && !snap_to_mask)) {
+            continue;
+        }
+        if ((node.stop && ignoring_stoppers) || _isIgnored(index, ignored)) {
+            continue;
+        }
+        auto const &bbox = node.bbox[slot];
+        if (!bbox || !display_area.intersects(*bbox)) {
+            continue;
+        }
+
+        bool const clip_or_mask = node.clip_kind != NOT_CLIPPED;
+        Geom::Affine additional_affine = Geom::identity();
+        if (clip_or_mask) {
+            if (auto owner = _owner(node)) {
+                additional_affine = owner->i2doc_affine();
+            }
+        }
+        align_candidates.emplace_back(node.item, clip_or_mask, additional_affine);
+
+        // The rotation center might be outside of the bounding box
+        if (bbox_to_snap_incl.intersects(*bbox) ||
+            (snap_to_center && bbox_to_snap_incl.contains(node.center ? *node.center : node.item->getCenter()))) {
+            obj_candidates.emplace_back(node.item, clip_or_mask, additional_affine);
+        }
+
+        if (align_candidates.size() > MAX_ALIGN_CANDIDATES) {
+            static Glib::Timer timer;
+            if (timer.elapsed() > 1.0) {
+                timer.reset();
+                std::cerr << "Warning: limit of 200 snap target paths reached, some will be ignored" << std::endl;
+            }
+            break;
+        }
+    }
+}
+
+Geom::PathVector const *SnapTargetIndex::getPath(SnapCandidateItem const &candidate)
+{
+    auto it = _index_of_item.find(candidate.item);
+    if (it == _index_of_item.end() || !_desktop) {
+        return nullptr;
+    }
+    auto &node = _nodes[it->second];
+    if (!node.path) {
+        Geom::PathVector pathv;
+        // We might have a clone at hand, so make sure we get the root item
+        SPItem *root_item = candidate.item;
+        if (auto use = cast<SPUse>(candidate.item)) {
+            root_item = use->root();
+        }
+        if (root_item) {
+            auto const transform = root_item->i2dt_affine() * candidate.additional_affine * _desktop->doc2dt();
+            if (is<SPText>(root_item) || is<SPFlowtext>(root_item)) {
+                Text::Layout const *layout = te_get_layout(root_item);
+                if (layout && layout->outputExists()) {
+                    pathv.push_back(layout->baseline() * transform);
+                }
+            } else if (auto const shape = cast<SPShape>(root_item)) {
+                if (auto const curve = shape->curve()) {
+                    pathv = curve->get_pathvector() * transform;
+                }
+            }
+        }
+        node.path = std::move(pathv);
+    }
+    return node.path->empty() ? nullptr : &*node.path;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
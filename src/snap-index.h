@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_SNAP_INDEX_H
+#define SEEN_SNAP_INDEX_H
+
+/**
+ * @file
+ * Persistent spatial index of the items that can be snapped to.
+ */
+/*
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <2geom/pathvector.h>
+#include <2geom/rect.h>
+#include <sigc++/connection.h>
+
+#include "object/sp-item.h"
+#include "snap-candidate.h"
+
+class SPDesktop;
+class SPDocument;
+class SPObject;
+
+namespace Inkscape {
+
+class SnapPreferences;
+
+/**
+ * Mirror of the snappable part of the object tree, with the desktop bounding box of every
+ * item kept in a uniform grid so that finding the candidates near a dragged selection is a
+ * range query rather than a walk over the whole document.
+ *
+ * The index follows the document through the modified and release signals of the items it
+ * contains: geometry changes only refresh the affected entries, and the tree is walked again
+ * only when its structure (children, visibility, clips and masks) changes.
+ */
+class SnapTargetIndex
+{
+public:
+    SnapTargetIndex(SPDocument *document);
+    ~SnapTargetIndex();
+    SnapTargetIndex(SnapTargetIndex const &) = delete;
+    SnapTargetIndex &operator=(SnapTargetIndex const &) = delete;
+
+    /**
+     * Collect the items that are visible in the desktop's display area (for the alignment and
+     * distribution snappers) and the subset that lies within the snapping range (for the
+     * object snapper), in document order.
+     */
+    void findCandidates(SPDesktop const *desktop,
+                        SnapPreferences const &snapprefs,
+                        std::vector<SPObject const *> const *objects_to_ignore,
+                        Geom::Rect const &bbox_to_snap_incl,
+                        SPItem::BBoxType bbox_type,
+                        std::vector<SnapCandidateItem> &obj_candidates,
+                        std::vector<SnapCandidateItem> &align_candidates);
+
+    /**
+     * Outline of a candidate in desktop coordinates, i.e. its path or, for text, its baseline.
+     * Computed on first use and kept until the item changes.
+     */
+    Geom::PathVector const *getPath(SnapCandidateItem const &candidate);
+
+private:
+    enum ClipKind : std::uint8_t { NOT_CLIPPED, IN_CLIP, IN_MASK };
+
+    struct Node {
+        SPObject *object = nullptr;
+        SPItem *item = nullptr;         // null for clip path and mask containers
+        int parent = -1;                // enclosing group, or the clipped item for a container
+        int subtree_end = 0;            // one past the last node of this subtree
+        ClipKind clip_kind = NOT_CLIPPED;
+        bool hidden = false;
+        bool stop = false;              // hidden boolean operand, only snappable when not dragging one
+        bool leaf = false;
+        SPObject *clip = nullptr;       // recorded to detect a changed clip or mask
+        SPObject *mask = nullptr;
+        std::vector<SPObject *> children;
+
+        // Geometry of leaves, refreshed lazily
+        bool dirty = false;
+        bool stale = true;
+        bool in_grid = false;
+        Geom::OptRect bbox[2];
+        bool has_bbox[2] = {false, false};
+        Geom::OptRect grid_rect;
+        int cell_x0 = 0, cell_y0 = 0, cell_x1 = -1, cell_y1 = -1;
+        bool oversized = false;
+        std::optional<Geom::Point> center;
+        std::optional<Geom::PathVector> path;
+
+        sigc::connection modified_connection;
+        sigc::connection release_connection;
+    };
+
+    void _rebuild(SPDesktop const *desktop);
+    void _walk(SPObject *parent, int parent_index, ClipKind clip_kind, bool stop, SPDesktop const *desktop);
+    int _addNode(SPObject *object, int parent_index, ClipKind clip_kind);
+    void _clear();
+    bool _structureChanged(Node const &node, SPDesktop const *desktop) const;
+    void _processDirty(SPDesktop const *desktop);
+    void _markStale(int index);
+    void _refresh(Node &node, SPDesktop const *desktop);
+    void _gridInsert(Node &node, int index);
+    void _gridRemove(Node &node, int index);
+    void _regrid();
+    std::vector<int> _rangeQuery(Geom::Rect const &area);
+    bool _isIgnored(int index, std::unordered_set<SPObject const *> const &ignored) const;
+    SPItem *_owner(Node const &node) const;
+    static std::int64_t _cellKey(int x, int y);
+
+    SPDocument *_document;
+    SPDesktop const *_desktop = nullptr;
+    Geom::Affine _doc2dt;
+    SPItem::BBoxType _bbox_type = SPItem::VISUAL_BBOX;
+    bool _needs_rebuild = true;
+
+    std::vector<Node> _nodes;
+    std::vector<int> _leaves;
+    std::unordered_map<SPItem const *, int> _index_of_item;
+    std::vector<int> _dirty;
+    std::vector<int> _pending;
+
+    double _cell_size = 0;
+    std::unordered_map<std::int64_t, std::vector<int>> _cells;
+    std::vector<int> _oversized;
+    unsigned _query_stamp = 0;
+    std::vector<unsigned> _stamps;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_SNAP_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -20,17 +20,14 @@
 #include <utility>
 #include <vector>
 
-#include <glibmm/timer.h>
-
 #include <2geom/transforms.h>
 
 #include "snap.h"
 #include "snap-enums.h"
+#include "snap-index.h"
 #include "preferences.h"
 #include "object/sp-use.h"
 #include "object/sp-mask.h"
-#include "live_effects/effect-enum.h"
-#include "object/sp-filter.h"
 #include "object/sp-object.h"
 #include "object/sp-page.h"
 #include "object/sp-clippath.h"
@@ -833,11 +830,8 @@ SPPage const *SnapManager::getPageToIgnore() const
 }
 
 
-void SnapManager::_findCandidates(SPObject* parent,
-                                 std::vector<SPObject const *> const *it,
-                                 Geom::Rect const &bbox_to_snap,
-                                 bool const clip_or_mask,
-                                 Geom::Affine const additional_affine)
+void SnapManager::_findCandidates(std::vector<SPObject const *> const *it,
+                                  Geom::Rect const &bbox_to_snap)
 {
     SPDesktop const *dt = getDesktop();
     if (dt == nullptr) {
@@ -846,148 +840,33 @@ void SnapManager::_findCandidates(SPObject* parent,
         // Apparently the setup() method from the SnapManager class hasn't been called before trying to snap.
     }
 
-    static int recursion_level = 0;
-
-    if (recursion_level == 0) {
-        if (_findCandidates_already_called) { // In case we have already been called by another snapper,
-            return; // then we don't need to search for candidates again
-        }
-        _findCandidates_already_called = true;
-        _obj_snapper_candidates->clear();
-        _align_snapper_candidates->clear();
+    if (_findCandidates_already_called) { // In case we have already been called by another snapper,
+        return; // then we don't need to search for candidates again
     }
-    recursion_level++;
+    _findCandidates_already_called = true;
+    _obj_snapper_candidates->clear();
+    _align_snapper_candidates->clear();
 
     Geom::Rect bbox_to_snap_incl = bbox_to_snap; // _incl means: will include the snapper tolerance
     bbox_to_snap_incl.expandBy(object.getSnapperTolerance()); // see?
 
-    for (auto& o: parent->children) {
-        auto item = cast<SPItem>(&o);
-        if (item && !(dt->itemIsHidden(item) && !clip_or_mask)) {
-            // Fix LPE boolops self-snapping
-            bool stop = false;
-            if (item->style) {
-                SPFilter *filt = item->style->getFilter();
-                if (filt && filt->getId() && strcmp(filt->getId(), "selectable_hidder_filter") == 0) {
-                    stop = true;
-                }
-                auto lpeitem = cast<SPLPEItem>(item);
-                if (lpeitem && lpeitem->hasPathEffectOfType(Inkscape::LivePathEffect::EffectType::BOOL_OP)) {
-                    stop = true;
-                }
-            }
-            if (stop && it) {
-                stop = false;
-                for (auto skipitem : *it) {
-                    if (skipitem && skipitem->style) {
-                        auto toskip = cast<SPItem>(const_cast<SPObject *>(skipitem));
-                        if (toskip) {
-                            SPFilter *filt = toskip->style->getFilter();
-                            if (filt && filt->getId() && strcmp(filt->getId(), "selectable_hidder_filter") == 0) {
-                                stop = true;
-                                break;
-                            }
-
-                            auto lpeitem = cast<SPLPEItem>(toskip);
-                            if (!stop && lpeitem &&
-                                lpeitem->hasPathEffectOfType(Inkscape::LivePathEffect::EffectType::BOOL_OP)) {
-                                stop = true;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if (stop) {
-                    continue;
-                }
-            }
-            // Snapping to items in a locked layer is allowed
-            // Don't snap to hidden objects, unless they're a clipped path or a mask
-            /* See if this item is on the ignore list */
-            std::vector<SPObject const *>::const_iterator i;
-            if (it != nullptr) {
-                i = it->begin();
-                while (i != it->end() && *i != &o) {
-                    ++i;
-                }
-            }
-
-            if (it == nullptr || i == it->end()) {
-                if (item) {
-                    if (!clip_or_mask) { // cannot clip or mask more than once
-                        // The current item is not a clipping path or a mask, but might
-                        // still be the subject of clipping or masking itself ; if so, then
-                        // we should also consider that path or mask for snapping to
-                        SPObject *obj = item->getClipObject();
-                        if (obj && snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_PATH_CLIP)) {
-                            _findCandidates(obj, it, bbox_to_snap, true, item->i2doc_affine());
-                        }
-                        obj = item->getMaskObject();
-                        if (obj && snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_PATH_MASK)) {
-                            _findCandidates(obj, it, bbox_to_snap, true, item->i2doc_affine());
-                        }
-                    }
-
-                    if (is<SPGroup>(item)) {
-                        _findCandidates(&o, it, bbox_to_snap, clip_or_mask, additional_affine);
-                    } else {
-                        Geom::OptRect bbox_of_item;
-                        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
-                        int prefs_bbox = prefs->getBool("/tools/bounding_box", false);
-                        // We'll only need to obtain the visual bounding box if the user preferences tell
-                        // us to, AND if we are snapping to the bounding box itself. If we're snapping to
-                        // paths only, then we can just as well use the geometric bounding box (which is faster)
-                        SPItem::BBoxType bbox_type = (!prefs_bbox && snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_BBOX_CATEGORY)) ?
-                            SPItem::VISUAL_BBOX : SPItem::GEOMETRIC_BBOX;
-                        if (clip_or_mask) {
-                            // Oh oh, this will get ugly. We cannot use sp_item_i2d_affine directly because we need to
-                            // insert an additional transformation in document coordinates (code copied from sp_item_i2d_affine)
-                            bbox_of_item = item->bounds(bbox_type, item->i2doc_affine() * additional_affine * dt->doc2dt());
-                        } else {
-                            bbox_of_item = item->desktopBounds(bbox_type);
-                        }
-                        if (bbox_of_item) {
-                            bool overflow = false;
-                            // See if the item is within range
-                            auto display_area = getDesktop()->get_display_area().bounds();
-                            if (display_area.intersects(*bbox_of_item)) {
-                                // Finally add the object to _candidates.
-                                _align_snapper_candidates->push_back(Inkscape::SnapCandidateItem(item, clip_or_mask, additional_affine));
-                                // For debugging: print the id of the candidate to the console
-                                // SPObject *obj = (SPObject*)item;
-                                // std::cout << "Snap candidate added: " << obj->getId() << std::endl;
-
-                                if (bbox_to_snap_incl.intersects(*bbox_of_item)
-                                        || (snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_ROTATION_CENTER) && bbox_to_snap_incl.contains(item->getCenter()))) { // rotation center might be outside of the bounding box
-                                    // This item is within snapping range, so record it as a candidate
-                                    _obj_snapper_candidates->push_back(Inkscape::SnapCandidateItem(item, clip_or_mask, additional_affine));
-                                    // For debugging: print the id of the candidate to the console
-                                    // SPObject *obj = (SPObject*)item;
-                                    // std::cout << "Snap candidate added: " << obj->getId() << std::endl;
-                                }
-
-                                if (_align_snapper_candidates->size() > 200) { // This makes Inkscape crawl already
-                                    overflow = true;
-                                }
-                            }
-
-                            if (overflow) {
-                                static Glib::Timer timer;
-                                if (timer.elapsed() > 1.0) {
-                                    timer.reset();
-                                    std::cerr << "Warning: limit of 200 snap target paths reached, some will be ignored" << std::endl;
-                                }
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    recursion_level--;
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    int prefs_bbox = prefs->getBool("/tools/bounding_box", false);
+    // We'll only need to obtain the visual bounding box if the user preferences tell
+    // us to, AND if we are snapping to the bounding box itself. If we're snapping to
+    // paths only, then we can just as well use the geometric bounding box (which is faster)
+    SPItem::BBoxType bbox_type = (!prefs_bbox && snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_BBOX_CATEGORY)) ?
+        SPItem::VISUAL_BBOX : SPItem::GEOMETRIC_BBOX;
+
+    // The index persists between drags, so only the items that changed since the last
+    // lookup have their bounding boxes computed again
+    if (!_target_index) {
+        _target_index = std::make_unique<Inkscape::SnapTargetIndex>(getDocument());
+    }
+    _target_index->findCandidates(dt, snapprefs, it, bbox_to_snap_incl, bbox_type,
+                                  *_obj_snapper_candidates, *_align_snapper_candidates);
 }
+
 /*
   Local Variables:
   mode:c++
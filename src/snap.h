@@ -43,6 +43,7 @@ class SPNamedView;
 
 namespace Inkscape {
     class PureTransform;
+    class SnapTargetIndex;
 }
 
 
@@ -430,20 +431,16 @@ private:
 
     /**
      * Find all items within snapping range.
-     * @param parent Pointer to the document's root, or to a clipped path or mask object.
      * @param it List of items to ignore.
      * @param bbox_to_snap Bounding box hulling the whole bunch of points, all from the same selection and having the same transformation.
-     * @param clip_or_mask The parent object being passed is either a clip or mask.
      */
-    void _findCandidates(SPObject* parent,
-                       std::vector<SPObject const *> const *it,
-                       Geom::Rect const &bbox_to_snap,
-                       bool const _clip_or_mask,
-                       Geom::Affine const additional_affine);
+    void _findCandidates(std::vector<SPObject const *> const *it,
+                         Geom::Rect const &bbox_to_snap);
     bool _findCandidates_already_called;
 
     std::unique_ptr<std::vector<Inkscape::SnapCandidateItem>> _obj_snapper_candidates;
     std::unique_ptr<std::vector<Inkscape::SnapCandidateItem>> _align_snapper_candidates;
+    std::unique_ptr<Inkscape::SnapTargetIndex> _target_index; ///< Created on first use, follows the document afterwards
 
     friend class Inkscape::ObjectSnapper;
     friend class Inkscape::AlignmentSnapper;
@@ -906,6 +906,10 @@ std::vector<SPItem*> &Find::all_items (SPObject *r, std::vector<SPItem*> &l, boo
         return l; // we're not interested in metadata
     }
 
+    if (hidden) {
+        r->document->buildDeferred(r); // hidden layers may not have their children built yet
+    }
+
     auto desktop = getDesktop();
     for (auto& child: r->children) {
         auto item = cast<SPItem>(&child);
@@ -2256,6 +2256,10 @@ void InkscapePreferences::initPageIO()
     _page_io.add_line( false, "", _export_all_extensions, "",
                            _("Will list all possible output extensions in the Export Dialog selection."), true);
 
+    _load_lazy_build.init( _("Load hidden layers and unused definitions on demand"), "/options/loading/lazy_build", false);
+    _page_io.add_line( false, "", _load_lazy_build, "",
+                           _("Speeds up opening documents with large hidden layers by building their contents only when shown or needed. Takes effect for documents opened afterwards."), true);
+
     // Input devices options
     _mouse_sens.init ( "/options/cursortolerance/value", 0.0, 30.0, 1.0, 1.0, 8.0, true, false);
     _page_mouse.add_line( false, _("_Grab sensitivity:"), _mouse_sens, _("pixels"),
@@ -2823,9 +2827,9 @@ void InkscapePreferences::initPageRendering()
 
     // update strategy
     {
-        constexpr int values[] = { 1, 2, 3 };
-        Glib::ustring const labels[] = { _("Responsive"), _("Full redraw"), _("Multiscale") };
-        _canvas_update_strategy.init("/options/rendering/update_strategy", labels, values, 3, 3);
+        constexpr int values[] = { 1, 2, 3, 4 };
+        Glib::ustring const labels[] = { _("Responsive"), _("Full redraw"), _("Multiscale"), _("Progressive") };
+        _canvas_update_strategy.init("/options/rendering/update_strategy", labels, values, 4, 3);
         _page_rendering.add_line(false, _("Update strategy:"), _canvas_update_strategy, "", _("How to update continually changing content when it can't be redrawn fast enough"), false);
     }
 
@@ -430,6 +430,7 @@ protected:
     UI::Widget::PrefCheckButton _misc_comment;
     UI::Widget::PrefCheckButton _misc_default_metadata;
     UI::Widget::PrefCheckButton _export_all_extensions;
+    UI::Widget::PrefCheckButton _load_lazy_build;
     UI::Widget::PrefCheckButton _misc_forkvectors;
     UI::Widget::PrefSpinButton  _misc_gradientangle;
     UI::Widget::PrefSpinButton  _recently_used_fonts_size;
@@ -491,6 +491,15 @@ void ObjectWatcher::addChildren(SPItem *obj, bool dummy)
 {
     assert(child_watchers.empty());
 
+    // Children of hidden layers may be left unbuilt until the layer is expanded
+    if (!dummy) {
+        obj->document->buildDeferred(obj);
+    } else if (!is_filtered && row_ref && obj->document->hasDeferred(obj)) {
+        // one dummy child is enough to make the group expandable
+        panel->_store->append(getChildren());
+        return;
+    }
+
     for (auto &child : obj->children) {
         if (auto item = cast<SPItem>(&child)) {
             if (addChild(item, dummy) && dummy) {
@@ -36,6 +36,7 @@
 #include "canvas/util.h"
 #include "color/cms-system.h"     // Color correction
 #include "color.h"          // Background color
+#include "debug/trace.h"    // Render tracing
 #include "desktop-events.h"
 #include "desktop.h"
 #include "display/control/canvas-item-drawing.h"
@@ -104,12 +105,16 @@ namespace {
  * Utilities
  */
 
+// Factor by which the resolution is reduced for preview passes.
+constexpr int PREVIEW_SCALE = 4;
+
 // Convert an integer received from preferences into an Updater enum.
 auto pref_to_updater(int index)
 {
     constexpr auto arr = std::array{Updater::Strategy::Responsive,
                                     Updater::Strategy::FullRedraw,
-                                    Updater::Strategy::Multiscale};
+                                    Updater::Strategy::Multiscale,
+                                    Updater::Strategy::Progressive};
     assert(1 <= index && index <= arr.size());
     return arr[index - 1];
 }
@@ -179,6 +184,7 @@ struct RedrawData
     Cairo::RefPtr<Cairo::Region> clean;
     bool interruptible;
     bool preemptible;
+    bool preview;
     std::vector<Geom::IntRect> rects;
     int effective_tile_size;
 
@@ -283,8 +289,8 @@ public:
     bool end_redraw(); // returns true to indicate further redraw cycles required
     void process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible = true, bool preemptible = true);
     void render_tile(int debug_id);
-    void paint_rect(Geom::IntRect const &rect);
-    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass);
+    void paint_rect(Geom::IntRect const &rect, bool preview = false);
+    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass, bool preview = false);
     void paint_error_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface);
 
     // Trivial overload of GtkWidget function.
@@ -2080,6 +2086,7 @@ bool CanvasPrivate::init_redraw()
                 // The main priority to redraw, and the bread and butter of Inkscape's painting, is the visible content that is not clean.
                 // This may be done over several cycles, at the direction of the Updater, each outwards from the mouse.
                 process_redraw(*rd.vis_store, updater->get_next_clean_region());
+                rd.preview = updater->is_preview_pass();
                 return true;
             } else {
                 rd.phase++;
@@ -2113,6 +2120,7 @@ void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Ca
     rd.clean = std::move(clean);
     rd.interruptible = interruptible;
     rd.preemptible = preemptible;
+    rd.preview = false;
 
     // Assert that we do not render outside of store.
     assert(rd.store.rect.contains(rd.bounds));
@@ -2211,13 +2219,21 @@ void CanvasPrivate::render_tile(int debug_id)
             }
         }
 
-        // Mark the rectangle as clean.
-        updater->mark_clean(rect);
+        // Mark the rectangle as clean, or as previewed if it is only to be painted roughly for now.
+        bool const preview = rd.preview;
+        if (preview) {
+            updater->mark_previewed(rect);
+        } else {
+            updater->mark_clean(rect);
+        }
 
         rd.mutex.unlock();
 
         // Paint the rectangle.
-        paint_rect(rect);
+        {
+            auto const span = Inkscape::Debug::TraceSpan(preview ? "canvas tile preview" : "canvas tile", "canvas");
+            paint_rect(rect, preview);
+        }
 
         rd.mutex.lock();
 
@@ -2276,7 +2292,7 @@ bool CanvasPrivate::end_redraw()
     }
 }
 
-void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
+void CanvasPrivate::paint_rect(Geom::IntRect const &rect, bool preview)
 {
     // Make sure the paint rectangle lies within the store.
     assert(rd.store.rect.contains(rect));
@@ -2294,7 +2310,7 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
 
         try {
 
-            paint_single_buffer(surface, rect, need_background, outline_pass);
+            paint_single_buffer(surface, rect, need_background, outline_pass, preview);
 
         } catch (std::bad_alloc const &) {
             // Note: std::bad_alloc actually indicates a Cairo error that occurs regularly at high zoom, and we must handle it.
@@ -2330,7 +2346,7 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
     }
 }
 
-void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass)
+void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass, bool preview)
 {
     // Create Cairo context.
     auto cr = Cairo::Context::create(surface);
@@ -2346,8 +2362,28 @@ void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const
     cr->restore();
 
     // Render drawing on top of background.
-    auto buf = Inkscape::CanvasItemBuffer{ rect, scale_factor, cr, outline_pass };
-    canvasitem_ctx->root()->render(buf);
+    if (!preview) {
+        auto buf = Inkscape::CanvasItemBuffer{ rect, scale_factor, cr, outline_pass };
+        canvasitem_ctx->root()->render(buf);
+    } else {
+        // Render at reduced resolution and without filters onto a smaller surface, then scale it up onto the tile.
+        int const width  = (rect.width()  * scale_factor + PREVIEW_SCALE - 1) / PREVIEW_SCALE;
+        int const height = (rect.height() * scale_factor + PREVIEW_SCALE - 1) / PREVIEW_SCALE;
+        auto preview_surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+        auto preview_cr = Cairo::Context::create(preview_surface);
+        preview_cr->scale((double)scale_factor / PREVIEW_SCALE, (double)scale_factor / PREVIEW_SCALE);
+        auto buf = Inkscape::CanvasItemBuffer{ rect, 1, preview_cr, outline_pass, true };
+        canvasitem_ctx->root()->render(buf);
+
+        auto pattern = Cairo::SurfacePattern::create(preview_surface);
+        pattern->set_filter(Cairo::FILTER_BILINEAR);
+        pattern->set_extend(Cairo::EXTEND_PAD);
+        cr->save();
+        cr->scale((double)PREVIEW_SCALE / scale_factor, (double)PREVIEW_SCALE / scale_factor);
+        cr->set_source(pattern);
+        cr->paint();
+        cr->restore();
+    }
 
     // Apply CMS transform.
     if (rd.cms_transform) {
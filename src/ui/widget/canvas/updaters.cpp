@@ -16,8 +16,10 @@ public:
     void mark_dirty(Geom::IntRect const &rect)               override { clean_region->subtract(geom_to_cairo(rect)); }
     void mark_dirty(Cairo::RefPtr<Cairo::Region> const &reg) override { clean_region->subtract(reg); }
     void mark_clean(Geom::IntRect const &rect)               override { clean_region->do_union(geom_to_cairo(rect)); }
+    void mark_previewed(Geom::IntRect const &)               override {}
 
     Cairo::RefPtr<Cairo::Region> get_next_clean_region() override { return clean_region; }
+    bool                         is_preview_pass() const override { return false; }
     bool                         report_finished      () override { return false; }
     void                         next_frame           () override {}
 };
@@ -204,9 +206,94 @@ public:
     }
 };
 
+class ProgressiveUpdater : public ResponsiveUpdater
+{
+    // The subregion of the store that is not clean, but has been painted by a preview pass.
+    Cairo::RefPtr<Cairo::Region> previewed_region = Cairo::Region::create();
+
+    // Whether the current redraw is a preview pass.
+    bool previewing = false;
+
+    // Whether the next redraw should refine the previewed region rather than preview what is left.
+    bool refine = false;
+
+public:
+    Strategy get_strategy() const override { return Strategy::Progressive; }
+
+    void reset() override
+    {
+        ResponsiveUpdater::reset();
+        previewed_region = Cairo::Region::create();
+        previewing = refine = false;
+    }
+
+    void intersect(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::intersect(rect);
+        previewed_region->intersect(geom_to_cairo(rect));
+    }
+
+    void mark_dirty(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::mark_dirty(rect);
+        previewed_region->subtract(geom_to_cairo(rect));
+        refine = false; // Preview the new damage before carrying on.
+    }
+
+    void mark_dirty(Cairo::RefPtr<Cairo::Region> const &reg) override
+    {
+        ResponsiveUpdater::mark_dirty(reg);
+        previewed_region->subtract(reg);
+        if (!reg->empty()) refine = false;
+    }
+
+    void mark_clean(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::mark_clean(rect);
+        previewed_region->subtract(geom_to_cairo(rect));
+    }
+
+    void mark_previewed(Geom::IntRect const &rect) override
+    {
+        previewed_region->do_union(geom_to_cairo(rect));
+    }
+
+    Cairo::RefPtr<Cairo::Region> get_next_clean_region() override
+    {
+        previewing = !refine;
+        if (!previewing) {
+            return clean_region;
+        } else {
+            // Only preview what has been neither drawn nor previewed.
+            auto result = clean_region->copy();
+            result->do_union(previewed_region);
+            return result;
+        }
+    }
+
+    bool is_preview_pass() const override { return previewing; }
+
+    bool report_finished() override
+    {
+        if (previewing) {
+            // Completed preview => ask for another redraw to refine it.
+            previewing = false;
+            refine = true;
+            return true;
+        } else {
+            // Completed refinement => finished.
+            refine = false;
+            return false;
+        }
+    }
+
+    void next_frame() override {}
+};
+
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Responsive>() {return std::make_unique<ResponsiveUpdater>();}
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::FullRedraw>() {return std::make_unique<FullRedrawUpdater>();}
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Multiscale>() {return std::make_unique<MultiscaleUpdater>();}
+template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Progressive>() {return std::make_unique<ProgressiveUpdater>();}
 
 std::unique_ptr<Updater> Updater::create(Strategy strategy)
 {
@@ -215,6 +302,7 @@ std::unique_ptr<Updater> Updater::create(Strategy strategy)
         case Strategy::Responsive: return create<Strategy::Responsive>();
         case Strategy::FullRedraw: return create<Strategy::FullRedraw>();
         case Strategy::Multiscale: return create<Strategy::Multiscale>();
+        case Strategy::Progressive: return create<Strategy::Progressive>();
         default: return nullptr; // Never triggered, but GCC errors out on build without.
     }
 }
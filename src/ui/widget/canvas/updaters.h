@@ -32,6 +32,7 @@ public:
         Responsive, // As soon as a region is invalidated, redraw it.
         FullRedraw, // When a region is invalidated, delay redraw until after the current redraw is completed.
         Multiscale, // Updates tiles near the mouse faster. Gives the best of both.
+        Progressive, // Quickly fill invalidated regions with a low-quality preview, then redraw them properly.
     };
 
     // Create an Updater using the given strategy.
@@ -49,10 +50,14 @@ public:
     virtual void mark_dirty(Geom::IntRect const &) = 0;                // Called on every invalidate event.
     virtual void mark_dirty(Cairo::RefPtr<Cairo::Region> const &) = 0; // Called on every invalidate event.
     virtual void mark_clean(Geom::IntRect const &) = 0;                // Called on every rectangle redrawn.
+    virtual void mark_previewed(Geom::IntRect const &) = 0;            // Called instead on every rectangle redrawn by a preview pass.
 
     // Called at the start of a redraw to determine what region to consider clean (i.e. will not be drawn).
     virtual Cairo::RefPtr<Cairo::Region> get_next_clean_region() = 0;
 
+    // Called after get_next_clean_region() to determine whether the redraw is a preview pass, to be painted at reduced quality.
+    virtual bool is_preview_pass() const = 0;
+
     // Called after a redraw has finished. Returns true to indicate that further redraws are required with different clean regions.
     virtual bool report_finished() = 0;
 
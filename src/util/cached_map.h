@@ -16,6 +16,7 @@
 #include <unordered_map>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <algorithm>
 
 namespace Inkscape {
@@ -40,10 +41,13 @@ namespace Util {
  * it is not immediately deleted. As further objects are marked as unused, the oldest unused
  * objects are gradually deleted, with their number never exceeding the value max_cache_size.
  *
- * Note that the cache must not be destroyed while any shared pointers to any of its objects are
- * still active. This is in accord with its expected usage; if the factory loads objects from an
- * external library, then it should be safe to destroy the cache just before the library is
- * unloaded, as the objects should no longer be in use at that point anyway.
+ * The map may be used from several threads at once, and the shared pointers it hands out may be
+ * released on any thread.
+ *
+ * Note that the cache must not be destroyed or cleared while any shared pointers to any of its
+ * objects are still active. This is in accord with its expected usage; if the factory loads
+ * objects from an external library, then it should be safe to destroy the cache just before the
+ * library is unloaded, as the objects should no longer be in use at that point anyway.
  */
 template <typename Tk, typename Tv, typename Hash = std::hash<Tk>, typename Compare = std::equal_to<Tk>>
 class cached_map
@@ -65,8 +69,9 @@ public:
      */
     auto add(Tk key, std::unique_ptr<Tv> value)
     {
+        auto lock = std::lock_guard(mutex);
         auto ret = map.emplace(std::move(key), std::move(value));
-        return get_view(ret.first->second);
+        return get_view(*ret.first);
     }
 
     /**
@@ -76,8 +81,9 @@ public:
      */
     auto lookup(Tk const &key) -> std::shared_ptr<Tv>
     {
+        auto lock = std::lock_guard(mutex);
         if (auto it = map.find(key); it != map.end()) {
-            return get_view(it->second);
+            return get_view(*it);
         } else {
             return {};
         }
@@ -85,6 +91,7 @@ public:
 
     void clear()
     {
+        auto lock = std::lock_guard(mutex);
         unused.clear();
         map.clear();
     }
@@ -94,38 +101,56 @@ private:
     {
         std::unique_ptr<Tv> value; // The unique_ptr owning the actual value.
         std::weak_ptr<Tv> view; // A non-owning shared_ptr view that is in use by the outside world.
+        std::size_t views = 0; // The number of views whose deleter has not yet run.
+        bool is_unused = false; // Whether the entry is queued in unused.
         Item(decltype(value) value) : value(std::move(value)) {}
     };
 
+    using Entry = typename std::unordered_map<Tk, Item, Hash, Compare>::value_type;
+
     std::size_t const max_cache_size;
     std::unordered_map<Tk, Item, Hash, Compare> map;
-    std::deque<Tv*> unused;
+    std::deque<Entry*> unused;
+    std::mutex mutex;
 
-    auto get_view(Item &item)
+    auto get_view(Entry &entry)
     {
+        auto &item = entry.second;
         if (auto view = item.view.lock()) {
             return view;
         } else {
-            remove_unused(item.value.get());
-            auto new_view = std::shared_ptr<Tv>(item.value.get(), [this] (Tv *value) {
-                push_unused(value);
+            remove_unused(entry);
+            // Entries are never erased while a deleter is pending, so it can point back to this one.
+            auto new_view = std::shared_ptr<Tv>(item.value.get(), [this, &entry] (Tv *) {
+                push_unused(entry);
             });
             item.view = new_view;
+            item.views++;
             return new_view;
         }
     }
 
-    void remove_unused(Tv *value)
+    void remove_unused(Entry &entry)
     {
-        auto it = std::find(unused.begin(), unused.end(), value);
-        if (it != unused.end()) {
-            unused.erase(it);
+        if (entry.second.is_unused) {
+            unused.erase(std::find(unused.begin(), unused.end(), &entry));
+            entry.second.is_unused = false;
         }
     }
 
-    void push_unused(Tv *value)
+    void push_unused(Entry &entry)
     {
-        unused.emplace_back(value);
+        auto lock = std::lock_guard(mutex);
+
+        // Another thread may have handed out a new view between this one expiring and this call,
+        // in which case the value is only unused once that view's deleter has run too.
+        auto &item = entry.second;
+        if (--item.views > 0) {
+            return;
+        }
+
+        item.is_unused = true;
+        unused.emplace_back(&entry);
         if (unused.size() > max_cache_size) {
             pop_unused();
         }
@@ -133,11 +158,9 @@ private:
 
     void pop_unused()
     {
-        auto value = unused.front();
-        map.erase(std::find_if(map.begin(), map.end(), [value] (auto const &it) {
-            return it.second.value.get() == value;
-        }));
+        auto entry = unused.front();
         unused.pop_front();
+        map.erase(map.find(entry->first));
     }
 };
 
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** \file
+ * Run independent jobs on a pool of worker threads.
+ */
+
+#include "parallel.h"
+
+#include <thread>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "preferences.h"
+
+namespace Inkscape {
+namespace Util {
+
+static std::atomic<int> num_threads = 0;
+
+int get_num_threads()
+{
+    if (int n = num_threads.load(std::memory_order_relaxed); n > 0) {
+        return n;
+    }
+    int const n = Preferences::get()->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256);
+    num_threads.store(n, std::memory_order_relaxed);
+    return n;
+}
+
+void set_num_threads(int n)
+{
+    num_threads.store(std::max(n, 1), std::memory_order_relaxed);
+}
+
+void post_to_thread_pool(std::function<void()> job)
+{
+    // Worker threads may be the first to get here, so this can't be a Static<>. The threads
+    // are idle by the end of main(), and are joined when the pool is destroyed.
+    static boost::asio::thread_pool pool(get_num_threads());
+    boost::asio::post(pool, std::move(job));
+}
+
+} // namespace Util
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** \file
+ * Run independent jobs on a pool of worker threads.
+ */
+#ifndef INKSCAPE_UTIL_PARALLEL_H
+#define INKSCAPE_UTIL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Inkscape {
+namespace Util {
+
+/**
+ * The number of worker threads set in the preferences, at least one.
+ * Read from the preferences on first use, then kept up to date by set_num_threads().
+ */
+int get_num_threads();
+void set_num_threads(int n);
+
+/**
+ * Run a job on the thread pool shared by all parallel_for() calls.
+ *
+ * The pool is created on first use with get_num_threads() threads and lives until
+ * the end of the program, so no threads are started and joined per call.
+ */
+void post_to_thread_pool(std::function<void()> job);
+
+/**
+ * Call f(i) for every i in [0, n) and wait for all of them to finish.
+ *
+ * The calls are spread over the calling thread and up to \a numthreads - 1 threads
+ * of the shared pool, or made in order on the calling thread when there is nothing
+ * to gain. Since the calling thread takes part, parallel_for() may be nested: jobs
+ * which the pool is too busy to start are simply done by the caller.
+ *
+ * f must not touch the document or anything else shared without its own locking.
+ * The first exception thrown by f is rethrown once all calls have finished.
+ */
+template <typename F>
+void parallel_for(std::size_t n, F &&f, int numthreads = get_num_threads())
+{
+    auto const threads = std::min<std::size_t>(std::max(numthreads, 1), n);
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+
+    // Helpers started after all indices have been claimed still see this state, so it is shared.
+    struct State
+    {
+        std::size_t n;
+        std::atomic<std::size_t> next = 0;
+        std::atomic<bool> cancelled = false;
+        std::size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->n = n;
+
+    auto work = [state, &f] {
+        std::size_t count = 0;
+        for (std::size_t i; (i = state->next++) < state->n; count++) {
+            if (state->cancelled) {
+                continue;
+            }
+            try {
+                f(i);
+            } catch (...) {
+                auto lock = std::lock_guard(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+                state->cancelled = true;
+            }
+        }
+        if (count > 0) {
+            auto lock = std::lock_guard(state->mutex);
+            state->done += count;
+            if (state->done == state->n) {
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    for (std::size_t t = 1; t < threads; t++) {
+        post_to_thread_pool(work);
+    }
+    work();
+
+    auto lock = std::unique_lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done == state->n; });
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace Util
+} // namespace Inkscape
+
+#endif // INKSCAPE_UTIL_PARALLEL_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
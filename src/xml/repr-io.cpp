@@ -11,10 +11,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <climits>
 #include <cstring>
 #include <string>
 #include <stdexcept>
 
+#include <gio/gio.h>
 #include <libxml/parser.h>
 #include <libxml/xinclude.h>
 
@@ -74,7 +76,9 @@ public:
           fp(nullptr),
           firstFewLen(0),
           instr(nullptr),
-          gzin(nullptr)
+          gzin(nullptr),
+          mapped(nullptr),
+          mappedSkip(0)
     {
         for (unsigned char & k : firstFew)
         {
@@ -101,6 +105,8 @@ public:
     int read( char * buffer, int len );
     int close();
 private:
+    bool mapFile();
+
     const char* filename;
     char* encoding;
     FILE* fp;
@@ -108,14 +114,79 @@ private:
     int firstFewLen;
     Inkscape::IO::FileInputStream* instr;
     Inkscape::IO::GzipInputStream* gzin;
+    GMappedFile* mapped;
+    size_t mappedSkip;
 };
 
+/**
+ * Map an uncompressed file into memory, so that libxml2 can parse it in place without copying
+ * it through read callbacks. Compressed files, stdin, files on remote file systems and files
+ * that cannot be mapped are left to the stream based path.
+ *
+ * Note that if a mapped file is truncated by another process while it is parsed, reading past
+ * its new end raises SIGBUS instead of a read error. Remote file systems are not mapped, as they
+ * are where that is most likely, and a failing server would have the same effect.
+ */
+bool XmlSource::mapFile()
+{
+    if (!strcmp(filename, "-")) {
+        return false;
+    }
+
+    gchar *local = g_filename_from_utf8(filename, -1, nullptr, nullptr, nullptr);
+    if (!local) {
+        return false;
+    }
+
+    GFile *file = g_file_new_for_path(local);
+    GFileInfo *info = g_file_query_filesystem_info(file, G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE, nullptr, nullptr);
+    bool const remote = !info || g_file_info_get_attribute_boolean(info, G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE);
+    if (info) {
+        g_object_unref(info);
+    }
+    g_object_unref(file);
+
+    if (!remote) {
+        mapped = g_mapped_file_new(local, FALSE, nullptr);
+    }
+    g_free(local);
+    if (!mapped) {
+        return false;
+    }
+
+    auto const data = reinterpret_cast<unsigned char const *>(g_mapped_file_get_contents(mapped));
+    auto const len = g_mapped_file_get_length(mapped);
+
+    // xmlReadMemory takes an int length.
+    if (!data || len < 2 || len > INT_MAX || (data[0] == 0x1f && data[1] == 0x8b)) {
+        g_mapped_file_unref(mapped);
+        mapped = nullptr;
+        return false;
+    }
+
+    if ( (data[0] == 0xfe) && (data[1] == 0xff) ) {
+        encoding = g_strdup("UTF-16BE");
+        mappedSkip = 2;
+    } else if ( (data[0] == 0xff) && (data[1] == 0xfe) ) {
+        encoding = g_strdup("UTF-16LE");
+        mappedSkip = 2;
+    } else if ( (len >= 3) && (data[0] == 0xef) && (data[1] == 0xbb) && (data[2] == 0xbf) ) {
+        encoding = g_strdup("UTF-8");
+        mappedSkip = 3;
+    }
+    return true;
+}
+
 int XmlSource::setFile(char const *filename)
 {
     int retVal = -1;
 
     this->filename = filename;
 
+    if (mapFile()) {
+        return 0;
+    }
+
     fp = Inkscape::IO::fopen_utf8name(filename, "r");
     if ( fp ) {
         // First peek in the file to see what it is
@@ -178,6 +249,14 @@ xmlDocPtr XmlSource::readXml()
     bool allowNetAccess = prefs->getBool("/options/externalresources/xml/allow_net_access", false);
     if (!allowNetAccess) parse_options |= XML_PARSE_NONET;
 
+    if (mapped) {
+        auto const data = g_mapped_file_get_contents(mapped) + mappedSkip;
+        auto const len = static_cast<int>(g_mapped_file_get_length(mapped) - mappedSkip);
+        auto doc = xmlReadMemory(data, len, filename, getEncoding(), parse_options);
+        close();
+        return doc;
+    }
+
     return xmlReadIO(readCb, closeCb, this, filename, getEncoding(), parse_options);
 }
 
@@ -215,16 +294,8 @@ int XmlSource::read( char *buffer, int len )
         firstFewLen -= some;
         got = some;
     } else if ( gzin ) {
-        int single = 0;
-        while ( (static_cast<int>(got) < len) && (single >= 0) )
-        {
-            single = gzin->get();
-            if ( single >= 0 ) {
-                buffer[got++] = 0x0ff & single;
-            } else {
-                break;
-            }
-        }
+        int some = gzin->read(reinterpret_cast<unsigned char *>(buffer), len);
+        got = (some > 0) ? some : 0;
     } else {
         got = fread( buffer, 1, len, fp );
     }
@@ -257,6 +328,10 @@ int XmlSource::close()
         fclose(fp);
         fp = nullptr;
     }
+    if ( mapped ) {
+        g_mapped_file_unref(mapped);
+        mapped = nullptr;
+    }
     return 0;
 }
 
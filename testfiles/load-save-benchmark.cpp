@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Document load/save benchmark.
+ *
+ * Generates synthetic SVG documents scaled by node count, attribute size and stylesheet size,
+ * then times each phase of loading and saving them in isolation:
+ *
+ *   read     parse the file into an XML tree (sp_repr_read_file)
+ *   build    construct the SPObject tree, including reading style attributes
+ *   update   the first SPDocument::ensureUpToDate()
+ *   restyle  a full style cascade against the stylesheet, as after editing a <style> element
+ *   save     serialise the XML tree back to disk (sp_repr_save_file)
+ *   destroy  release the document
+ *
+ * The peak resident set size is reported after each phase. Since it only ever grows, the
+ * documents are processed from smallest to largest.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <giomm/init.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "debug/timestamp.h"
+#include "debug/trace.h"
+#include "inkgc/gc-core.h"
+#include "object/sp-object.h"
+#include "object/sp-root.h"
+#include "util/statics.h"
+#include "xml/repr.h"
+
+namespace {
+
+using Inkscape::Debug::timestamp_ns;
+
+struct Options
+{
+    std::vector<int> nodes = { 1000, 10000, 100000 };
+    std::vector<int> attr_sizes = { 32, 1024 };
+    std::vector<int> rules = { 0, 100, 1000 };
+    int repeat = 3;
+};
+
+struct Config
+{
+    int nodes;
+    int attr_size;
+    int rules;
+};
+
+/// Peak resident set size of the process in kilobytes, or -1 if unknown.
+long peak_rss_kb()
+{
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+template <typename T>
+std::vector<T> parse_list(std::string const &s)
+{
+    std::vector<T> result;
+    std::istringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        std::istringstream conv(item);
+        T value;
+        if (conv >> value) {
+            result.push_back(value);
+        }
+    }
+    return result;
+}
+
+void usage()
+{
+    std::cerr << "Usage: load_save_benchmark [options]\n"
+                 "  --nodes=1000,10000,100000   number of shapes in each document\n"
+                 "  --attr-sizes=32,1024        approximate length of each path's data in bytes\n"
+                 "  --rules=0,100,1000          number of rules in the document stylesheet\n"
+                 "  --repeat=3                  runs per document; the median of each phase is reported\n";
+}
+
+bool parse_options(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++) {
+        auto const arg = std::string(argv[i]);
+        auto const eq = arg.find('=');
+        auto const name = arg.substr(0, eq);
+        auto const value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+        if (name == "--nodes") {
+            opts.nodes = parse_list<int>(value);
+        } else if (name == "--attr-sizes") {
+            opts.attr_sizes = parse_list<int>(value);
+        } else if (name == "--rules") {
+            opts.rules = parse_list<int>(value);
+        } else if (name == "--repeat") {
+            opts.repeat = std::max(1, std::atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    return !opts.nodes.empty() && !opts.attr_sizes.empty() && !opts.rules.empty();
+}
+
+/**
+ * Write a synthetic document: a stylesheet of class, id and descendant rules, followed by
+ * paths nested ten to a group, each with its own style attribute and a class from the sheet.
+ */
+void write_document(std::string const &filename, Config const &config)
+{
+    auto out = std::ofstream(filename);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\" viewBox=\"0 0 1000 1000\">\n";
+
+    if (config.rules > 0) {
+        out << "<style>\n";
+        for (int i = 0; i < config.rules; i++) {
+            switch (i % 3) {
+                case 0:
+                {
+                    char color[8];
+                    std::snprintf(color, sizeof(color), "%06x", i * 2654435761u & 0xffffff);
+                    out << ".c" << i << " { fill: #" << color << "; }\n";
+                    break;
+                }
+                case 1:
+                    out << "#p" << i << " { stroke-width: " << i % 7 + 1 << "px; }\n";
+                    break;
+                default:
+                    out << "g > path.c" << i << " { opacity: 0.5; stroke: blue; }\n";
+                    break;
+            }
+        }
+        out << "</style>\n";
+    }
+
+    std::uint32_t state = 1;
+    auto rand = [&] {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) % 1000;
+    };
+
+    for (int i = 0; i < config.nodes; i++) {
+        if (i % 10 == 0) {
+            out << "<g id=\"g" << i / 10 << "\">\n";
+        }
+
+        out << "<path id=\"p" << i << "\"";
+        if (config.rules > 0) {
+            out << " class=\"c" << i % config.rules << "\"";
+        }
+        out << " style=\"fill-opacity:0.8;stroke:#000000;stroke-linejoin:round\" d=\"M " << rand() << "," << rand();
+        for (int written = 0; written < config.attr_size; written += 16) {
+            out << " L " << rand() << "," << rand();
+        }
+        out << " Z\"/>\n";
+
+        if (i % 10 == 9 || i == config.nodes - 1) {
+            out << "</g>\n";
+        }
+    }
+
+    out << "</svg>\n";
+}
+
+using Phases = std::vector<std::tuple<char const *, std::int64_t, long>>;
+
+/// Load and save a document once, returning the time and peak memory after each phase.
+Phases run_once(std::string const &in_file, std::string const &out_file)
+{
+    Phases phases;
+    auto start = timestamp_ns();
+    auto phase = [&] (char const *name) {
+        auto const now = timestamp_ns();
+        phases.emplace_back(name, now - start, peak_rss_kb());
+        start = timestamp_ns();
+    };
+
+    auto rdoc = sp_repr_read_file(in_file.c_str(), SP_SVG_NS_URI);
+    phase("read");
+    if (!rdoc) {
+        std::cerr << "Failed to read the generated document\n";
+        return {};
+    }
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createDoc(rdoc, in_file.c_str(), nullptr, "benchmark", false, nullptr));
+    phase("build");
+
+    doc->ensureUpToDate();
+    phase("update");
+
+    // Re-read every style from the stylesheet and attributes, as after editing a <style> element.
+    auto const first = doc->getObjectById("p0");
+    bool restyled = !first;
+    sigc::connection connection;
+    if (first) {
+        connection = first->connectModified([&] (SPObject *, unsigned flags) {
+            restyled |= (bool)(flags & SP_OBJECT_STYLE_MODIFIED_FLAG);
+        });
+    }
+    doc->getRoot()->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG |
+                                         SP_OBJECT_STYLESHEET_MODIFIED_FLAG);
+    doc->ensureUpToDate();
+    phase("restyle");
+    connection.disconnect();
+    if (!restyled) {
+        std::cerr << "Restyling did not reach the paths of the document\n";
+        return {};
+    }
+
+    sp_repr_save_file(doc->getReprDoc(), out_file.c_str(), SP_SVG_NS_URI);
+    phase("save");
+
+    doc.reset();
+    phase("destroy");
+
+    return phases;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    auto opts = Options();
+    if (!parse_options(argc, argv, opts)) {
+        usage();
+        return 2;
+    }
+
+    Gio::init();
+    Inkscape::GC::init();
+    Inkscape::Debug::Trace::init();
+    Inkscape::Application::create(false);
+
+    auto const in_file = Glib::build_filename(Glib::get_tmp_dir(), "inkscape-load-save-benchmark-in.svg");
+    auto const out_file = Glib::build_filename(Glib::get_tmp_dir(), "inkscape-load-save-benchmark-out.svg");
+
+    std::vector<Config> configs;
+    for (auto nodes : opts.nodes) {
+        for (auto attr_size : opts.attr_sizes) {
+            for (auto rules : opts.rules) {
+                configs.push_back({ nodes, attr_size, rules });
+            }
+        }
+    }
+    std::stable_sort(configs.begin(), configs.end(), [] (auto const &a, auto const &b) {
+        return (long)a.nodes * a.attr_size < (long)b.nodes * b.attr_size;
+    });
+
+    int status = 0;
+    std::printf("%8s %6s %6s %10s %-8s %12s %14s\n", "nodes", "attr", "rules", "size (kB)", "phase", "time (ms)", "peak RSS (MB)");
+
+    for (auto const &config : configs) {
+        write_document(in_file, config);
+        auto const in_size = [&] {
+            auto f = std::ifstream(in_file, std::ios::binary | std::ios::ate);
+            return (long)f.tellg() / 1024;
+        }();
+
+        std::vector<Phases> runs;
+        for (int i = 0; i < opts.repeat; i++) {
+            runs.push_back(run_once(in_file, out_file));
+            if (runs.back().empty()) {
+                status = 1;
+                break;
+            }
+        }
+        if (status) {
+            break;
+        }
+
+        for (std::size_t p = 0; p < runs.front().size(); p++) {
+            std::vector<std::int64_t> times;
+            long rss = -1;
+            for (auto const &run : runs) {
+                times.push_back(std::get<1>(run[p]));
+                rss = std::max(rss, std::get<2>(run[p]));
+            }
+            std::sort(times.begin(), times.end());
+            std::printf("%8d %6d %6d %10ld %-8s %12.3f %14.1f\n", config.nodes, config.attr_size, config.rules, in_size,
+                        std::get<0>(runs.front()[p]), times[times.size() / 2] / 1e6, rss / 1024.0);
+        }
+    }
+
+    std::remove(in_file.c_str());
+    std::remove(out_file.c_str());
+
+    Inkscape::Util::StaticsBin::get().destroy();
+    return status;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Rendering benchmark.
+ *
+ * Loads a corpus of SVG files and renders each one through Inkscape::Drawing at several zoom
+ * levels and filter thread counts, reporting the wall time and the number of heap allocations
+ * spent in each stage. Results can be saved as a baseline and compared against a later run:
+ *
+ *   rendering_benchmark --save=before.tsv
+ *   rendering_benchmark --compare=before.tsv
+ *
+ * Without file arguments, the corpus in testfiles/rendering_tests/benchmark is used.
+ * Run with INKSCAPE_TRACE=trace.json for a per-item breakdown of each stage.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <cairomm/surface.h>
+#include <giomm/init.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <2geom/int-rect.h>
+#include <2geom/transforms.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "debug/timestamp.h"
+#include "debug/trace.h"
+#include "display/cairo-utils.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-item.h"
+#include "display/drawing-surface.h"
+#include "inkgc/gc-core.h"
+#include "object/sp-root.h"
+#include "util/statics.h"
+
+namespace {
+
+std::atomic<std::uint64_t> allocation_count{0};
+
+} // namespace
+
+// Count every C++ heap allocation made by the process, including those inside libinkscape_base.
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+using Inkscape::Debug::timestamp_ns;
+
+struct Measurement
+{
+    std::int64_t ns = 0;
+    std::uint64_t allocations = 0;
+};
+
+class Stopwatch
+{
+public:
+    Stopwatch()
+        : _start(timestamp_ns())
+        , _allocations(allocation_count.load(std::memory_order_relaxed))
+    {}
+
+    Measurement stop() const
+    {
+        return { timestamp_ns() - _start, allocation_count.load(std::memory_order_relaxed) - _allocations };
+    }
+
+private:
+    std::int64_t _start;
+    std::uint64_t _allocations;
+};
+
+/// Identifies one measurement: file, scale, thread count, stage. Per-document stages use scale 0.
+using Key = std::tuple<std::string, double, int, std::string>;
+using Results = std::map<Key, Measurement>;
+
+struct Options
+{
+    std::vector<std::string> files;
+    std::vector<double> scales = { 0.5, 1.0, 4.0 };
+    std::vector<int> threads = { 1, (int)std::max(1u, std::thread::hardware_concurrency()) };
+    int repeat = 5;
+    double tolerance = 0.1;
+    std::string save;
+    std::string compare;
+};
+
+template <typename T>
+std::vector<T> parse_list(std::string const &s)
+{
+    std::vector<T> result;
+    std::istringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        std::istringstream conv(item);
+        T value;
+        if (conv >> value) {
+            result.push_back(value);
+        }
+    }
+    return result;
+}
+
+void usage()
+{
+    std::cerr << "Usage: rendering_benchmark [options] [file.svg|directory ...]\n"
+                 "  --scales=0.5,1,4     zoom levels to render at\n"
+                 "  --threads=1,8        filter thread counts to render with\n"
+                 "  --repeat=5           renders per configuration; the median is reported\n"
+                 "  --save=FILE          write results as a baseline\n"
+                 "  --compare=FILE       compare against a baseline, exit with 1 on regression\n"
+                 "  --tolerance=0.1      relative slowdown tolerated by --compare\n";
+}
+
+bool parse_options(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++) {
+        auto const arg = std::string(argv[i]);
+        auto const eq = arg.find('=');
+        auto const name = arg.substr(0, eq);
+        auto const value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+        if (name == "--scales") {
+            opts.scales = parse_list<double>(value);
+        } else if (name == "--threads") {
+            opts.threads = parse_list<int>(value);
+        } else if (name == "--repeat") {
+            opts.repeat = std::max(1, std::atoi(value.c_str()));
+        } else if (name == "--tolerance") {
+            opts.tolerance = std::atof(value.c_str());
+        } else if (name == "--save") {
+            opts.save = value;
+        } else if (name == "--compare") {
+            opts.compare = value;
+        } else if (name == "--help" || name == "-h") {
+            return false;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        } else {
+            opts.files.push_back(arg);
+        }
+    }
+
+    if (opts.files.empty()) {
+        opts.files.emplace_back(INKSCAPE_TESTS_DIR "/rendering_tests/benchmark");
+    }
+
+    // Expand directories into the SVG files they contain.
+    std::vector<std::string> files;
+    for (auto const &f : opts.files) {
+        if (!Glib::file_test(f, Glib::FILE_TEST_IS_DIR)) {
+            files.push_back(f);
+            continue;
+        }
+        std::vector<std::string> entries;
+        for (auto const &name : Glib::Dir(f)) {
+            if (Glib::str_has_suffix(name, ".svg") || Glib::str_has_suffix(name, ".svgz")) {
+                entries.push_back(Glib::build_filename(f, name));
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        files.insert(files.end(), entries.begin(), entries.end());
+    }
+    opts.files = std::move(files);
+
+    return !opts.scales.empty() && !opts.threads.empty();
+}
+
+/// Render the whole canvas of a document, returning the timings of each stage.
+void benchmark_file(std::string const &filename, Options const &opts, Results &results)
+{
+    auto const id = Glib::path_get_basename(filename);
+
+    auto sw = Stopwatch();
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDoc(filename.c_str(), false));
+    results[{id, 0.0, 0, "load"}] = sw.stop();
+    if (!doc || !doc->getRoot()) {
+        std::cerr << "Failed to load " << filename << "\n";
+        return;
+    }
+
+    sw = Stopwatch();
+    doc->ensureUpToDate();
+    results[{id, 0.0, 0, "update"}] = sw.stop();
+
+    auto const dimensions = doc->getDimensions();
+
+    for (auto threads : opts.threads) {
+        for (auto scale : opts.scales) {
+            auto const area = Geom::IntRect(0, 0, (int)std::ceil(dimensions.x() * scale), (int)std::ceil(dimensions.y() * scale));
+            if (area.hasZeroArea()) {
+                continue;
+            }
+
+            sw = Stopwatch();
+            auto drawing = Inkscape::Drawing();
+            auto const dkey = SPItem::display_key_new(1);
+            drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+            drawing.root()->setTransform(Geom::Scale(scale));
+            drawing.update();
+            results[{id, scale, threads, "show"}] = sw.stop();
+
+            // Measure uncached rendering, and override the thread count loaded from preferences.
+            drawing.setCacheBudget(0);
+            set_num_filter_threads(threads);
+
+            std::vector<Measurement> renders;
+            for (int i = 0; i < opts.repeat; i++) {
+                auto cs = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, area.width(), area.height());
+                auto ds = Inkscape::DrawingSurface(cs->cobj(), area.min());
+                auto dc = Inkscape::DrawingContext(ds);
+                sw = Stopwatch();
+                drawing.render(dc, area);
+                renders.push_back(sw.stop());
+            }
+            std::sort(renders.begin(), renders.end(), [] (auto const &a, auto const &b) { return a.ns < b.ns; });
+            results[{id, scale, threads, "render"}] = renders[renders.size() / 2];
+
+            sw = Stopwatch();
+            doc->getRoot()->invoke_hide(dkey);
+            results[{id, scale, threads, "hide"}] = sw.stop();
+        }
+    }
+}
+
+void save_results(std::string const &filename, Results const &results)
+{
+    auto out = std::ofstream(filename);
+    out << "# file\tscale\tthreads\tstage\tns\tallocations\n";
+    for (auto const &[key, m] : results) {
+        auto const &[file, scale, threads, stage] = key;
+        out << file << '\t' << scale << '\t' << threads << '\t' << stage << '\t' << m.ns << '\t' << m.allocations << '\n';
+    }
+}
+
+Results load_results(std::string const &filename)
+{
+    Results results;
+    auto in = std::ifstream(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        auto fields = std::vector<std::string>();
+        auto ls = std::istringstream(line);
+        std::string field;
+        while (std::getline(ls, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 6) {
+            continue;
+        }
+        auto const key = Key{fields[0], std::atof(fields[1].c_str()), std::atoi(fields[2].c_str()), fields[3]};
+        results[key] = { std::atoll(fields[4].c_str()), std::strtoull(fields[5].c_str(), nullptr, 10) };
+    }
+    return results;
+}
+
+/// Print the results, compared against a baseline if one is given. Returns the number of regressions.
+int report(Results const &results, Results const &baseline, double tolerance)
+{
+    // Ignore differences below this, as they are dominated by timer and scheduling noise.
+    constexpr std::int64_t noise_ns = 200'000;
+
+    int regressions = 0;
+    std::printf("%-24s %6s %7s %-7s %12s %12s", "file", "scale", "threads", "stage", "time (ms)", "allocations");
+    if (!baseline.empty()) {
+        std::printf(" %12s %8s", "base (ms)", "change");
+    }
+    std::printf("\n");
+
+    for (auto const &[key, m] : results) {
+        auto const &[file, scale, threads, stage] = key;
+        auto const scale_str = scale == 0.0 ? std::string("-") : std::to_string(scale).substr(0, 4);
+        auto const threads_str = threads == 0 ? std::string("-") : std::to_string(threads);
+        std::printf("%-24s %6s %7s %-7s %12.3f %12llu", file.c_str(), scale_str.c_str(), threads_str.c_str(),
+                    stage.c_str(), m.ns / 1e6, (unsigned long long)m.allocations);
+
+        if (auto it = baseline.find(key); it != baseline.end()) {
+            auto const &b = it->second;
+            auto const change = b.ns > 0 ? (double)(m.ns - b.ns) / b.ns : 0.0;
+            bool const regressed = change > tolerance && m.ns - b.ns > noise_ns;
+            std::printf(" %12.3f %+7.1f%%%s", b.ns / 1e6, change * 100, regressed ? "  REGRESSION" : "");
+            regressions += regressed;
+        }
+        std::printf("\n");
+    }
+
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    auto opts = Options();
+    if (!parse_options(argc, argv, opts)) {
+        usage();
+        return 2;
+    }
+
+    Gio::init();
+    Inkscape::GC::init();
+    Inkscape::Debug::Trace::init();
+    Inkscape::Application::create(false);
+
+    Results results;
+    for (auto const &file : opts.files) {
+        benchmark_file(file, opts, results);
+    }
+
+    auto const baseline = opts.compare.empty() ? Results() : load_results(opts.compare);
+    int const regressions = report(results, baseline, opts.tolerance);
+
+    if (!opts.save.empty()) {
+        save_results(opts.save, results);
+    }
+
+    Inkscape::Util::StaticsBin::get().destroy();
+
+    if (regressions > 0) {
+        std::printf("%d stage(s) regressed by more than %g%%\n", regressions, opts.tolerance * 100);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
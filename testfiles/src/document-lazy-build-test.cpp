@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for building hidden layers and unused definitions on demand.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <gtest/gtest.h>
+#include <src/document.h>
+#include <src/document-undo.h>
+#include <src/inkscape.h>
+#include <src/preferences.h>
+#include <src/object/sp-defs.h>
+#include <src/object/sp-item-group.h>
+#include <src/object/sp-root.h>
+#include <src/xml/repr.h>
+
+using namespace Inkscape;
+
+class LazyBuildTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        // setup hidden dependency
+        Application::create(false);
+        Preferences::get()->setBool("/options/loading/lazy_build", true);
+    }
+
+    void TearDown() override
+    {
+        Preferences::get()->setBool("/options/loading/lazy_build", false);
+    }
+
+    std::unique_ptr<SPDocument> load(std::string const &svg)
+    {
+        return std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+    }
+};
+
+TEST_F(LazyBuildTest, hiddenLayerIsBuiltOnLookup)
+{
+    auto doc = load("\
+<svg xmlns='http://www.w3.org/2000/svg' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+    <g id='visible' inkscape:groupmode='layer'><rect id='rect1' width='10' height='10'/></g>\
+    <g id='hidden' inkscape:groupmode='layer' style='display:none'><rect id='rect2' width='10' height='10'/></g>\
+</svg>");
+
+    auto visible = cast<SPGroup>(doc->getObjectById("visible"));
+    auto hidden = cast<SPGroup>(doc->getObjectById("hidden"));
+    ASSERT_TRUE(visible && hidden);
+    EXPECT_TRUE(visible->hasChildren());
+    EXPECT_FALSE(hidden->hasChildren());
+    EXPECT_TRUE(doc->hasDeferred(hidden));
+
+    auto rect = doc->getObjectById("rect2");
+    ASSERT_TRUE(rect);
+    EXPECT_EQ(rect->parent, hidden);
+    EXPECT_FALSE(doc->hasDeferred(hidden));
+}
+
+TEST_F(LazyBuildTest, hiddenLayerIsBuiltWhenShown)
+{
+    auto doc = load("\
+<svg xmlns='http://www.w3.org/2000/svg' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+    <g id='hidden' inkscape:groupmode='layer' style='display:none'><rect id='rect1' width='10' height='10'/><rect id='rect2'/></g>\
+</svg>");
+
+    auto hidden = cast<SPGroup>(doc->getObjectById("hidden"));
+    ASSERT_TRUE(hidden);
+    EXPECT_FALSE(hidden->hasChildren());
+
+    hidden->setAttribute("style", "display:inline");
+    doc->ensureUpToDate();
+    EXPECT_EQ(hidden->children.size(), 2u);
+}
+
+TEST_F(LazyBuildTest, buildingOnDemandLeavesXmlAndUndoAlone)
+{
+    auto doc = load("\
+<svg xmlns='http://www.w3.org/2000/svg' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+    <g id='hidden' inkscape:groupmode='layer' style='display:none'><rect id='rect1'/><rect id='rect2'/></g>\
+</svg>");
+
+    auto const xml = sp_repr_save_buf(doc->getReprDoc());
+    ASSERT_TRUE(doc->hasDeferred(doc->getObjectById("hidden")));
+    ASSERT_TRUE(doc->getObjectById("rect2"));
+    doc->buildDeferred();
+
+    EXPECT_EQ(sp_repr_save_buf(doc->getReprDoc()), xml);
+    DocumentUndo::done(doc.get(), "test", "");
+    EXPECT_FALSE(DocumentUndo::undo(doc.get()));
+}
+
+TEST_F(LazyBuildTest, elementsWithoutUniqueIdsAreBuiltAtLoad)
+{
+    auto const svg = std::string("\
+<svg xmlns='http://www.w3.org/2000/svg' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+    <defs>\
+        <linearGradient id='gradient1'><stop offset='0'/></linearGradient>\
+        <linearGradient id='gradient2'><stop id='stop1' offset='0'/></linearGradient>\
+    </defs>\
+    <rect id='clash'/>\
+    <g id='noid' inkscape:groupmode='layer' style='display:none'><rect/></g>\
+    <g id='duplicate' inkscape:groupmode='layer' style='display:none'><rect id='clash'/></g>\
+    <g id='unique' inkscape:groupmode='layer' style='display:none'><rect id='rect1'/></g>\
+</svg>");
+
+    // Building them later would assign ids, so they are built right away, as without lazy building.
+    auto doc = load(svg);
+    auto defs = doc->getRoot()->defs->getRepr();
+    EXPECT_FALSE(doc->isDeferred(sp_repr_lookup_child(defs, "id", "gradient1")));
+    EXPECT_TRUE(doc->isDeferred(sp_repr_lookup_child(defs, "id", "gradient2")));
+    EXPECT_FALSE(doc->hasDeferred(doc->getObjectById("noid")));
+    EXPECT_FALSE(doc->hasDeferred(doc->getObjectById("duplicate")));
+    EXPECT_TRUE(doc->hasDeferred(doc->getObjectById("unique")));
+
+    Preferences::get()->setBool("/options/loading/lazy_build", false);
+    auto full = load(svg);
+    EXPECT_EQ(sp_repr_save_buf(doc->getReprDoc()), sp_repr_save_buf(full->getReprDoc()));
+}
+
+TEST_F(LazyBuildTest, unusedDefinitionsAreBuiltOnDemand)
+{
+    auto doc = load("\
+<svg xmlns='http://www.w3.org/2000/svg'>\
+    <defs>\
+        <linearGradient id='used'><stop id='stop1' offset='0'/></linearGradient>\
+        <linearGradient id='unused'><stop id='stop2' offset='0'/></linearGradient>\
+    </defs>\
+    <rect width='10' height='10' fill='url(#used)'/>\
+</svg>");
+
+    auto defs = doc->getRoot()->defs;
+    ASSERT_TRUE(defs);
+    EXPECT_EQ(defs->children.size(), 1u);
+    EXPECT_TRUE(doc->isDeferred(sp_repr_lookup_child(defs->getRepr(), "id", "unused")));
+
+    EXPECT_EQ(doc->getResourceList("gradient").size(), 2u);
+    EXPECT_EQ(defs->children.size(), 2u);
+    EXPECT_FALSE(doc->hasDeferred(defs));
+}
+
+TEST_F(LazyBuildTest, vacuumBuildsDeferredObjects)
+{
+    auto doc = load("\
+<svg xmlns='http://www.w3.org/2000/svg' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+    <defs>\
+        <linearGradient id='used'><stop id='stop1' offset='0'/></linearGradient>\
+        <linearGradient id='hiddenused'><stop id='stop2' offset='0'/></linearGradient>\
+        <linearGradient id='unused'><stop id='stop3' offset='0'/></linearGradient>\
+    </defs>\
+    <rect id='rect1' width='10' height='10' fill='url(#used)'/>\
+    <g id='layer1' inkscape:groupmode='layer' style='display:none'>\
+        <rect id='rect2' width='10' height='10' fill='url(#hiddenused)'/>\
+    </g>\
+</svg>");
+
+    auto defs = doc->getRoot()->defs;
+    ASSERT_TRUE(defs);
+    EXPECT_TRUE(doc->hasDeferred(defs));
+
+    // The unused gradient and its stop are removed; the one referenced from the hidden layer is kept.
+    EXPECT_EQ(doc->vacuumDocument(), 2u);
+    EXPECT_FALSE(doc->hasDeferred(defs));
+    EXPECT_TRUE(doc->getObjectById("used"));
+    EXPECT_TRUE(doc->getObjectById("hiddenused"));
+    EXPECT_FALSE(doc->getObjectById("unused"));
+    EXPECT_FALSE(sp_repr_lookup_child(defs->getRepr(), "id", "unused"));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
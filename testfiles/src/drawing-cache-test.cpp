@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the choice of items to cache when rendering.
+ */
+/*
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <string>
+#include <gtest/gtest.h>
+
+#include <2geom/int-rect.h>
+
+#include "inkscape.h"
+#include "document.h"
+#include "object/sp-item.h"
+#include "object/sp-root.h"
+#include "display/drawing.h"
+#include "display/drawing-item.h"
+
+using namespace Inkscape;
+
+namespace {
+
+// A large plain rectangle, and a smaller group of shapes under a clip. The clip makes the group
+// more expensive per pixel, while none of its shapes is worth caching on its own.
+std::string const svg = [] {
+    std::string result = "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>"
+                         "<clipPath id='clip'><rect x='750' y='750' width='240' height='240'/></clipPath>"
+                         "<rect id='cheap' x='0' y='0' width='700' height='700' fill='blue'/>"
+                         "<g id='expensive' clip-path='url(#clip)'>";
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result += "<circle cx='" + std::to_string(780 + 60 * i) + "' cy='" + std::to_string(780 + 60 * j) +
+                      "' r='30' fill='red'/>";
+        }
+    }
+    return result + "</g></svg>";
+}();
+
+class DrawingCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+        doc.reset(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+        doc->ensureUpToDate();
+        root = doc->getRoot();
+        dkey = SPItem::display_key_new(1);
+        drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.setCacheBudget(0);
+        drawing.setCacheLimit(Geom::IntRect(0, 0, 1000, 1000));
+        drawing.update();
+    }
+
+    void TearDown() override
+    {
+        root->invoke_hide(dkey);
+    }
+
+    std::size_t cacheSize(char const *id)
+    {
+        auto const drawbox = cast<SPItem>(doc->getObjectById(id))->get_arenaitem(dkey)->drawbox();
+        return drawbox ? drawbox->area() * 4 : 0;
+    }
+
+    std::unique_ptr<SPDocument> doc;
+    SPRoot *root = nullptr;
+    unsigned dkey = 0;
+    Drawing drawing;
+};
+
+} // namespace
+
+TEST_F(DrawingCacheTest, PrefersSmallExpensiveItemsOverLargeCheapOnes)
+{
+    // Nothing has been rendered, so the items are scored by their estimated complexity.
+    // There is room for either item, but not both.
+    auto const budget = cacheSize("cheap") + cacheSize("expensive") - 1;
+    ASSERT_GT(cacheSize("cheap"), 4 * cacheSize("expensive"));
+
+    drawing.setCacheBudget(budget);
+    auto const stats = drawing.cacheStats();
+    EXPECT_EQ(stats.items, 1u);
+    EXPECT_EQ(stats.bytes, cacheSize("expensive"));
+}
+
+TEST_F(DrawingCacheTest, CachesBothWhenTheyFit)
+{
+    drawing.setCacheBudget(cacheSize("cheap") + cacheSize("expensive"));
+    auto const stats = drawing.cacheStats();
+    EXPECT_EQ(stats.items, 2u);
+    EXPECT_EQ(stats.bytes, cacheSize("cheap") + cacheSize("expensive"));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for rendering filtered items.
+ */
+/*
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <cairomm/surface.h>
+#include <2geom/int-point.h>
+#include <2geom/int-rect.h>
+
+#include "inkscape.h"
+#include "document.h"
+#include "object/sp-root.h"
+#include "display/drawing.h"
+#include "display/drawing-item.h"
+#include "display/drawing-surface.h"
+#include "display/drawing-context.h"
+#include "display/nr-filter-gaussian.h"
+#include "display/nr-filter-turbulence.h"
+#include "display/nr-filter-units.h"
+
+using namespace Inkscape;
+
+namespace {
+
+class Display
+{
+public:
+    Display(SPDocument *doc)
+        : root(doc->getRoot())
+        , dkey(SPItem::display_key_new(1))
+    {
+        drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.update();
+    }
+
+    ~Display()
+    {
+        root->invoke_hide(dkey);
+    }
+
+    auto draw(Geom::IntRect const &rect, unsigned flags = 0)
+    {
+        auto cs = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, rect.width(), rect.height());
+        auto ds = DrawingSurface(cs->cobj(), rect.min());
+        auto dc = DrawingContext(ds);
+        drawing.render(dc, rect, flags);
+        cs->flush();
+        return cs;
+    }
+
+private:
+    Drawing drawing;
+    SPRoot *root;
+    unsigned dkey;
+};
+
+/// Compares a with the part of b starting at offset.
+int max_diff(Cairo::RefPtr<Cairo::ImageSurface> const &a, Cairo::RefPtr<Cairo::ImageSurface> const &b,
+             Geom::IntPoint const &offset = Geom::IntPoint(0, 0))
+{
+    int result = 0;
+    for (int y = 0; y < a->get_height(); y++) {
+        auto p = a->get_data() + y * a->get_stride();
+        auto q = b->get_data() + (offset.y() + y) * b->get_stride() + offset.x() * 4;
+        for (int x = 0; x < a->get_width() * 4; x++) {
+            result = std::max(result, std::abs((int)p[x] - (int)q[x]));
+        }
+    }
+    return result;
+}
+
+class DrawingFilterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+    }
+
+    static std::unique_ptr<SPDocument> load(char const *svg)
+    {
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg, strlen(svg), false));
+        doc->ensureUpToDate();
+        return doc;
+    }
+};
+
+char const *blurred_rect = R"""(
+<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+  <filter id="blur" x="-50%" y="-50%" width="200%" height="200%">
+    <feGaussianBlur stdDeviation="6"/>
+  </filter>
+  <rect x="30" y="30" width="40" height="40" fill="#204a87" filter="url(#blur)"/>
+</svg>
+)""";
+
+// Large enough for the filter regions to be rendered in tiles.
+char const *large_filtered = R"""(
+<svg xmlns="http://www.w3.org/2000/svg" width="1400" height="1400">
+  <filter id="filter">%s</filter>
+  <g filter="url(#filter)" stroke="#204a87" stroke-width="30" fill="#f57900">
+    <path d="M 100,100 L 1300,1300 M 1300,100 L 100,1300 M 700,100 V 1300 M 100,700 H 1300" fill="none"/>
+    <circle cx="500" cy="520" r="90"/>
+    <circle cx="1030" cy="500" r="60"/>
+    <rect x="480" y="980" width="120" height="90"/>
+  </g>
+</svg>
+)""";
+
+std::string large_filtered_with(char const *primitives)
+{
+    auto result = std::string(large_filtered);
+    result.replace(result.find("%s"), 2, primitives);
+    return result;
+}
+
+} // namespace
+
+TEST_F(DrawingFilterTest, UnfilteredRenderDoesNotFillCache)
+{
+    auto doc = load(blurred_rect);
+    auto const area = Geom::IntRect::from_xywh(0, 0, 100, 100);
+
+    auto const reference = Display(doc.get()).draw(area);
+
+    // A preview pass, as used by the canvas, followed by a full pass of the now-cached item.
+    auto display = Display(doc.get());
+    auto const preview = display.draw(area, DrawingItem::RENDER_NO_FILTERS);
+    ASSERT_GT(max_diff(preview, reference), 10);
+    EXPECT_LE(max_diff(display.draw(area), reference), 1);
+
+    // The full pass is still served from the cache correctly afterwards.
+    display.draw(area, DrawingItem::RENDER_NO_FILTERS | DrawingItem::RENDER_BYPASS_CACHE);
+    EXPECT_LE(max_diff(display.draw(area), reference), 1);
+}
+
+TEST_F(DrawingFilterTest, TiledRenderMatchesUntiled)
+{
+    char const *filters[] = {
+        R"(<feGaussianBlur stdDeviation="4"/>)",
+        R"(<feOffset dx="37" dy="-23"/><feMorphology operator="dilate" radius="5 3"/><feGaussianBlur stdDeviation="2"/>)",
+        R"(<feMorphology operator="erode" radius="4"/><feOffset dx="-11" dy="19"/>)",
+        // Downsampled at the default blur quality
+        R"(<feGaussianBlur stdDeviation="24"/>)",
+    };
+
+    auto const area = Geom::IntRect::from_xywh(0, 0, 1400, 1400);
+    int const window = 450;
+
+    for (auto primitives : filters) {
+        auto const svg = large_filtered_with(primitives);
+        auto doc = load(svg.c_str());
+
+        // The whole drawing is rendered in tiles, each window in one piece.
+        auto const tiled = Display(doc.get()).draw(area);
+        for (int y = 0; y < area.height(); y += window) {
+            for (int x = 0; x < area.width(); x += window) {
+                auto const rect = Geom::IntRect::from_xywh(x, y, window, window) & area;
+                auto const part = Display(doc.get()).draw(*rect);
+                EXPECT_LE(max_diff(part, tiled, rect->min()), 2) << primitives << " at " << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST_F(DrawingFilterTest, DownsampledBlurTilesReachItsKernel)
+{
+    auto units = Filters::FilterUnits(SP_FILTER_UNITS_USERSPACEONUSE, SP_FILTER_UNITS_USERSPACEONUSE);
+    units.set_ctm(Geom::identity());
+    units.set_filter_area(Geom::Rect(0, 0, 1000, 1000));
+    units.set_resolution(1000, 1000);
+    units.set_automatic_resolution(true);
+
+    auto blur = Filters::FilterGaussian();
+    blur.set_deviation(24);
+    auto const tile = Geom::IntRect::from_xywh(100, 100, 200, 200);
+
+    // At full resolution, a tile reads three deviations around it.
+    auto best = tile;
+    blur.tile_area_enlarge(best, Geom::identity(), units, 1, BLUR_QUALITY_BEST);
+    EXPECT_EQ(best, Geom::IntRect(28, 28, 372, 372));
+
+    // Downsampled by 8, it reads the kernel rounded up to whole cells, and three cells more.
+    auto normal = tile;
+    blur.tile_area_enlarge(normal, Geom::identity(), units, 1, BLUR_QUALITY_NORMAL);
+    EXPECT_EQ(normal, Geom::IntRect(4, 4, 396, 396));
+}
+
+TEST_F(DrawingFilterTest, CachedTurbulenceMatchesUncached)
+{
+    // Each differs from the first in one parameter, so that tiles cached for one would be wrong for another.
+    char const *turbulences[] = {
+        R"(baseFrequency="0.05" numOctaves="2" seed="3")",
+        R"(baseFrequency="0.05" numOctaves="2" seed="3" stitchTiles="stitch")",
+        R"(baseFrequency="0.05" numOctaves="2" seed="4")",
+        R"(baseFrequency="0.05 0.013" numOctaves="2" seed="3")",
+        R"(baseFrequency="0.05" numOctaves="2" seed="3" type="fractalNoise")",
+    };
+
+    auto const area = Geom::IntRect::from_xywh(0, 0, 400, 300);
+    auto const panned = Geom::IntRect::from_xywh(77, 45, 200, 200);
+
+    std::vector<std::unique_ptr<SPDocument>> docs;
+    for (auto turbulence : turbulences) {
+        auto const svg = std::string(R"(<svg xmlns="http://www.w3.org/2000/svg" width="400" height="300">
+  <filter id="filter" x="0" y="0" width="1" height="1"><feTurbulence )") + turbulence + R"(/></filter>
+  <rect x="20" y="10" width="350" height="270" filter="url(#filter)"/>
+</svg>)";
+        docs.push_back(load(svg.c_str()));
+    }
+
+    Filters::set_turbulence_cache_enabled(false);
+    std::vector<Cairo::RefPtr<Cairo::ImageSurface>> uncached;
+    for (auto &doc : docs) {
+        uncached.push_back(Display(doc.get()).draw(area));
+    }
+    Filters::set_turbulence_cache_enabled(true);
+
+    // The first round fills the cache, the second is served from it, and so is the panned view.
+    for (int round = 0; round < 2; round++) {
+        for (std::size_t i = 0; i < docs.size(); i++) {
+            EXPECT_EQ(max_diff(Display(docs[i].get()).draw(area), uncached[i]), 0) << turbulences[i];
+        }
+    }
+    for (std::size_t i = 0; i < docs.size(); i++) {
+        EXPECT_EQ(max_diff(Display(docs[i].get()).draw(panned), uncached[i], panned.min()), 0) << turbulences[i];
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
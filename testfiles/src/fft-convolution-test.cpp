@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the FFT convolution used by large filter kernels
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <cairomm/surface.h>
+#include <src/display/fft-convolution.h>
+#include <src/display/drawing.h>
+#include <src/display/drawing-context.h>
+#include <src/display/drawing-surface.h>
+#include <src/document.h>
+#include <src/inkscape.h>
+#include <src/object/sp-root.h>
+
+using namespace Inkscape::Filters;
+
+namespace {
+
+std::vector<double> correlate_directly(std::vector<double> const &plane, int width, int height,
+                                       std::vector<double> const &kernel, int kernel_width, int kernel_height)
+{
+    int const out_w = width - kernel_width + 1;
+    int const out_h = height - kernel_height + 1;
+    std::vector<double> result(out_w * out_h);
+    for (int y = 0; y < out_h; y++) {
+        for (int x = 0; x < out_w; x++) {
+            double sum = 0;
+            for (int i = 0; i < kernel_height; i++) {
+                for (int j = 0; j < kernel_width; j++) {
+                    sum += plane[(y + i) * width + x + j] * kernel[i * kernel_width + j];
+                }
+            }
+            result[y * out_w + x] = sum;
+        }
+    }
+    return result;
+}
+
+Cairo::RefPtr<Cairo::ImageSurface> render(SPDocument *doc, Geom::IntRect const &area)
+{
+    Inkscape::Drawing drawing;
+    auto const dkey = SPItem::display_key_new(1);
+    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    drawing.update();
+
+    auto cs = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, area.width(), area.height());
+    auto ds = Inkscape::DrawingSurface(cs->cobj(), area.min());
+    auto dc = Inkscape::DrawingContext(ds);
+    drawing.render(dc, area);
+    cs->flush();
+
+    doc->getRoot()->invoke_hide(dkey);
+    return cs;
+}
+
+} // namespace
+
+TEST(FFTConvolutionTest, InverseTransformRestoresInput)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    std::vector<std::complex<double>> data(64);
+    for (auto &v : data) {
+        v = {dist(gen), dist(gen)};
+    }
+    auto const original = data;
+
+    fft(data.data(), data.size(), 1, false);
+    fft(data.data(), data.size(), 1, true);
+
+    for (std::size_t i = 0; i < data.size(); i++) {
+        EXPECT_NEAR(data[i].real() / data.size(), original[i].real(), 1e-12);
+        EXPECT_NEAR(data[i].imag() / data.size(), original[i].imag(), 1e-12);
+    }
+}
+
+TEST(FFTConvolutionTest, MatchesDirectSummation)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> pixel(0.0, 255.0);
+    std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+
+    // The last two are split into blocks
+    for (auto [width, height] : {std::pair{9, 9}, {37, 16}, {64, 29}, {1100, 23}, {19, 700}}) {
+        for (auto [kernel_width, kernel_height] : {std::pair{1, 1}, {3, 5}, {9, 9}}) {
+            for (int num_planes : {1, 3, 4}) {
+                std::vector<std::vector<double>> planes(num_planes, std::vector<double>(width * height));
+                for (auto &plane : planes) {
+                    for (auto &v : plane) {
+                        v = pixel(gen);
+                    }
+                }
+                std::vector<double> kernel(kernel_width * kernel_height);
+                for (auto &v : kernel) {
+                    v = coeff(gen);
+                }
+
+                auto const result = fft_correlate(planes, width, height, kernel, kernel_width, kernel_height);
+                ASSERT_EQ(result.size(), planes.size());
+                for (int p = 0; p < num_planes; p++) {
+                    auto const expected = correlate_directly(planes[p], width, height, kernel, kernel_width, kernel_height);
+                    ASSERT_EQ(result[p].size(), expected.size());
+                    for (std::size_t i = 0; i < expected.size(); i++) {
+                        EXPECT_NEAR(result[p][i], expected[i], 1e-7);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(FFTConvolutionTest, KernelLargerThanPlaneGivesNothing)
+{
+    std::vector<std::vector<double>> planes(2, std::vector<double>(4 * 4, 1.0));
+    std::vector<double> kernel(5 * 5, 1.0);
+    auto const result = fft_correlate(planes, 4, 4, kernel, 5, 5);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_TRUE(result[0].empty());
+    EXPECT_TRUE(result[1].empty());
+}
+
+TEST(FFTConvolutionTest, ConvolveMatrixMatchesDirectPath)
+{
+    if (!Inkscape::Application::exists()) {
+        Inkscape::Application::create(false);
+    }
+
+    // A 15×15 kernel over this region is summed through the FFT
+    std::string kernel;
+    for (int i = 0; i < 15 * 15; i++) {
+        kernel += std::to_string(i * 37 % 11 - 3) + ' ';
+    }
+    ASSERT_TRUE(fft_correlation_pays_off(300, 300, 15, 15, 3));
+
+    auto const area = Geom::IntRect::from_xywh(0, 0, 320, 320);
+    for (auto attributes : {
+        R"(edgeMode="none")",
+        R"(edgeMode="duplicate" preserveAlpha="true")",
+        R"(edgeMode="wrap" divisor="400" bias="0.25")",
+        R"(targetX="2" targetY="11" divisor="900" bias="0.5" preserveAlpha="true")",
+    }) {
+        auto const svg = std::string(R"(<svg xmlns="http://www.w3.org/2000/svg" width="320" height="320">
+  <radialGradient id="gradient"><stop offset="0" stop-color="#ef2929"/><stop offset="1" stop-color="#3465a4" stop-opacity="0.3"/></radialGradient>
+  <filter id="filter" x="0" y="0" width="1" height="1">
+    <feConvolveMatrix order="15" kernelMatrix=")") + kernel + "\" " + attributes + R"(/>
+  </filter>
+  <g filter="url(#filter)">
+    <rect x="10" y="10" width="300" height="300" fill="url(#gradient)"/>
+    <rect x="60" y="140" width="200" height="40" fill="#73d216" fill-opacity="0.6"/>
+  </g>
+</svg>)";
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+        ASSERT_TRUE((bool)doc);
+        doc->ensureUpToDate();
+
+        set_fft_convolution_enabled(false);
+        auto const direct = render(doc.get(), area);
+        set_fft_convolution_enabled(true);
+        auto const transformed = render(doc.get(), area);
+
+        int maxdiff = 0;
+        for (int y = 0; y < area.height(); y++) {
+            auto p = direct->get_data() + y * direct->get_stride();
+            auto q = transformed->get_data() + y * transformed->get_stride();
+            for (int x = 0; x < area.width() * 4; x++) {
+                maxdiff = std::max(maxdiff, std::abs((int)p[x] - (int)q[x]));
+            }
+        }
+        EXPECT_LE(maxdiff, 1) << attributes;
+    }
+}
+
+TEST(FFTConvolutionTest, CostModel)
+{
+    // Small kernels are always summed directly
+    EXPECT_FALSE(fft_correlation_pays_off(2048, 2048, 3, 3, 4));
+    EXPECT_FALSE(fft_correlation_pays_off(2048, 2048, 5, 5, 4));
+    // Large kernels over large surfaces go through the FFT
+    EXPECT_TRUE(fft_correlation_pays_off(512, 512, 9, 9, 4));
+    EXPECT_TRUE(fft_correlation_pays_off(1000, 1000, 25, 25, 3));
+    // but not when the kernel does not fit
+    EXPECT_FALSE(fft_correlation_pays_off(16, 16, 25, 25, 4));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
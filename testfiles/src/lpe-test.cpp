@@ -10,10 +10,13 @@
  */
 
 #include <gtest/gtest.h>
+#include <2geom/transforms.h>
 #include <testfiles/lpespaths-test.h>
 #include <src/document.h>
 #include <src/inkscape.h>
+#include <src/live_effects/effect.h>
 #include <src/live_effects/lpe-bool.h>
+#include <src/live_effects/lpeobject.h>
 #include <src/object/sp-ellipse.h>
 #include <src/object/sp-lpe-item.h>
 
@@ -27,6 +30,36 @@ public:
     }
 };
 
+namespace {
+
+/// A cacheable effect that counts how often each of its hooks runs.
+class CountingEffect : public Effect
+{
+public:
+    CountingEffect(LivePathEffectObject *lpeobject)
+        : Effect(lpeobject)
+    {
+        cacheable_result = true;
+    }
+
+    int before = 0;
+    int effect = 0;
+    int after = 0;
+
+protected:
+    Geom::PathVector doEffect_path(Geom::PathVector const &path_in) override
+    {
+        effect++;
+        return path_in * Geom::Translate(10, 0);
+    }
+
+private:
+    void doBeforeEffect(SPLPEItem const *) override { before++; }
+    void doAfterEffect(SPLPEItem const *, SPCurve *) override { after++; }
+};
+
+} // namespace
+
 // A) FILE BASED TESTS
 TEST_F(LPETest, Inkscape_0_92) { run(); }
 TEST_F(LPETest, Inkscape_1_0)  { run(); }
@@ -72,4 +105,117 @@ TEST_F(LPETest, Bool_canBeApplyedToNonSiblingPaths)
     auto operand_path = lpe_bool_op_effect->getParameter("operand-path")->param_getSVGValue();
     auto circle = cast<SPGenericEllipse>(doc->getObjectById(operand_path.substr(1)));
     ASSERT_TRUE(circle != nullptr);
-}
\ No newline at end of file
+}
+
+// STACK CACHE
+TEST_F(LPETest, StackCache_reusesResultsOnlyForUnchangedInputs)
+{
+    std::string svg("\
+<svg width='200' height='200'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect id='power' effect='powerstroke' is_visible='true' lpeversion='1.3'\
+      offset_points='0.5,5 | 1.5,10' not_jump='false' sort_points='true' interpolator_type='CubicBezierSmooth'\
+      interpolator_beta='0.2' start_linecap_type='zerowidth' linejoin_type='round' miter_limit='4'\
+      scale_width='1' end_linecap_type='zerowidth' />\
+    <inkscape:path-effect id='taper' effect='taper_stroke' is_visible='true' lpeversion='1' stroke_width='10'\
+      subpath='1' attach_start='0.2' end_offset='0.2' start_smoothing='0.5' end_smoothing='0.5'\
+      jointype='extrapolated' start_shape='center' end_shape='center' miter_limit='100' />\
+    <inkscape:path-effect id='pap' effect='skeletal' is_visible='true' lpeversion='1.3' pattern='#pattern'\
+      copytype='single_stretched' prop_scale='1' scale_y_rel='false' spacing='0' normal_offset='0'\
+      tang_offset='0' prop_units='false' vertical_pattern='false' hide_knot='false' fuse_tolerance='0' />\
+  </defs>\
+  <path id='pattern' d='M 0,0 L 10,5 L 0,10 Z' />\
+  <path id='path-power' inkscape:path-effect='#power' inkscape:original-d='M 10,10 C 50,10 50,60 90,60' d='' />\
+  <path id='path-taper' inkscape:path-effect='#taper' inkscape:original-d='M 10,80 C 50,80 50,130 90,130' d='' />\
+  <path id='path-pap' inkscape:path-effect='#pap' inkscape:original-d='M 10,150 C 50,150 50,190 90,190' d='' />\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto update = [&] (char const *id) {
+        auto lpeitem = cast<SPLPEItem>(doc->getObjectById(id));
+        sp_lpe_item_update_patheffect(lpeitem, false, true);
+        auto const d = lpeitem->getAttribute("d");
+        return std::string(d ? d : "");
+    };
+
+    for (auto id : {"path-power", "path-taper", "path-pap"}) {
+        // The first update after loading always runs, the second one fills the cache.
+        update(id);
+        auto const computed = update(id);
+        EXPECT_FALSE(computed.empty()) << id;
+        EXPECT_EQ(update(id), computed) << id;
+    }
+
+    // Changed parameters invalidate the cached result.
+    auto const power = update("path-power");
+    doc->getObjectById("power")->setAttribute("offset_points", "0.5,15 | 1.5,20");
+    EXPECT_NE(update("path-power"), power);
+
+    auto const taper = update("path-taper");
+    doc->getObjectById("taper")->setAttribute("stroke_width", "30");
+    EXPECT_NE(update("path-taper"), taper);
+
+    // So does a change of the linked pattern, which only appears as a reference in the parameters.
+    auto const pap = update("path-pap");
+    doc->getObjectById("pattern")->setAttribute("d", "M 0,0 L 10,15 L 0,30 Z");
+    doc->ensureUpToDate();
+    EXPECT_NE(update("path-pap"), pap);
+}
+
+TEST_F(LPETest, StackCache_skipsEffectHooksOnlyForUnchangedInputs)
+{
+    std::string svg("\
+<svg width='200' height='200'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect id='count' effect='bspline' is_visible='true' lpeversion='1' />\
+  </defs>\
+  <path id='path' inkscape:path-effect='#count' inkscape:original-d='M 10,10 L 90,60' d='' />\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto lpeobj = cast<LivePathEffectObject>(doc->getObjectById("count"));
+    ASSERT_TRUE(lpeobj);
+    delete lpeobj->lpe;
+    auto counting = new CountingEffect(lpeobj);
+    lpeobj->lpe = counting;
+
+    auto lpeitem = cast<SPLPEItem>(doc->getObjectById("path"));
+    auto update = [&] {
+        sp_lpe_item_update_patheffect(lpeitem, false, true);
+        return std::string(lpeitem->getAttribute("d"));
+    };
+
+    // The first run after loading is never cached, the next one fills the cache.
+    update();
+    auto const computed = update();
+    ASSERT_GE(counting->effect, 2);
+
+    // Unchanged input: the result is replayed, and doBeforeEffect()/doAfterEffect() are
+    // skipped along with doEffect(), as what they set up for this input still stands.
+    auto const effect = counting->effect;
+    auto const before = counting->before;
+    auto const after = counting->after;
+    EXPECT_EQ(update(), computed);
+    EXPECT_EQ(update(), computed);
+    EXPECT_EQ(counting->effect, effect);
+    EXPECT_EQ(counting->before, before);
+    EXPECT_EQ(counting->after, after);
+
+    // A changed input runs all of them again.
+    lpeitem->setAttribute("inkscape:original-d", "M 10,10 L 90,90");
+    auto const changed = update();
+    EXPECT_NE(changed, computed);
+    EXPECT_GT(counting->effect, effect);
+    EXPECT_GT(counting->before, before);
+    EXPECT_GT(counting->after, after);
+
+    auto const rerun = counting->effect;
+    EXPECT_EQ(update(), changed);
+    EXPECT_EQ(counting->effect, rerun);
+}
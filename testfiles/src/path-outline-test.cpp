@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Stroke to path tests
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <src/document.h>
+#include <src/inkscape.h>
+#include <src/object/sp-item.h>
+#include <src/object/sp-root.h>
+#include <src/path/path-outline.h>
+#include <src/util/parallel.h>
+#include <src/xml/node.h>
+
+using namespace Inkscape;
+
+class PathOutlineTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        // setup hidden dependency
+        Application::create(false);
+    }
+
+    std::unique_ptr<SPDocument> load(std::string const &svg)
+    {
+        return std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+    }
+
+    static std::vector<SPItem *> items(SPDocument *doc)
+    {
+        std::vector<SPItem *> result;
+        for (auto &child : doc->getRoot()->children) {
+            if (auto item = cast<SPItem>(&child)) {
+                result.push_back(item);
+            }
+        }
+        return result;
+    }
+
+    static void collect_paths(Inkscape::XML::Node const *repr, std::vector<std::string> &paths)
+    {
+        if (auto d = repr->attribute("d")) {
+            paths.emplace_back(d);
+        }
+        for (auto child = repr->firstChild(); child; child = child->next()) {
+            collect_paths(child, paths);
+        }
+    }
+
+    static std::vector<std::string> paths(SPDocument *doc)
+    {
+        std::vector<std::string> result;
+        collect_paths(doc->getReprRoot(), result);
+        return result;
+    }
+};
+
+TEST_F(PathOutlineTest, concurrentStrokeToPathMatchesSerial)
+{
+    // Miter, round and bevel joins, including half turns whose outline depends on join state.
+    std::string svg("<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>");
+    char const *joins[] = {"miter", "round", "bevel"};
+    for (int i = 0; i < 60; i++) {
+        auto const x = std::to_string(10 * i);
+        svg += "<path fill='none' stroke='#000' stroke-width='" + std::to_string(3 + i % 7) +
+               "' stroke-linejoin='" + joins[i % 3] + "' d='M " + x + ",10 L " + x + ",300 L " + x +
+               ",100 L 500,500 C 600,400 700,700 " + x + ",900 L 990,990 L " + x + ",900'/>";
+    }
+    svg += "</svg>";
+
+    auto serial = load(svg);
+    for (auto item : items(serial.get())) {
+        item_to_paths(item);
+    }
+
+    auto const threads = Util::get_num_threads();
+    Util::set_num_threads(4);
+    auto concurrent = load(svg);
+    items_to_paths(items(concurrent.get()));
+    Util::set_num_threads(threads);
+
+    auto const expected = paths(serial.get());
+    ASSERT_EQ(expected.size(), 60u);
+    EXPECT_EQ(paths(concurrent.get()), expected);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for reading XML files into reprs
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "io/stream/gzipstream.h"
+#include "io/stream/uristream.h"
+#include "xml/document.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+namespace {
+
+std::unique_ptr<Inkscape::XML::Document> read_file(char const *filename)
+{
+    return std::unique_ptr<Inkscape::XML::Document>(sp_repr_read_file(filename, SP_SVG_NS_URI));
+}
+
+void write_file(char const *filename, std::string const &contents)
+{
+    auto fp = std::fopen(filename, "wb");
+    ASSERT_TRUE(fp);
+    std::fwrite(contents.data(), 1, contents.size(), fp);
+    std::fclose(fp);
+}
+
+std::string utf16(std::u16string const &text, bool big_endian)
+{
+    std::string result;
+    for (auto c : text) {
+        char const hi = c >> 8, lo = c & 0xff;
+        result += big_endian ? hi : lo;
+        result += big_endian ? lo : hi;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(ReprIoTest, ByteOrderMarks)
+{
+    // The title is read back as UTF-8.
+    auto const title = std::string("Gr\xc3\xbc\xc3\x9f" "e \xe2\x9c\x93");
+    auto const svg = u"<svg xmlns='http://www.w3.org/2000/svg'><title id='t'>Grüße ✓</title></svg>";
+
+    auto const files = {
+        std::pair{"bom-utf8.svg", "\xef\xbb\xbf" "<svg xmlns='http://www.w3.org/2000/svg'><title id='t'>" + title + "</title></svg>"},
+        std::pair{"bom-utf16le.svg", "\xff\xfe" + utf16(svg, false)},
+        std::pair{"bom-utf16be.svg", "\xfe\xff" + utf16(svg, true)},
+    };
+    for (auto const &[filename, contents] : files) {
+        write_file(filename, contents);
+        auto doc = read_file(filename);
+        ASSERT_TRUE(doc) << filename;
+        auto const root = doc->root();
+        ASSERT_STREQ(root->name(), "svg:svg") << filename;
+        ASSERT_TRUE(root->firstChild() && root->firstChild()->firstChild()) << filename;
+        EXPECT_STREQ(root->firstChild()->attribute("id"), "t") << filename;
+        EXPECT_EQ(std::string(root->firstChild()->firstChild()->content()), title) << filename;
+        std::remove(filename);
+    }
+}
+
+TEST(ReprIoTest, LargeSvgz)
+{
+    // Random values compress poorly, so the file is read in more than one chunk of compressed
+    // input, and inflated in more than one output block.
+    std::mt19937 gen(5);
+    auto const count = 100000;
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'>";
+    for (int i = 0; i < count; i++) {
+        svg += "<rect id='r" + std::to_string(i) + "' x='" + std::to_string(gen()) + "' y='" +
+               std::to_string(gen()) + "' width='" + std::to_string(gen()) + "'/>";
+    }
+    svg += "</svg>";
+    ASSERT_GT(svg.size(), std::size_t{4} << 20);
+
+    auto const filename = "large.svgz";
+    {
+        auto fp = std::fopen(filename, "wb");
+        ASSERT_TRUE(fp);
+        auto file = Inkscape::IO::FileOutputStream(fp);
+        auto gzip = Inkscape::IO::GzipOutputStream(file);
+        for (auto c : svg) {
+            gzip.put(c);
+        }
+    }
+    auto fp = std::fopen(filename, "rb");
+    ASSERT_TRUE(fp);
+    std::fseek(fp, 0, SEEK_END);
+    EXPECT_GT(std::ftell(fp), 1L << 20);
+    std::fclose(fp);
+
+    auto doc = read_file(filename);
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(doc->root()->childCount(), static_cast<unsigned>(count));
+    EXPECT_STREQ(doc->root()->lastChild()->attribute("id"), ("r" + std::to_string(count - 1)).c_str());
+    std::remove(filename);
+}
+
+TEST(ReprIoTest, TinyFiles)
+{
+    // Too short to be mapped, so read through the stream path; neither is a document.
+    for (auto contents : {"", "<"}) {
+        auto const filename = "tiny.svg";
+        write_file(filename, contents);
+        EXPECT_FALSE(read_file(filename));
+        std::remove(filename);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :